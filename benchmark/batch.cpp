@@ -0,0 +1,128 @@
+#include "mpfr/batch.hpp"
+
+#include "nanobench.h"
+#include <string>
+#include <vector>
+
+template <int N> using scalar_t = mpfr::mp_float_t<mpfr::digits2{N}>;
+
+template <int N> void bench_batch(ankerl::nanobench::Bench& bench) {
+  using T = scalar_t<N>;
+  std::vector<T> xs(100'000);
+  std::vector<T> out(xs.size());
+  std::vector<T> out2(xs.size());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = sqrt(T{static_cast<long>(i + 1)});
+  }
+  mpfr::span<T const> in{xs};
+  mpfr::span<T> o{out};
+  mpfr::span<T> o2{out2};
+
+  bench.batch(xs.size());
+  std::string suffix = " " + std::to_string(N) + " bits";
+
+  bench.run("scalar exp" + suffix, [&] {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      out[i] = exp(xs[i]);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("batch exp, 1 thread," + suffix, [&] { mpfr::batch::exp(in, o, 1); });
+  bench.run("batch exp" + suffix, [&] { mpfr::batch::exp(in, o); });
+
+  bench.run("scalar log" + suffix, [&] {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      out[i] = log(xs[i]);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("batch log, 1 thread," + suffix, [&] { mpfr::batch::log(in, o, 1); });
+  bench.run("batch log" + suffix, [&] { mpfr::batch::log(in, o); });
+
+  bench.run("scalar sin" + suffix, [&] {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      out[i] = sin(xs[i]);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("batch sin, 1 thread," + suffix, [&] { mpfr::batch::sin(in, o, 1); });
+  bench.run("batch sin" + suffix, [&] { mpfr::batch::sin(in, o); });
+
+  bench.run("scalar cos" + suffix, [&] {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      out[i] = cos(xs[i]);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("batch cos, 1 thread," + suffix, [&] { mpfr::batch::cos(in, o, 1); });
+  bench.run("batch cos" + suffix, [&] { mpfr::batch::cos(in, o); });
+
+  bench.run("scalar sin_cos" + suffix, [&] {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      auto sc = sin_cos(xs[i]);
+      out[i] = sc.sin;
+      out2[i] = sc.cos;
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("batch sin_cos, 1 thread," + suffix, [&] { mpfr::batch::sin_cos(in, o, o2, 1); });
+  bench.run("batch sin_cos" + suffix, [&] { mpfr::batch::sin_cos(in, o, o2); });
+}
+
+template <int N> void bench_arith(ankerl::nanobench::Bench& bench) {
+  using T = scalar_t<N>;
+  std::vector<T> xs(100'000);
+  std::vector<T> ys(xs.size());
+  std::vector<T> zs(xs.size());
+  std::vector<T> out(xs.size());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = sqrt(T{static_cast<long>(i + 1)});
+    ys[i] = T{1} / T{static_cast<long>(i + 3)};
+    zs[i] = -log(T{static_cast<long>(i + 2)});
+  }
+  mpfr::span<T const> x{xs};
+  mpfr::span<T const> y{ys};
+  mpfr::span<T const> z{zs};
+  mpfr::span<T> o{out};
+
+  bench.batch(xs.size());
+  std::string suffix = " " + std::to_string(N) + " bits";
+
+  bench.run("scalar add" + suffix, [&] {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      out[i] = xs[i] + ys[i];
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("batch add, 1 thread," + suffix, [&] { mpfr::batch::add(x, y, o, 1); });
+  bench.run("batch add" + suffix, [&] { mpfr::batch::add(x, y, o); });
+
+  bench.run("scalar mul" + suffix, [&] {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      out[i] = xs[i] * ys[i];
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("batch mul, 1 thread," + suffix, [&] { mpfr::batch::mul(x, y, o, 1); });
+  bench.run("batch mul" + suffix, [&] { mpfr::batch::mul(x, y, o); });
+
+  bench.run("scalar fma" + suffix, [&] {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      out[i] = fma(xs[i], ys[i], zs[i]);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("batch fma, 1 thread," + suffix, [&] { mpfr::batch::fma(x, y, z, o, 1); });
+  bench.run("batch fma" + suffix, [&] { mpfr::batch::fma(x, y, z, o); });
+}
+
+auto main() -> int {
+  auto bench = ankerl::nanobench::Bench();
+  bench.minEpochIterations(1);
+  bench.unit("element");
+
+  bench_batch<256>(bench);
+  bench_batch<1024>(bench);
+  bench_arith<128>(bench);
+  bench_arith<256>(bench);
+}
@@ -0,0 +1,68 @@
+#include "mpfr/columns.hpp"
+
+#include "nanobench.h"
+#include <string>
+#include <vector>
+
+template <int N> using scalar_t = mpfr::mp_float_t<mpfr::digits2{N}>;
+
+template <int N> void bench_columns(ankerl::nanobench::Bench& bench) {
+  using T = scalar_t<N>;
+  std::size_t const n_rows = 1'000'000;
+
+  // two columns of shortest round trip representations
+  std::string text;
+  char buf[512];
+  for (std::size_t i = 0; i < n_rows; ++i) {
+    T x = sqrt(T{static_cast<long>(i + 1)});
+    text.append(buf, mpfr::to_chars(buf, buf + sizeof(buf), x).ptr);
+    text += ',';
+    text.append(buf, mpfr::to_chars(buf, buf + sizeof(buf), -x * 1e-20).ptr);
+    text += '\n';
+  }
+
+  std::vector<T> a(n_rows);
+  std::vector<T> b(n_rows);
+  std::string suffix = " " + std::to_string(N) + " bits";
+  bench.batch(n_rows);
+
+  bench.run("mpfr_set_str per token" + suffix, [&] {
+    std::string token;
+    std::size_t row = 0;
+    std::size_t column = 0;
+    for (char c : text) {
+      if (c == ',' or c == '\n') {
+        mpfr::handle_as_mpfr_t(
+            [&](mpfr_ptr x_) { mpfr_set_str(x_, token.c_str(), 10, MPFR_RNDN); },
+            column == 0 ? a[row] : b[row]);
+        token.clear();
+        column = c == ',' ? column + 1 : 0;
+        row += c == '\n' ? 1 : 0;
+      } else {
+        token += c;
+      }
+    }
+    ankerl::nanobench::doNotOptimizeAway(a.data());
+  });
+
+  mpfr::columns_format_t format;
+  format.n_threads = 1;
+  bench.run("parse_columns single thread" + suffix, [&] {
+    auto res = mpfr::parse_columns<mpfr::digits2{N}>(text, format, a, b);
+    ankerl::nanobench::doNotOptimizeAway(res.n_rows);
+  });
+  format.n_threads = 0;
+  bench.run("parse_columns" + suffix, [&] {
+    auto res = mpfr::parse_columns<mpfr::digits2{N}>(text, format, a, b);
+    ankerl::nanobench::doNotOptimizeAway(res.n_rows);
+  });
+}
+
+auto main() -> int {
+  auto bench = ankerl::nanobench::Bench();
+  bench.minEpochIterations(1);
+  bench.unit("row");
+
+  bench_columns<53>(bench);
+  bench_columns<256>(bench);
+}
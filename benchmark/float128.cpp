@@ -0,0 +1,59 @@
+#define MPFR_CXX_USE_FLOAT128 1
+
+#include "mpfr/mpfr.hpp"
+
+#include "nanobench.h"
+#include <string>
+
+using mpfr_fn_t = int (*)(mpfr_ptr, mpfr_srcptr, mpfr_srcptr, mpfr_rnd_t);
+
+template <mpfr::precision_t P, typename Fn>
+static void bench_op(ankerl::nanobench::Bench& bench, char const* name, mpfr_fn_t fn, Fn op) {
+  using scalar_t = mpfr::mp_float_t<P>;
+  std::string suffix = std::string{" "} + name + " " + std::to_string(static_cast<long>(P));
+
+  scalar_t a = sqrt(scalar_t{2});
+  scalar_t b = sqrt(scalar_t{3});
+  scalar_t c;
+  bench.run("float128 backend" + suffix, [&] {
+    ankerl::nanobench::doNotOptimizeAway(&a);
+    c = op(a, b);
+    ankerl::nanobench::doNotOptimizeAway(&c);
+  });
+  // same wrapper, computed by mpfr
+  bench.run("mpfr" + suffix, [&] {
+    ankerl::nanobench::doNotOptimizeAway(&a);
+    c = mpfr::_::apply_binary_op(a, b, fn);
+    ankerl::nanobench::doNotOptimizeAway(&c);
+  });
+}
+
+template <mpfr::precision_t P> static void bench_ops(ankerl::nanobench::Bench& bench) {
+  using scalar_t = mpfr::mp_float_t<P>;
+  bench_op<P>(bench, "add", mpfr_add, [](scalar_t const& a, scalar_t const& b) { return a + b; });
+  bench_op<P>(bench, "mul", mpfr_mul, [](scalar_t const& a, scalar_t const& b) { return a * b; });
+  bench_op<P>(bench, "div", mpfr_div, [](scalar_t const& a, scalar_t const& b) { return a / b; });
+}
+
+auto main() -> int {
+  auto bench = ankerl::nanobench::Bench();
+  bench.minEpochTime(std::chrono::milliseconds{100UL});
+
+  bench_ops<mpfr::digits2{24}>(bench);
+  bench_ops<mpfr::digits2{53}>(bench);
+  // above 63 bits, the operations fall back to mpfr
+  bench_ops<mpfr::digits2{113}>(bench);
+
+  mpfr::mp_float_t<mpfr::digits2{113}> x = sqrt(mpfr::mp_float_t<mpfr::digits2{113}>{2});
+  __float128 y = 0;
+  bench.run("conversion to float128 113", [&] {
+    ankerl::nanobench::doNotOptimizeAway(&x);
+    y = static_cast<__float128>(x);
+    ankerl::nanobench::doNotOptimizeAway(&y);
+  });
+  bench.run("conversion from float128 113", [&] {
+    ankerl::nanobench::doNotOptimizeAway(&y);
+    x = y;
+    ankerl::nanobench::doNotOptimizeAway(&x);
+  });
+}
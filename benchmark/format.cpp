@@ -0,0 +1,188 @@
+#include "mpfr/charconv.hpp"
+#include "mpfr/external/fmt.hpp"
+
+#include "nanobench.h"
+#include <fmt/format.h>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+template <int N> using scalar_t = mpfr::mp_float_t<mpfr::digits2{N}>;
+
+template <int N> void bench_format(ankerl::nanobench::Bench& bench) {
+  using T = scalar_t<N>;
+  std::vector<T> xs(10'000);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = sqrt(T{static_cast<long>(i + 1)}) * ((i % 2 == 0) ? 1e-20 : 1e20);
+  }
+
+  bench.batch(xs.size());
+  std::string suffix = " " + std::to_string(N) + " bits";
+  // all the significant digits
+  int const precision = N * 30103 / 100000;
+
+  std::vector<char> buf(static_cast<std::size_t>(precision) + 64);
+  bench.run("mpfr_snprintf" + suffix, [&] {
+    for (auto const& x : xs) {
+      mpfr::handle_as_mpfr_t(
+          [&](mpfr_srcptr x_) { mpfr_snprintf(buf.data(), buf.size(), "%.*Re", precision, x_); },
+          x);
+    }
+    ankerl::nanobench::doNotOptimizeAway(buf.data());
+  });
+  bench.run("to_chars" + suffix, [&] {
+    for (auto const& x : xs) {
+      mpfr::to_chars(
+          buf.data(), buf.data() + buf.size(), x, mpfr::chars_format::scientific, precision);
+    }
+    ankerl::nanobench::doNotOptimizeAway(buf.data());
+  });
+
+  bench.run("to_chars shortest" + suffix, [&] {
+    for (auto const& x : xs) {
+      mpfr::to_chars(buf.data(), buf.data() + buf.size(), x);
+    }
+    ankerl::nanobench::doNotOptimizeAway(buf.data());
+  });
+
+  std::ostringstream ss;
+  ss << std::scientific << std::setprecision(precision);
+  bench.run("ostream" + suffix, [&] {
+    ss.str({});
+    for (auto const& x : xs) {
+      ss << x << '\n';
+    }
+    ankerl::nanobench::doNotOptimizeAway(ss);
+  });
+
+  fmt::memory_buffer out;
+  bench.run("fmt::format_to" + suffix, [&] {
+    out.clear();
+    for (auto const& x : xs) {
+      fmt::format_to(std::back_inserter(out), "{:.{}e}\n", x, precision);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("fmt::format_to shortest" + suffix, [&] {
+    out.clear();
+    for (auto const& x : xs) {
+      fmt::format_to(std::back_inserter(out), "{}\n", x);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+}
+
+template <int N> void bench_memory_buffer(ankerl::nanobench::Bench& bench) {
+  using T = scalar_t<N>;
+  std::vector<T> xs(1'000'000);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = sqrt(T{static_cast<long>(i + 1)}) * ((i % 2 == 0) ? 1e-20 : 1e20);
+  }
+
+  bench.batch(xs.size());
+  std::string suffix = " " + std::to_string(N) + " bits";
+  fmt::memory_buffer out;
+  bench.run("memory_buffer {:.15e}" + suffix, [&] {
+    out.clear();
+    for (auto const& x : xs) {
+      fmt::format_to(std::back_inserter(out), "{:.15e}\n", x);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("memory_buffer {}" + suffix, [&] {
+    out.clear();
+    for (auto const& x : xs) {
+      fmt::format_to(std::back_inserter(out), "{}\n", x);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("memory_buffer {:>40}" + suffix, [&] {
+    out.clear();
+    for (auto const& x : xs) {
+      fmt::format_to(std::back_inserter(out), "{:>40}\n", x);
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+}
+
+template <int N> void bench_ostream(ankerl::nanobench::Bench& bench) {
+  using T = scalar_t<N>;
+  std::vector<T> xs(100'000);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = sqrt(T{static_cast<long>(i + 1)}) * ((i % 2 == 0) ? -1e-20 : 1e20);
+  }
+
+  bench.batch(xs.size());
+  std::string suffix = " " + std::to_string(N) + " bits";
+  std::ostringstream ss;
+  ss << std::setprecision(15);
+  bench.run("ostream << setw(25)" + suffix, [&] {
+    ss.str({});
+    for (auto const& x : xs) {
+      ss << std::setw(25) << x << '\n';
+    }
+    ankerl::nanobench::doNotOptimizeAway(ss);
+  });
+  bench.run("write_many setw(25)" + suffix, [&] {
+    ss.str({});
+    ss << std::setw(25);
+    mpfr::write_many(ss, mpfr::span<T const>{xs});
+    ankerl::nanobench::doNotOptimizeAway(ss);
+  });
+}
+
+template <int N> void bench_huge(ankerl::nanobench::Bench& bench) {
+  using T = scalar_t<N>;
+  // on the heap, the value is too large for the stack
+  std::vector<T> x(1, sqrt(T{2}));
+  auto const precision = static_cast<int>(N * 30103LL / 100000);
+  std::string suffix = " " + std::to_string(N) + " bits";
+  std::vector<char> buf(static_cast<std::size_t>(precision) + 64);
+
+  bench.batch(1);
+  bench.run("mpfr_snprintf" + suffix, [&] {
+    mpfr::handle_as_mpfr_t(
+        [&](mpfr_srcptr x_) { mpfr_snprintf(buf.data(), buf.size(), "%.*Re", precision, x_); },
+        x[0]);
+    ankerl::nanobench::doNotOptimizeAway(buf.data());
+  });
+  auto res = mpfr::to_chars(
+      buf.data(), buf.data() + buf.size(), x[0], mpfr::chars_format::scientific, precision);
+  bench.run("to_chars" + suffix, [&] {
+    res = mpfr::to_chars(
+        buf.data(), buf.data() + buf.size(), x[0], mpfr::chars_format::scientific, precision);
+    ankerl::nanobench::doNotOptimizeAway(buf.data());
+  });
+
+  *res.ptr = '\0';
+  std::vector<T> y(1);
+  bench.run("mpfr_strtofr" + suffix, [&] {
+    mpfr::handle_as_mpfr_t(
+        [&](mpfr_ptr y_) { mpfr_strtofr(y_, buf.data(), nullptr, 10, MPFR_RNDN); }, y[0]);
+    ankerl::nanobench::doNotOptimizeAway(y.data());
+  });
+  bench.run("from_chars" + suffix, [&] {
+    mpfr::from_chars(buf.data(), res.ptr, y[0]);
+    ankerl::nanobench::doNotOptimizeAway(y.data());
+  });
+}
+
+auto main() -> int {
+  auto bench = ankerl::nanobench::Bench();
+  bench.minEpochIterations(1);
+  bench.unit("value");
+
+  bench_format<256>(bench);
+  bench_format<1024>(bench);
+
+  bench_memory_buffer<53>(bench);
+  bench_memory_buffer<256>(bench);
+
+  bench_ostream<53>(bench);
+  bench_ostream<256>(bench);
+
+  bench.unit("conversion");
+  bench_huge<100'000>(bench);
+  bench_huge<1'000'000>(bench);
+}
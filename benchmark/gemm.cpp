@@ -0,0 +1,62 @@
+#include "mpfr/linalg.hpp"
+
+#include "nanobench.h"
+#include <string>
+#include <vector>
+
+template <int N> using scalar_t = mpfr::mp_float_t<mpfr::digits2{N}>;
+
+template <typename T>
+void naive_gemm(
+    mpfr::linalg::matrix_view<T> c,
+    mpfr::linalg::matrix_view<T const> a,
+    mpfr::linalg::matrix_view<T const> b) {
+  for (std::size_t i = 0; i < c.rows(); ++i) {
+    for (std::size_t j = 0; j < c.cols(); ++j) {
+      T acc = 0;
+      for (std::size_t k = 0; k < a.cols(); ++k) {
+        acc += a(i, k) * b(k, j);
+      }
+      c(i, j) = acc;
+    }
+  }
+}
+
+template <int N> void bench_gemm(ankerl::nanobench::Bench& bench, std::size_t n) {
+  using T = scalar_t<N>;
+  std::vector<T> a(n * n);
+  std::vector<T> b(n * n);
+  std::vector<T> c(n * n);
+  for (std::size_t i = 0; i < n * n; ++i) {
+    a[i] = sqrt(T{static_cast<long>(i + 1)});
+    b[i] = 1 / T{static_cast<long>(i + 1)};
+  }
+
+  // one multiplication and one addition per term of each dot product
+  bench.batch(2.0 * double(n) * double(n) * double(n));
+  std::string suffix = std::to_string(N) + " bits, n = " + std::to_string(n);
+
+  bench.run("naive gemm " + suffix, [&] {
+    naive_gemm<T>({c.data(), n, n}, {a.data(), n, n}, {b.data(), n, n});
+    ankerl::nanobench::doNotOptimizeAway(c.data());
+  });
+  bench.run("blocked gemm, 1 thread, " + suffix, [&] {
+    mpfr::linalg::gemm<T::precision>({c.data(), n, n}, {a.data(), n, n}, {b.data(), n, n}, false, 1);
+    ankerl::nanobench::doNotOptimizeAway(c.data());
+  });
+  bench.run("blocked gemm " + suffix, [&] {
+    mpfr::linalg::gemm<T::precision>({c.data(), n, n}, {a.data(), n, n}, {b.data(), n, n});
+    ankerl::nanobench::doNotOptimizeAway(c.data());
+  });
+}
+
+auto main() -> int {
+  auto bench = ankerl::nanobench::Bench();
+  bench.minEpochIterations(1);
+  bench.unit("flop");
+
+  for (std::size_t n : {64U, 96U}) {
+    bench_gemm<256>(bench, n);
+    bench_gemm<1024>(bench, n);
+  }
+}
@@ -1,4 +1,5 @@
 #include "mpfr/mpfr.hpp"
+#include "mpfr/multi_double.hpp"
 
 #include <boost/multiprecision/mpfr.hpp>
 #include "nanobench.h"
@@ -109,4 +110,76 @@ auto main() -> int {
     d = b * 2;
     ankerl::nanobench::clobberMemory();
   });
+
+  using T3 = mpfr::mp_float_t<mpfr::digits2{106}>;
+  using T4 = mpfr::mp_float_t<mpfr::digits2{212}>;
+
+  T3 e = sqrt(T3{2.0});
+  T3 e_ = e + 1;
+  T4 f = sqrt(T4{2.0});
+  T4 f_ = f + 1;
+  mpfr::dd_t g{e};
+  mpfr::dd_t g_{e_};
+  mpfr::qd_t h{f};
+  mpfr::qd_t h_{f_};
+
+  T3 e_out;
+  T4 f_out;
+  mpfr::dd_t g_out;
+  mpfr::qd_t h_out;
+
+  ankerl::nanobench::doNotOptimizeAway(&e);
+  ankerl::nanobench::doNotOptimizeAway(&f);
+  ankerl::nanobench::doNotOptimizeAway(&g);
+  ankerl::nanobench::doNotOptimizeAway(&h);
+
+  bench.run("add 106", [&] {
+    e_out = e + e_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("add dd", [&] {
+    g_out = g + g_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("mul 106", [&] {
+    e_out = e * e_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("mul dd", [&] {
+    g_out = g * g_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("div 106", [&] {
+    e_out = e / e_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("div dd", [&] {
+    g_out = g / g_;
+    ankerl::nanobench::clobberMemory();
+  });
+
+  bench.run("add 212", [&] {
+    f_out = f + f_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("add qd", [&] {
+    h_out = h + h_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("mul 212", [&] {
+    f_out = f * f_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("mul qd", [&] {
+    h_out = h * h_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("div 212", [&] {
+    f_out = f / f_;
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("div qd", [&] {
+    h_out = h / h_;
+    ankerl::nanobench::clobberMemory();
+  });
 }
@@ -0,0 +1,64 @@
+#include "mpfr/poly.hpp"
+
+#include "nanobench.h"
+#include <string>
+#include <vector>
+
+template <int N> using scalar_t = mpfr::mp_float_t<mpfr::digits2{N}>;
+
+template <int N> void bench_poly(ankerl::nanobench::Bench& bench, std::size_t degree) {
+  using T = scalar_t<N>;
+  std::vector<T> c(degree + 1);
+  for (std::size_t i = 0; i < c.size(); ++i) {
+    c[i] = 1 / T{static_cast<long>(i + 1)};
+  }
+  std::vector<T> xs(10'000);
+  std::vector<T> out(xs.size());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = T{static_cast<long>(i)} / static_cast<long>(xs.size());
+  }
+  mpfr::span<T const> cs{c};
+  mpfr::span<T const> xs_{xs};
+  mpfr::span<T> out_{out};
+
+  bench.batch(xs.size());
+  std::string suffix = std::to_string(N) + " bits, degree " + std::to_string(degree);
+
+  bench.run("operators horner " + suffix, [&] {
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      T acc = c.back();
+      for (std::size_t k = c.size() - 1; k-- > 0;) {
+        acc = acc * xs[i] + c[k];
+      }
+      out[i] = acc;
+    }
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("poly_eval horner, 1 thread, " + suffix, [&] {
+    mpfr::poly_eval(cs, xs_, out_, mpfr::poly_scheme_e::horner, 1);
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("poly_eval estrin, 1 thread, " + suffix, [&] {
+    mpfr::poly_eval(cs, xs_, out_, mpfr::poly_scheme_e::estrin, 1);
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("poly_eval horner " + suffix, [&] {
+    mpfr::poly_eval(cs, xs_, out_);
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+  bench.run("poly_eval estrin " + suffix, [&] {
+    mpfr::poly_eval(cs, xs_, out_, mpfr::poly_scheme_e::estrin);
+    ankerl::nanobench::doNotOptimizeAway(out.data());
+  });
+}
+
+auto main() -> int {
+  auto bench = ankerl::nanobench::Bench();
+  bench.minEpochIterations(1);
+  bench.unit("point");
+
+  for (std::size_t degree : {20U, 200U}) {
+    bench_poly<256>(bench, degree);
+    bench_poly<1024>(bench, degree);
+  }
+}
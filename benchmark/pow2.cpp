@@ -27,6 +27,27 @@ void bench_mul_div(ankerl::nanobench::Bench& bench, Rhs x, std::string const& na
   });
 }
 
+template <typename T> void bench_pow(ankerl::nanobench::Bench& bench, std::string const& name) {
+  T a = sqrt(T{2.0});
+  T two{2};
+  T c{};
+  long n = 37;
+
+  ankerl::nanobench::doNotOptimizeAway(&a);
+  ankerl::nanobench::doNotOptimizeAway(&two);
+  ankerl::nanobench::doNotOptimizeAway(&n);
+  ankerl::nanobench::doNotOptimizeAway(&c);
+
+  bench.run("100 digits10: pow 37" + name, [&] {
+    c = pow(a, n);
+    ankerl::nanobench::clobberMemory();
+  });
+  bench.run("100 digits10: pow 2 37" + name, [&] {
+    c = pow(two, n);
+    ankerl::nanobench::clobberMemory();
+  });
+}
+
 auto main() -> int {
 
   auto bench = ankerl::nanobench::Bench();
@@ -42,4 +63,7 @@ auto main() -> int {
   bench_mul_div<scalar_t<1000>>(bench, 128, "i");
   bench_mul_div<bscalar_t<1000>>(bench, 128.0, "d boost");
   bench_mul_div<bscalar_t<1000>>(bench, 128, "i boost");
+
+  bench_pow<scalar_t<100>>(bench, "");
+  bench_pow<bscalar_t<100>>(bench, " boost");
 }
@@ -0,0 +1,48 @@
+#include "mpfr/serialize.hpp"
+
+#include "nanobench.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+template <int N> using scalar_t = mpfr::mp_float_t<mpfr::digits2{N}>;
+
+template <int N> void bench_serialize(ankerl::nanobench::Bench& bench) {
+  using T = scalar_t<N>;
+  std::vector<T> xs(1'000'000);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    // a quarter of the values are small integers, with few significant bits
+    xs[i] = (i % 4 == 0) ? T{static_cast<long>(i)} : sqrt(T{static_cast<long>(i + 1)});
+  }
+  std::string suffix = " " + std::to_string(N) + " bits";
+
+  std::vector<unsigned char> buf;
+  mpfr::serialize(mpfr::span<T const>{xs}, buf);
+  std::vector<T> ys(xs.size());
+
+  // throughput in bytes of the in-memory representation
+  bench.batch(xs.size() * sizeof(T));
+  bench.run("memcpy" + suffix, [&] {
+    std::memcpy(ys.data(), xs.data(), xs.size() * sizeof(T));
+    ankerl::nanobench::doNotOptimizeAway(ys.data());
+  });
+  bench.run("serialize" + suffix, [&] {
+    buf.clear();
+    mpfr::serialize(mpfr::span<T const>{xs}, buf);
+    ankerl::nanobench::doNotOptimizeAway(buf.data());
+  });
+  bench.run("deserialize" + suffix, [&] {
+    mpfr::deserialize(buf.data(), buf.data() + buf.size(), mpfr::span<T>{ys});
+    ankerl::nanobench::doNotOptimizeAway(ys.data());
+  });
+}
+
+auto main() -> int {
+  auto bench = ankerl::nanobench::Bench();
+  bench.minEpochIterations(1);
+  bench.unit("byte");
+
+  bench_serialize<53>(bench);
+  bench_serialize<256>(bench);
+  bench_serialize<1024>(bench);
+}
@@ -0,0 +1,65 @@
+#include "mpfr/series.hpp"
+
+#include "nanobench.h"
+#include <string>
+
+// terms of the Chudnovsky series, see test/series.cpp
+static void chudnovsky_p(mpz_ptr out, std::size_t k) {
+  if (k == 0) {
+    mpz_set_ui(out, 1);
+    return;
+  }
+  mpz_set_ui(out, 6 * k - 5);
+  mpz_mul_ui(out, out, 2 * k - 1);
+  mpz_mul_ui(out, out, 6 * k - 1);
+  mpz_neg(out, out);
+}
+static void chudnovsky_q(mpz_ptr out, std::size_t k) {
+  if (k == 0) {
+    mpz_set_ui(out, 1);
+    return;
+  }
+  mpz_set_ui(out, k);
+  mpz_pow_ui(out, out, 3);
+  mpz_mul_ui(out, out, 10939058860032000UL);
+}
+static void chudnovsky_a(mpz_ptr out, std::size_t k) {
+  mpz_set_ui(out, 545140134);
+  mpz_mul_ui(out, out, k);
+  mpz_add_ui(out, out, 13591409);
+}
+
+static void bench_pi(ankerl::nanobench::Bench& bench, mpfr_prec_t prec) {
+  mpfr_t pi;
+  mpfr_t s;
+  mpfr_init2(pi, prec);
+  mpfr_init2(s, prec + 64);
+  std::string suffix = " " + std::to_string(prec) + " bits";
+
+  bench.run("binary_split pi" + suffix, [&] {
+    auto split = mpfr::series::binary_split(
+        chudnovsky_p, chudnovsky_q, chudnovsky_a, static_cast<std::size_t>(prec) / 47 + 2);
+    mpfr::series::sum(split, s);
+    mpfr_sqrt_ui(pi, 10005, MPFR_RNDN);
+    mpfr_mul_ui(pi, pi, 426880, MPFR_RNDN);
+    mpfr_div(pi, pi, s, MPFR_RNDN);
+    ankerl::nanobench::doNotOptimizeAway(pi);
+  });
+  bench.run("mpfr_const_pi" + suffix, [&] {
+    // the constant is cached by MPFR
+    mpfr_free_cache();
+    mpfr_const_pi(pi, MPFR_RNDN);
+    ankerl::nanobench::doNotOptimizeAway(pi);
+  });
+
+  mpfr_clear(pi);
+  mpfr_clear(s);
+}
+
+auto main() -> int {
+  auto bench = ankerl::nanobench::Bench();
+  bench.minEpochIterations(1);
+
+  bench_pi(bench, 100'000);
+  bench_pi(bench, 1'000'000);
+}
@@ -0,0 +1,49 @@
+#include "mpfr/linalg.hpp"
+
+#include "nanobench.h"
+#include <string>
+#include <vector>
+
+template <int N> using scalar_t = mpfr::mp_float_t<mpfr::digits2{N}>;
+
+template <int N> void bench_solve(ankerl::nanobench::Bench& bench, std::size_t n) {
+  using T = scalar_t<N>;
+  std::vector<T> a(n * n);
+  std::vector<T> b(n);
+  std::vector<T> x(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j <= i; ++j) {
+      a[i * n + j] = a[j * n + i] = sqrt(T{static_cast<long>(i * n + j + 1)}) / 7;
+    }
+    a[i * n + i] += 20 * static_cast<long>(n);
+    b[i] = 1 / T{static_cast<long>(i + 1)};
+  }
+
+  mpfr::span<T> xs{x};
+  mpfr::linalg::matrix_view<T const> av{a.data(), n, n};
+  mpfr::span<T const> bs{b};
+  std::string suffix = std::to_string(N) + " bits, n = " + std::to_string(n);
+
+  bench.run("lu, double factorization, " + suffix, [&] {
+    ankerl::nanobench::doNotOptimizeAway(mpfr::linalg::lu_solve<double>(xs, av, bs));
+  });
+  bench.run("lu, full precision factorization, " + suffix, [&] {
+    ankerl::nanobench::doNotOptimizeAway(mpfr::linalg::lu_solve<T>(xs, av, bs));
+  });
+  bench.run("cholesky, double factorization, " + suffix, [&] {
+    ankerl::nanobench::doNotOptimizeAway(mpfr::linalg::cholesky_solve<double>(xs, av, bs));
+  });
+  bench.run("cholesky, full precision factorization, " + suffix, [&] {
+    ankerl::nanobench::doNotOptimizeAway(mpfr::linalg::cholesky_solve<T>(xs, av, bs));
+  });
+}
+
+auto main() -> int {
+  auto bench = ankerl::nanobench::Bench();
+  bench.minEpochIterations(1);
+
+  for (std::size_t n : {32U, 128U}) {
+    bench_solve<256>(bench, n);
+    bench_solve<1024>(bench, n);
+  }
+}
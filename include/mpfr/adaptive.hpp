@@ -0,0 +1,226 @@
+#ifndef ADAPTIVE_HPP_J5VB9RTX
+#define ADAPTIVE_HPP_J5VB9RTX
+
+#include "mpfr/mp_float.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <atomic>
+#include <cfenv>
+#include <cstdint>
+
+namespace mpfr {
+
+/// Approximation returned by a kernel of `adaptive_eval`, together with a bound of its error.
+template <precision_t P> struct adaptive_approx_t {
+  /// Approximation of the exact result.
+  mp_float_t<P> value;
+  /// Number of correct bits: the error is at most `2^(e - correct_bits)`, where `e` is the
+  /// exponent of `value` in the convention of MPFR, with `0.5 <= |value| / 2^e < 1`. This is the
+  /// `err` argument of `mpfr_can_round`.
+  mpfr_exp_t correct_bits;
+};
+
+/// \return `{value, correct_bits}`.
+template <precision_t P>
+auto adaptive_approx(mp_float_t<P> const& value, mpfr_exp_t correct_bits) noexcept
+    -> adaptive_approx_t<P> {
+  return {value, correct_bits};
+}
+
+/// Result of `adaptive_eval`.
+template <precision_t P> struct adaptive_result_t {
+  /// Result, rounded to the target precision.
+  mp_float_t<P> value;
+  /// Index in the ladder of the precision the accepted approximation was computed with.
+  std::size_t rung;
+  /// Whether `value` is known to be correctly rounded. This is only `false` when the
+  /// approximation at the last precision of the ladder could not be rounded either.
+  bool proven;
+};
+
+/// Counts of the precisions that the results of `adaptive_eval` were computed with. The counters
+/// can be updated concurrently from multiple threads.
+class adaptive_stats_t {
+public:
+  /// Number of counters. The results of higher rungs are counted in the last one.
+  static constexpr std::size_t max_rungs = 8;
+
+  adaptive_stats_t() noexcept { reset(); }
+  adaptive_stats_t(adaptive_stats_t const&) = delete;
+  adaptive_stats_t(adaptive_stats_t&&) = delete;
+  auto operator=(adaptive_stats_t const&) -> adaptive_stats_t& = delete;
+  auto operator=(adaptive_stats_t&&) -> adaptive_stats_t& = delete;
+  ~adaptive_stats_t() = default;
+
+  /// Counts a result that was computed at rung `rung` of its ladder.
+  void record(std::size_t rung, bool proven) noexcept {
+    std::size_t const i = rung < max_rungs ? rung : max_rungs - 1;
+    m_counts[i].fetch_add(1, std::memory_order_relaxed);
+    if (not proven) {
+      m_n_unproven.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /// \n
+  template <precision_t P> void record(adaptive_result_t<P> const& result) noexcept {
+    record(result.rung, result.proven);
+  }
+
+  /// \return The number of results computed at rung `rung`.
+  [[MPFR_CXX_NODISCARD]] auto count(std::size_t rung) const noexcept -> std::uint64_t {
+    return rung < max_rungs ? m_counts[rung].load(std::memory_order_relaxed) : 0;
+  }
+
+  /// \return The number of results that were not proven to be correctly rounded.
+  [[MPFR_CXX_NODISCARD]] auto n_unproven() const noexcept -> std::uint64_t {
+    return m_n_unproven.load(std::memory_order_relaxed);
+  }
+
+  /// \return The number of recorded results.
+  [[MPFR_CXX_NODISCARD]] auto total() const noexcept -> std::uint64_t {
+    std::uint64_t n = 0;
+    for (std::size_t i = 0; i < max_rungs; ++i) {
+      n += count(i);
+    }
+    return n;
+  }
+
+  /// Sets all the counters to zero.
+  void reset() noexcept {
+    for (std::size_t i = 0; i < max_rungs; ++i) {
+      m_counts[i].store(0, std::memory_order_relaxed);
+    }
+    m_n_unproven.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint64_t> m_counts[max_rungs];
+  std::atomic<std::uint64_t> m_n_unproven;
+};
+
+namespace _ {
+
+/// \return Whether the approximation computed by a kernel can be rounded correctly to `Target`
+/// bits in the rounding mode `rnd`.
+template <precision_t Target, precision_t P>
+auto adaptive_can_round(adaptive_approx_t<P> const& approx, mpfr_flags_t, mpfr_rnd_t rnd)
+    -> bool {
+  _::mpfr_cref_t const m = _::impl_access::mpfr_cref(approx.value);
+  auto const prec = static_cast<mpfr_prec_t>(Target);
+  return mpfr_can_round(&m.m, approx.correct_bits, MPFR_RNDN, rnd, prec) != 0;
+}
+
+/// A kernel that returns a plain value has no error bound, so its result is only accepted if it
+/// is exact.
+template <precision_t Target, precision_t P>
+auto adaptive_can_round(mp_float_t<P> const&, mpfr_flags_t raised, mpfr_rnd_t) -> bool {
+  return (raised & MPFR_FLAGS_INEXACT) == 0;
+}
+
+template <precision_t P> auto adaptive_value(adaptive_approx_t<P> const& approx) noexcept
+    -> mp_float_t<P> const& {
+  return approx.value;
+}
+template <precision_t P> auto adaptive_value(mp_float_t<P> const& value) noexcept
+    -> mp_float_t<P> const& {
+  return value;
+}
+
+/// Runs the kernel at precision `P`. If its result can be rounded, or if `last` is set, stores
+/// the rounded result in `out` and raises the flags that the kernel raised, other than the
+/// inexact flag, which is then raised by the final rounding.
+///
+/// \return Whether the result was stored.
+template <precision_t Target, precision_t P, typename Fn, typename... Args>
+auto adaptive_rung(
+    adaptive_result_t<Target>& out,
+    std::size_t rung,
+    bool last,
+    int fe_round,
+    mpfr_flags_t saved,
+    Fn& fn,
+    Args const&... args) -> bool {
+  mpfr_flags_clear(MPFR_FLAGS_ALL);
+  std::fesetround(FE_TONEAREST);
+  auto const approx = fn(mp_float_t<P>{args}...);
+  mpfr_flags_t const raised = mpfr_flags_save();
+  std::fesetround(fe_round);
+
+  bool const proven = _::adaptive_can_round<Target>(approx, raised, _::get_rnd());
+  if (not proven and not last) {
+    return false;
+  }
+  mpfr_flags_restore(saved | (raised & ~mpfr_flags_t{MPFR_FLAGS_INEXACT}), MPFR_FLAGS_ALL);
+  out.value = _::adaptive_value(approx);
+  out.rung = rung;
+  out.proven = proven;
+  return true;
+}
+
+template <precision_t Target, precision_t... Ladder> struct adaptive_ladder;
+
+template <precision_t Target, precision_t P> struct adaptive_ladder<Target, P> {
+  template <typename Fn, typename... Args>
+  static void
+  run(adaptive_result_t<Target>& out,
+      std::size_t rung,
+      int fe_round,
+      mpfr_flags_t saved,
+      Fn& fn,
+      Args const&... args) {
+    _::adaptive_rung<Target, P>(out, rung, true, fe_round, saved, fn, args...);
+  }
+};
+
+template <precision_t Target, precision_t P, precision_t Next, precision_t... Rest>
+struct adaptive_ladder<Target, P, Next, Rest...> {
+  template <typename Fn, typename... Args>
+  static void
+  run(adaptive_result_t<Target>& out,
+      std::size_t rung,
+      int fe_round,
+      mpfr_flags_t saved,
+      Fn& fn,
+      Args const&... args) {
+    if (not _::adaptive_rung<Target, P>(out, rung, false, fe_round, saved, fn, args...)) {
+      adaptive_ladder<Target, Next, Rest...>::run(out, rung + 1, fe_round, saved, fn, args...);
+    }
+  }
+};
+
+} // namespace _
+
+/// Evaluates `fn` at the lowest precision of `Ladder` that gives a correctly rounded result at
+/// precision `Target`, in the current rounding mode, as in Ziv's strategy.\n
+/// `fn` is called with `args` converted to `mp_float_t<P>`, for the precisions `P` of the ladder
+/// in order, and runs in round to nearest mode. It returns either an `adaptive_approx_t<P>`, whose
+/// error bound is checked with `mpfr_can_round`, or an `mp_float_t<P>`, which is only accepted if
+/// the call did not raise the inexact flag. The approximation of the last rung is accepted in any
+/// case, and the result is then marked as not proven.\n
+/// Exact results can usually not be proven from an error bound, so that they go up to the last
+/// rung unless the kernel returns them as plain values.\n
+/// The flags raised by the accepted call are raised in the caller, except for the inexact flag,
+/// which is raised if the final rounding is inexact.
+///
+/// \return The rounded result, and the rung it was computed at.
+///
+/// @param[in] fn    Kernel, generic over the precision of its arguments.
+/// @param[in] args  Arguments of the kernel, converted to each precision of the ladder. The
+/// conversion is exact unless they are wider than the precision.
+template <precision_t Target, precision_t... Ladder, typename Fn, typename... Args>
+auto adaptive_eval(Fn fn, Args const&... args) -> adaptive_result_t<Target> {
+  static_assert(sizeof...(Ladder) > 0, "the ladder must have at least one precision");
+  static_assert(
+      sizeof...(Ladder) <= adaptive_stats_t::max_rungs,
+      "the ladder has more precisions than adaptive_stats_t can count");
+  adaptive_result_t<Target> out{};
+  _::adaptive_ladder<Target, Ladder...>::run(
+      out, 0, std::fegetround(), mpfr_flags_save(), fn, args...);
+  return out;
+}
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard ADAPTIVE_HPP_J5VB9RTX */
@@ -0,0 +1,266 @@
+#ifndef BATCH_HPP_T0PD7XGA
+#define BATCH_HPP_T0PD7XGA
+
+#include "mpfr/span.hpp"
+#include "mpfr/detail/thread_pool.hpp"
+#include "mpfr/detail/two_limb.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+namespace mpfr {
+namespace batch {
+namespace _ {
+using namespace ::mpfr::_;
+
+/// Number of elements processed by a task of the thread pool.
+constexpr std::size_t block_size = 256;
+
+/// Extra bits of the constants computed ahead of time, to cover the guard bits used by the
+/// argument reductions of MPFR.
+constexpr mpfr_prec_t constant_guard_bits = 64;
+
+/// Makes sure that the thread local constant caches of MPFR hold pi and log(2) with enough
+/// precision for the argument reductions of functions evaluated in precision `prec`, so that
+/// they are computed once per thread instead of growing during the batch.
+inline void warm_constants(mpfr_prec_t prec) {
+  thread_local mpfr_prec_t warmed = 0;
+  prec += constant_guard_bits;
+  if (warmed >= prec) {
+    return;
+  }
+  mpfr_t c;
+  mpfr_init2(c, prec);
+  mpfr_const_pi(c, MPFR_RNDN);
+  mpfr_const_log2(c, MPFR_RNDN);
+  mpfr_clear(c);
+  warmed = prec;
+}
+
+template <typename Fn> void for_each_block(std::size_t n, std::size_t n_threads, Fn& fn) {
+  auto task = [&](std::size_t t) {
+    std::size_t const begin = t * block_size;
+    std::size_t const end = (n - begin) < block_size ? n : begin + block_size;
+    fn(begin, end);
+  };
+  thread_pool::global().for_each_index((n + block_size - 1) / block_size, n_threads, task);
+}
+
+template <precision_t P>
+void map_unary(
+    span<mp_float_t<P> const> xs,
+    span<mp_float_t<P>> out,
+    int (*op)(mpfr_ptr, mpfr_srcptr, mpfr_rnd_t),
+    std::size_t n_threads) {
+  if (xs.size() != out.size()) {
+    crash_with_message("batch: input and output have different sizes");
+  }
+  mpfr_rnd_t rnd = _::get_rnd();
+  auto block = [&](std::size_t begin, std::size_t end) {
+    _::warm_constants(static_cast<mpfr_prec_t>(P));
+    for (std::size_t i = begin; i < end; ++i) {
+      // copied since `out` may alias `xs`
+      mp_float_t<P> const x = xs[i];
+      mpfr_cref_t x_ = impl_access::mpfr_cref(x);
+      mpfr_raii_setter_t&& g = impl_access::mpfr_setter(out[i]);
+      op(&g.m, &x_.m, rnd);
+    }
+  };
+  _::for_each_block(xs.size(), n_threads, block);
+}
+
+template <precision_t P> constexpr auto has_two_limb_kernels() -> bool {
+#if MPFR_CXX_HAS_TWO_LIMB_KERNELS == 1
+  return two_limb::is_supported<P>();
+#else
+  return false;
+#endif
+}
+
+/// Correctly rounded kernels that handle the common cases without going through mpfr.
+/// They return false when the element must be computed by mpfr.
+template <bool Enabled> struct arith_kernels {
+  template <typename... Args> static auto add(Args&&...) -> bool { return false; }
+  template <typename... Args> static auto mul(Args&&...) -> bool { return false; }
+  template <typename... Args> static auto fma(Args&&...) -> bool { return false; }
+};
+
+#if MPFR_CXX_HAS_TWO_LIMB_KERNELS == 1
+template <> struct arith_kernels<true> {
+  template <typename... Args> static auto add(Args&&... args) -> bool {
+    return two_limb::add(static_cast<Args&&>(args)...);
+  }
+  template <typename... Args> static auto mul(Args&&... args) -> bool {
+    return two_limb::mul(static_cast<Args&&>(args)...);
+  }
+  template <typename... Args> static auto fma(Args&&... args) -> bool {
+    return two_limb::fma(static_cast<Args&&>(args)...);
+  }
+};
+#endif
+
+enum struct arith_op_e { add, mul };
+
+template <precision_t P>
+void map_arith(
+    span<mp_float_t<P> const> xs,
+    span<mp_float_t<P> const> ys,
+    span<mp_float_t<P>> out,
+    arith_op_e op,
+    std::size_t n_threads) {
+  if (xs.size() != out.size() or ys.size() != out.size()) {
+    crash_with_message("batch: input and output have different sizes");
+  }
+  using kernels = arith_kernels<_::has_two_limb_kernels<P>()>;
+  mpfr_rnd_t rnd = _::get_rnd();
+  mpfr_exp_t emin = _::get_emin();
+  mpfr_exp_t emax = _::get_emax();
+  auto block = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      // copied since `out` may alias the inputs
+      mp_float_t<P> const x = xs[i];
+      mp_float_t<P> const y = ys[i];
+      bool const done = (op == arith_op_e::add) ? kernels::add(out[i], x, y, rnd, emin, emax)
+                                                : kernels::mul(out[i], x, y, rnd, emin, emax);
+      if (not done) {
+        mpfr_cref_t x_ = impl_access::mpfr_cref(x);
+        mpfr_cref_t y_ = impl_access::mpfr_cref(y);
+        mpfr_raii_setter_t&& g = impl_access::mpfr_setter(out[i]);
+        (op == arith_op_e::add ? mpfr_add : mpfr_mul)(&g.m, &x_.m, &y_.m, rnd);
+      }
+    }
+  };
+  _::for_each_block(xs.size(), n_threads, block);
+}
+
+} // namespace _
+
+/// Writes `xs[i] + ys[i]` to `out[i]`.\n
+/// The results are identical to the ones of `mpfr::operator+`, and `out` may be the same range as
+/// either input. Precisions from 65 to 128 bits, which take two limbs, use integer kernels that
+/// avoid the per element overhead of mpfr, except for special values and results outside the
+/// exponent range.
+///
+/// @param[in] xs         Left operands.
+/// @param[in] ys         Right operands. Must have the same size as `xs`.
+/// @param[out] out       Results. Must have the same size as `xs`.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <precision_t P>
+void add(
+    span<mp_float_t<P> const> xs,
+    span<mp_float_t<P> const> ys,
+    span<mp_float_t<P>> out,
+    std::size_t n_threads = 0) {
+  _::map_arith(xs, ys, out, _::arith_op_e::add, n_threads);
+}
+
+/// Writes `xs[i] * ys[i]` to `out[i]`. See `batch::add`.
+template <precision_t P>
+void mul(
+    span<mp_float_t<P> const> xs,
+    span<mp_float_t<P> const> ys,
+    span<mp_float_t<P>> out,
+    std::size_t n_threads = 0) {
+  _::map_arith(xs, ys, out, _::arith_op_e::mul, n_threads);
+}
+
+/// Writes `xs[i] * ys[i] + zs[i]`, rounded once, to `out[i]`. See `batch::add`.
+template <precision_t P>
+void fma(
+    span<mp_float_t<P> const> xs,
+    span<mp_float_t<P> const> ys,
+    span<mp_float_t<P> const> zs,
+    span<mp_float_t<P>> out,
+    std::size_t n_threads = 0) {
+  if (xs.size() != out.size() or ys.size() != out.size() or zs.size() != out.size()) {
+    ::mpfr::_::crash_with_message("batch: input and output have different sizes");
+  }
+  using kernels = _::arith_kernels<_::has_two_limb_kernels<P>()>;
+  mpfr_rnd_t rnd = ::mpfr::_::get_rnd();
+  mpfr_exp_t emin = ::mpfr::_::get_emin();
+  mpfr_exp_t emax = ::mpfr::_::get_emax();
+  auto block = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      mp_float_t<P> const x = xs[i];
+      mp_float_t<P> const y = ys[i];
+      mp_float_t<P> const z = zs[i];
+      if (not kernels::fma(out[i], x, y, z, rnd, emin, emax)) {
+        _::mpfr_cref_t x_ = _::impl_access::mpfr_cref(x);
+        _::mpfr_cref_t y_ = _::impl_access::mpfr_cref(y);
+        _::mpfr_cref_t z_ = _::impl_access::mpfr_cref(z);
+        _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out[i]);
+        mpfr_fma(&g.m, &x_.m, &y_.m, &z_.m, rnd);
+      }
+    }
+  };
+  _::for_each_block(xs.size(), n_threads, block);
+}
+
+/// Writes `exp(xs[i])` to `out[i]`.\n
+/// The results are identical to the ones of `mpfr::exp`. `out` may be the same range as `xs`.
+///
+/// @param[in] xs         Arguments.
+/// @param[out] out       Results. Must have the same size as `xs`.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <precision_t P>
+void exp(span<mp_float_t<P> const> xs, span<mp_float_t<P>> out, std::size_t n_threads = 0) {
+  _::map_unary(xs, out, mpfr_exp, n_threads);
+}
+
+/// Writes `log(xs[i])` to `out[i]`. See `batch::exp`.
+template <precision_t P>
+void log(span<mp_float_t<P> const> xs, span<mp_float_t<P>> out, std::size_t n_threads = 0) {
+  _::map_unary(xs, out, mpfr_log, n_threads);
+}
+
+/// Writes `sin(xs[i])` to `out[i]`. See `batch::exp`.
+template <precision_t P>
+void sin(span<mp_float_t<P> const> xs, span<mp_float_t<P>> out, std::size_t n_threads = 0) {
+  _::map_unary(xs, out, mpfr_sin, n_threads);
+}
+
+/// Writes `cos(xs[i])` to `out[i]`. See `batch::exp`.
+template <precision_t P>
+void cos(span<mp_float_t<P> const> xs, span<mp_float_t<P>> out, std::size_t n_threads = 0) {
+  _::map_unary(xs, out, mpfr_cos, n_threads);
+}
+
+/// Writes `sin(xs[i])` to `sin_out[i]` and `cos(xs[i])` to `cos_out[i]`, sharing the argument
+/// reduction of each element.\n
+/// The results are identical to the ones of `mpfr::sin_cos`. Either output may be the same range
+/// as `xs`, but the outputs must not overlap each other.
+///
+/// @param[in] xs         Arguments.
+/// @param[out] sin_out   Sines. Must have the same size as `xs`.
+/// @param[out] cos_out   Cosines. Must have the same size as `xs`.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <precision_t P>
+void sin_cos(
+    span<mp_float_t<P> const> xs,
+    span<mp_float_t<P>> sin_out,
+    span<mp_float_t<P>> cos_out,
+    std::size_t n_threads = 0) {
+  if (xs.size() != sin_out.size() or xs.size() != cos_out.size()) {
+    ::mpfr::_::crash_with_message("batch: input and output have different sizes");
+  }
+  mpfr_rnd_t rnd = ::mpfr::_::get_rnd();
+  auto block = [&](std::size_t begin, std::size_t end) {
+    _::warm_constants(static_cast<mpfr_prec_t>(P));
+    for (std::size_t i = begin; i < end; ++i) {
+      mp_float_t<P> const x = xs[i];
+      _::mpfr_cref_t x_ = _::impl_access::mpfr_cref(x);
+      _::mpfr_raii_setter_t&& sg = _::impl_access::mpfr_setter(sin_out[i]);
+      _::mpfr_raii_setter_t&& cg = _::impl_access::mpfr_setter(cos_out[i]);
+      mpfr_sin_cos(&sg.m, &cg.m, &x_.m, rnd);
+    }
+  };
+  _::for_each_block(xs.size(), n_threads, block);
+}
+
+} // namespace batch
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard BATCH_HPP_T0PD7XGA */
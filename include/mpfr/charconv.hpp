@@ -0,0 +1,502 @@
+#ifndef CHARCONV_HPP_UX4D0W7L
+#define CHARCONV_HPP_UX4D0W7L
+
+#include "mpfr/mp_float.hpp"
+#include "mpfr/span.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <istream>
+#include <system_error>
+#include <vector>
+
+namespace mpfr {
+
+/// Floating point notations, with the same meaning as `std::chars_format`.
+enum struct chars_format : unsigned char {
+  scientific = 1,
+  fixed = 2,
+  hex = 4,
+  general = fixed | scientific,
+  /// Extension, binary digits with a binary exponent, as `1.01p+3`.
+  binary = 8,
+};
+
+/// Same as `std::to_chars_result`.
+struct to_chars_result {
+  char* ptr;
+  std::errc ec;
+};
+
+/// Same as `std::from_chars_result`.
+struct from_chars_result {
+  char const* ptr;
+  std::errc ec;
+};
+
+namespace _ {
+
+inline auto to_float_format(chars_format fmt) noexcept -> float_format_e {
+  switch (fmt) {
+  case chars_format::scientific:
+    return float_format_e::exp;
+  case chars_format::fixed:
+    return float_format_e::fixed;
+  case chars_format::hex:
+    return float_format_e::hex;
+  case chars_format::binary:
+    return float_format_e::binary;
+  default:
+    return float_format_e::general;
+  }
+}
+
+constexpr auto to_lower(char c) -> char {
+  return (c >= 'A' and c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/// \return Whether `[first, last)` starts with the lowercase `word`, ignoring case.
+inline auto starts_with_nocase(char const* first, char const* last, char const* word) -> bool {
+  for (; *word != '\0'; ++word, ++first) {
+    if (first == last or to_lower(*first) != *word) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline auto is_digit_in(char c, unsigned base) -> bool {
+  return digit_value(c) < base;
+}
+
+/// \return The end of the longest prefix of `[first, last)` that is a finite number without sign
+/// in the notation `fmt`, or `first` if there is none.
+inline auto scan_float(char const* first, char const* last, chars_format fmt) -> char const* {
+  bool const pow2 = fmt == chars_format::hex or fmt == chars_format::binary;
+  unsigned const base = fmt == chars_format::hex ? 16 : fmt == chars_format::binary ? 2 : 10;
+  char const* it = first;
+  bool has_digits = false;
+  while (it != last and is_digit_in(*it, base)) {
+    ++it;
+    has_digits = true;
+  }
+  if (it != last and *it == '.') {
+    ++it;
+    while (it != last and is_digit_in(*it, base)) {
+      ++it;
+      has_digits = true;
+    }
+  }
+  if (not has_digits) {
+    return first;
+  }
+
+  bool const exponent_allowed = fmt != chars_format::fixed;
+  bool const exponent_required = fmt == chars_format::scientific;
+  if (exponent_allowed and it != last and to_lower(*it) == (pow2 ? 'p' : 'e')) {
+    char const* exp_it = it + 1;
+    if (exp_it != last and (*exp_it == '+' or *exp_it == '-')) {
+      ++exp_it;
+    }
+    if (exp_it != last and is_digit_in(*exp_it, 10)) {
+      while (exp_it != last and is_digit_in(*exp_it, 10)) {
+        ++exp_it;
+      }
+      return exp_it;
+    }
+  }
+  return exponent_required ? first : it;
+}
+
+} // namespace _
+
+namespace _ {
+
+inline auto to_chars_impl(char* first, char* last, mpfr_cref_t x, float_spec_t const& spec)
+    -> to_chars_result {
+  if (mpfr_signbit(&x.m)) {
+    if (first == last) {
+      return {last, std::errc::value_too_large};
+    }
+    *first++ = '-';
+  }
+  char* end = _::write_float_abs(first, last, x, spec);
+  if (end == nullptr) {
+    return {last, std::errc::value_too_large};
+  }
+  return {end, std::errc{}};
+}
+
+} // namespace _
+
+/// Writes `x` to `[first, last)` with the fewest significant digits that read back to `x` with
+/// `from_chars` when rounding to nearest, in fixed or scientific notation, whichever is shorter.
+/// Fixed notation is preferred when both have the same length.\n
+/// Among the shortest representations, the closest to `x` is chosen.
+///
+/// \return `{end, std::errc{}}` on success, or `{last, std::errc::value_too_large}` if the output
+/// does not fit.
+///
+/// @param[out] first Start of the output.
+/// @param[out] last  End of the output.
+/// @param[in] x      Value to write.
+template <precision_t P>
+auto to_chars(char* first, char* last, mp_float_t<P> const& x) -> to_chars_result {
+  _::float_spec_t spec;
+  spec.format = _::float_format_e::shortest;
+  spec.round_trip_prec = static_cast<mpfr_prec_t>(P);
+  return _::to_chars_impl(first, last, _::impl_access::mpfr_cref(x), spec);
+}
+
+/// Same as `to_chars(first, last, x)`, with the notation `fmt`. As in `std::to_chars`, the general
+/// notation is fixed for decimal exponents from -4 to 5, and scientific otherwise. The hexadecimal
+/// and binary notations are exact, without trailing zeros.
+template <precision_t P>
+auto to_chars(char* first, char* last, mp_float_t<P> const& x, chars_format fmt)
+    -> to_chars_result {
+  _::float_spec_t spec;
+  spec.format = _::to_float_format(fmt);
+  spec.precision = -1;
+  spec.hex_prefix = false;
+  spec.round_trip_prec = static_cast<mpfr_prec_t>(P);
+  return _::to_chars_impl(first, last, _::impl_access::mpfr_cref(x), spec);
+}
+
+/// Writes `x` to `[first, last)` as `std::printf` would with the conversion specifier
+/// corresponding to `fmt` and the given `precision`, in the "C" locale. Hexadecimal output has no
+/// `0x` prefix, as in `std::to_chars`.\n
+/// The digits come from a single radix conversion, written directly to the output.
+///
+/// \return `{end, std::errc{}}` on success, or `{last, std::errc::value_too_large}` if the output
+/// does not fit.
+///
+/// @param[out] first     Start of the output.
+/// @param[out] last      End of the output.
+/// @param[in] x          Value to write.
+/// @param[in] fmt        Notation.
+/// @param[in] precision  Digits after the point, or significant digits for the general notation.
+/// A negative value stands for 6 for decimal notations, and for an exact representation for the
+/// hexadecimal and binary ones, which are rounded to nearest with ties to even otherwise.
+template <precision_t P>
+auto to_chars(char* first, char* last, mp_float_t<P> const& x, chars_format fmt, int precision)
+    -> to_chars_result {
+  _::float_spec_t spec;
+  spec.format = _::to_float_format(fmt);
+  spec.precision = precision;
+  spec.hex_prefix = false;
+  return _::to_chars_impl(first, last, _::impl_access::mpfr_cref(x), spec);
+}
+
+/// Parses a number from `[first, last)` following the rules of `std::from_chars`: an optional
+/// minus sign, then either a number in the notation `fmt`, or an infinity or a nan. Hexadecimal
+/// input has no `0x` prefix. The result is rounded with the current rounding mode.\n
+/// Hexadecimal and binary digits are copied directly to the significand, with a single rounding.
+/// Long decimal inputs are converted with a divide and conquer algorithm that runs on the thread
+/// pool.
+///
+/// \return `{end, std::errc{}}` on success, where `end` points past the parsed characters.
+/// `{first, std::errc::invalid_argument}` if no number could be parsed.
+/// `{end, std::errc::result_out_of_range}` if the value overflows or underflows the exponent
+/// range, in which case `value` is not modified.
+///
+/// @param[in] first  Start of the input.
+/// @param[in] last   End of the input.
+/// @param[out] value Parsed value.
+/// @param[in] fmt    Notation.
+template <precision_t P>
+auto from_chars(
+    char const* first,
+    char const* last,
+    mp_float_t<P>& value,
+    chars_format fmt = chars_format::general) -> from_chars_result {
+  char const* it = first;
+  bool const negative = it != last and *it == '-';
+  if (negative) {
+    ++it;
+  }
+
+  if (_::starts_with_nocase(it, last, "inf")) {
+    it += _::starts_with_nocase(it, last, "infinity") ? 8 : 3;
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(value);
+    mpfr_set_inf(&g.m, negative ? -1 : 1);
+    return {it, std::errc{}};
+  }
+  if (_::starts_with_nocase(it, last, "nan")) {
+    it += 3;
+    // optional (n-char-sequence)
+    if (it != last and *it == '(') {
+      char const* close = it + 1;
+      while (close != last and (_::is_digit_in(*close, 10) or *close == '_' or
+                                (_::to_lower(*close) >= 'a' and _::to_lower(*close) <= 'z'))) {
+        ++close;
+      }
+      if (close != last and *close == ')') {
+        it = close + 1;
+      }
+    }
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(value);
+    mpfr_set_nan(&g.m);
+    mpfr_setsign(&g.m, &g.m, negative ? 1 : 0, MPFR_RNDN);
+    return {it, std::errc{}};
+  }
+
+  char const* end = _::scan_float(it, last, fmt);
+  if (end == it) {
+    return {first, std::errc::invalid_argument};
+  }
+
+  mp_float_t<P> tmp;
+  mpfr_flags_t const saved = mpfr_flags_save();
+  mpfr_clear_flags();
+  if (fmt == chars_format::hex or fmt == chars_format::binary) {
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(tmp);
+    _::parse_pow2(it, end, fmt == chars_format::hex ? 4 : 1, negative, &g.m, _::get_rnd());
+  } else {
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(tmp);
+    _::parse_decimal(it, end, negative, &g.m, _::get_rnd());
+  }
+  bool const out_of_range = mpfr_overflow_p() or mpfr_underflow_p();
+  mpfr_flags_t const raised = mpfr_flags_save();
+  mpfr_flags_restore(saved | (out_of_range ? 0 : raised), MPFR_FLAGS_ALL);
+
+  if (out_of_range) {
+    return {end, std::errc::result_out_of_range};
+  }
+  value = tmp;
+  return {end, std::errc{}};
+}
+
+namespace _ {
+
+/// Size of the chunks handed to the stream buffer by `write_many`.
+constexpr std::size_t write_many_chunk_size = 64 * 1024;
+
+inline auto column_separator(std::size_t i, std::size_t n, std::size_t n_columns, char separator)
+    -> char {
+  return ((i + 1) % n_columns == 0 or i + 1 == n) ? '\n' : separator;
+}
+
+template <typename CharT, typename Traits, precision_t P>
+void write_many_impl(
+    std::basic_ostream<CharT, Traits>& out,
+    span<mp_float_t<P> const> xs,
+    std::size_t n_columns,
+    char separator) {
+  std::streamsize const width = out.width();
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    out.width(width);
+    out << xs[i];
+    out.put(out.widen(_::column_separator(i, xs.size(), n_columns, separator)));
+  }
+  out.width(0);
+}
+
+template <typename Traits, precision_t P>
+void write_many_impl(
+    std::basic_ostream<char, Traits>& out,
+    span<mp_float_t<P> const> xs,
+    std::size_t n_columns,
+    char separator) {
+  typename std::basic_ostream<char, Traits>::sentry guard{out};
+  if (not guard) {
+    return;
+  }
+  float_spec_t const spec = _::ostream_spec(out);
+  auto const width = static_cast<std::size_t>(out.width() > 0 ? out.width() : 0);
+  out.width(0);
+
+  std::vector<char> chunk(write_many_chunk_size);
+  std::size_t len = 0;
+  auto flush = [&] {
+    auto const n = static_cast<std::streamsize>(len);
+    len = 0;
+    if (out.rdbuf()->sputn(chunk.data(), n) != n) {
+      out.setstate(std::ios_base::badbit);
+      return false;
+    }
+    return true;
+  };
+
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    mpfr_cref_t x_ = impl_access::mpfr_cref(xs[i]);
+    std::size_t const bound = _::padded_chars_bound(&x_.m, spec, width) + 1;
+    if (len + bound > chunk.size()) {
+      if (not flush()) {
+        return;
+      }
+      if (bound > chunk.size()) {
+        chunk.resize(bound);
+      }
+    }
+    auto const chars =
+        _::write_padded(chunk.data() + len, x_, spec, out.flags(), out.fill(), width);
+    auto const n = static_cast<std::size_t>(chars.second - chars.first);
+    std::memmove(chunk.data() + len, chars.first, n);
+    len += n;
+    chunk[len++] = _::column_separator(i, xs.size(), n_columns, separator);
+  }
+  flush();
+}
+
+} // namespace _
+
+/// Writes the elements of `xs` to `out` as a table of `n_columns` columns, with the formatting
+/// options of `out`, as `operator<<` would. The width of `out` applies to every element, so that
+/// the columns are aligned when it is large enough, and is then reset to zero.\n
+/// The elements of a row are separated by `separator`, and each row, including the last one,
+/// ends with a newline. On narrow streams, the text is formatted in chunks that are each handed
+/// to the stream buffer at once.
+///
+/// @param[out] out       Output stream.
+/// @param[in] xs         Values to write, row by row.
+/// @param[in] n_columns  Number of values per row. Zero is the same as one.
+/// @param[in] separator  Separator between the values of a row.
+template <typename CharT, typename Traits, precision_t P>
+void write_many(
+    std::basic_ostream<CharT, Traits>& out,
+    span<mp_float_t<P> const> xs,
+    std::size_t n_columns = 1,
+    char separator = ' ') {
+  _::write_many_impl(out, xs, n_columns == 0 ? 1 : n_columns, separator);
+}
+
+namespace _ {
+
+/// Characters of a number read from a stream. They are kept on the stack unless the number is
+/// long.
+struct istream_token_t {
+  char stack[128];
+  std::vector<char> heap;
+  std::size_t size = 0;
+
+  void push(char c) {
+    if (size < sizeof(stack)) {
+      stack[size++] = c;
+      return;
+    }
+    if (heap.empty()) {
+      heap.assign(stack, stack + size);
+    }
+    heap.push_back(c);
+    ++size;
+  }
+  auto data() const -> char const* { return heap.empty() ? stack : heap.data(); }
+};
+
+template <typename Traits>
+auto narrow_char(std::basic_istream<char, Traits>& /*in*/, char c) -> char {
+  return c;
+}
+template <typename CharT, typename Traits>
+auto narrow_char(std::basic_istream<CharT, Traits>& in, CharT c) -> char {
+  return in.narrow(c, '\0');
+}
+
+/// Moves the longest prefix of the input of `in` that may start a number to `token`, without a
+/// leading plus sign or `0x` prefix.
+///
+/// \return The notation of the number, hexadecimal if it has a `0x` prefix, general otherwise.
+template <typename CharT, typename Traits>
+auto read_float_token(std::basic_istream<CharT, Traits>& in, istream_token_t& token)
+    -> chars_format {
+  std::basic_streambuf<CharT, Traits>* sb = in.rdbuf();
+  bool at_eof = false;
+  auto peek = [&]() -> char {
+    typename Traits::int_type const c = sb->sgetc();
+    if (Traits::eq_int_type(c, Traits::eof())) {
+      at_eof = true;
+      return '\0';
+    }
+    return _::narrow_char(in, Traits::to_char_type(c));
+  };
+  char c = peek();
+  auto take = [&](bool keep) {
+    if (keep) {
+      token.push(c);
+    }
+    sb->sbumpc();
+    c = peek();
+  };
+
+  if (c == '+' or c == '-') {
+    take(c == '-');
+  }
+
+  chars_format fmt = chars_format::general;
+  if (_::to_lower(c) == 'i' or _::to_lower(c) == 'n') {
+    char const* word = _::to_lower(c) == 'i' ? "infinity" : "nan";
+    bool const nan = *word == 'n';
+    for (; *word != '\0' and _::to_lower(c) == *word; ++word) {
+      take(true);
+    }
+    if (nan and *word == '\0' and c == '(') {
+      do {
+        take(true);
+      } while (_::is_digit_in(c, 10) or c == '_' or
+               (_::to_lower(c) >= 'a' and _::to_lower(c) <= 'z'));
+      if (c == ')') {
+        take(true);
+      }
+    }
+  } else {
+    if (c == '0') {
+      take(true);
+      if (_::to_lower(c) == 'x') {
+        fmt = chars_format::hex;
+        take(false);
+      }
+    }
+    unsigned const base = fmt == chars_format::hex ? 16 : 10;
+    bool dot = false;
+    while (_::is_digit_in(c, base) or (c == '.' and not dot)) {
+      dot = dot or c == '.';
+      take(true);
+    }
+    if (_::to_lower(c) == (fmt == chars_format::hex ? 'p' : 'e')) {
+      take(true);
+      if (c == '+' or c == '-') {
+        take(true);
+      }
+      while (_::is_digit_in(c, 10)) {
+        take(true);
+      }
+    }
+  }
+  if (at_eof) {
+    in.setstate(std::ios_base::eofbit);
+  }
+  return fmt;
+}
+
+} // namespace _
+
+/// Reads a number from `in`, after skipping leading whitespace unless `skipws` is unset. The
+/// number is read as `from_chars` would in the general notation, except that it may start with a
+/// plus sign, and that a `0x` prefix selects the hexadecimal notation.\n
+/// The longest sequence of characters that may start a number is first extracted from the stream
+/// buffer, then converted at once. If it is not a number as a whole, or if it is outside the
+/// exponent range, `failbit` is set and `x` is not modified.
+template <typename CharT, typename Traits, precision_t P>
+auto operator>>(std::basic_istream<CharT, Traits>& in, mp_float_t<P>& x)
+    -> std::basic_istream<CharT, Traits>& {
+  typename std::basic_istream<CharT, Traits>::sentry guard{in};
+  if (not guard) {
+    return in;
+  }
+  _::istream_token_t token;
+  chars_format const fmt = _::read_float_token(in, token);
+  char const* const last = token.data() + token.size;
+  mp_float_t<P> tmp;
+  from_chars_result const res = from_chars(token.data(), last, tmp, fmt);
+  if (res.ec != std::errc{} or res.ptr != last) {
+    in.setstate(std::ios_base::failbit);
+  } else {
+    x = tmp;
+  }
+  return in;
+}
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard CHARCONV_HPP_UX4D0W7L */
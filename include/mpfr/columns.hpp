@@ -0,0 +1,220 @@
+#ifndef COLUMNS_HPP_H3VX9PLA
+#define COLUMNS_HPP_H3VX9PLA
+
+#include "mpfr/charconv.hpp"
+#include "mpfr/span.hpp"
+#include "mpfr/detail/thread_pool.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <cstring>
+#include <system_error>
+#include <vector>
+
+namespace mpfr {
+
+/// Layout of the text read by `parse_columns`.
+struct columns_format_t {
+  /// Separator of the fields of a row. A space stands for any run of spaces and tabs.
+  char separator = ',';
+  /// Maximum number of threads to use, including the caller. Zero means all the threads of the
+  /// pool.
+  std::size_t n_threads = 0;
+};
+
+/// Field that could not be read by `parse_columns`.
+struct field_error_t {
+  /// Index of the row, counting the rows that were read.
+  std::size_t row;
+  /// Index of the column. A row with too many fields has an error at the index one past the last
+  /// column.
+  std::size_t column;
+  /// `std::errc::invalid_argument` if the field is missing or is not a number,
+  /// `std::errc::result_out_of_range` if it is outside the exponent range.
+  std::errc ec;
+};
+
+/// Result of `parse_columns`.
+struct parse_columns_result_t {
+  /// End of the last row that was read.
+  char const* ptr;
+  /// Number of rows that were read.
+  std::size_t n_rows;
+  /// Fields that could not be read, in increasing order of row, then column.
+  std::vector<field_error_t> errors;
+};
+
+namespace _ {
+
+/// Number of rows parsed by a task of the thread pool.
+constexpr std::size_t rows_per_task = 256;
+
+struct text_row_t {
+  char const* first;
+  char const* last;
+};
+
+inline auto is_blank(char c) -> bool { return c == ' ' or c == '\t' or c == '\r'; }
+
+inline auto skip_blanks(char const* first, char const* last) -> char const* {
+  while (first != last and is_blank(*first)) {
+    ++first;
+  }
+  return first;
+}
+
+inline auto trim_blanks_back(char const* first, char const* last) -> char const* {
+  while (last != first and is_blank(last[-1])) {
+    --last;
+  }
+  return last;
+}
+
+/// Splits `text` in non blank lines, at most `max_rows` of them.
+///
+/// \return The end of the last line.
+inline auto index_rows(
+    char const* first, char const* last, std::size_t max_rows, std::vector<text_row_t>& rows)
+    -> char const* {
+  char const* it = first;
+  while (it != last and rows.size() < max_rows) {
+    auto const* nl =
+        static_cast<char const*>(std::memchr(it, '\n', static_cast<std::size_t>(last - it)));
+    char const* line_end = nl == nullptr ? last : nl;
+    if (_::skip_blanks(it, line_end) != line_end) {
+      rows.push_back({it, line_end});
+    }
+    it = nl == nullptr ? last : nl + 1;
+  }
+  return it;
+}
+
+template <precision_t P>
+void parse_field(
+    char const* first,
+    char const* last,
+    mp_float_t<P>& out,
+    std::size_t row,
+    std::size_t column,
+    std::vector<field_error_t>& errors) {
+  first = _::skip_blanks(first, last);
+  last = _::trim_blanks_back(first, last);
+  from_chars_result res = from_chars(first, last, out);
+  if (res.ec == std::errc{} and res.ptr != last) {
+    res.ec = std::errc::invalid_argument;
+  }
+  if (res.ec != std::errc{}) {
+    mpfr_raii_setter_t&& g = impl_access::mpfr_setter(out);
+    mpfr_set_nan(&g.m);
+    errors.push_back({row, column, res.ec});
+  }
+}
+
+template <precision_t P>
+void parse_row(
+    text_row_t line,
+    std::size_t row,
+    span<mp_float_t<P>> const* columns,
+    std::size_t n_columns,
+    char separator,
+    std::vector<field_error_t>& errors) {
+  std::size_t c = 0;
+  char const* it = line.first;
+  char const* const last = line.last;
+  bool const whitespace = separator == ' ';
+  for (;;) {
+    char const* field_end = nullptr;
+    if (whitespace) {
+      it = _::skip_blanks(it, last);
+      if (it == last) {
+        break;
+      }
+      field_end = it;
+      while (field_end != last and not is_blank(*field_end)) {
+        ++field_end;
+      }
+    } else {
+      auto const* sep = static_cast<char const*>(
+          std::memchr(it, separator, static_cast<std::size_t>(last - it)));
+      field_end = sep == nullptr ? last : sep;
+    }
+
+    if (c < n_columns) {
+      _::parse_field(it, field_end, columns[c][row], row, c, errors);
+    } else {
+      errors.push_back({row, c, std::errc::invalid_argument});
+      break;
+    }
+    ++c;
+    if (field_end == last) {
+      break;
+    }
+    it = field_end + (whitespace ? 0 : 1);
+  }
+  for (; c < n_columns; ++c) {
+    mpfr_raii_setter_t&& g = impl_access::mpfr_setter(columns[c][row]);
+    mpfr_set_nan(&g.m);
+    errors.push_back({row, c, std::errc::invalid_argument});
+  }
+}
+
+template <precision_t P>
+auto parse_columns_impl(
+    span<char const> text,
+    columns_format_t const& format,
+    span<mp_float_t<P>> const* columns,
+    std::size_t n_columns) -> parse_columns_result_t {
+  std::size_t max_rows = n_columns == 0 ? 0 : columns[0].size();
+  for (std::size_t c = 1; c < n_columns; ++c) {
+    max_rows = columns[c].size() < max_rows ? columns[c].size() : max_rows;
+  }
+
+  // the rows are found sequentially, which is cheap compared to the conversions
+  std::vector<text_row_t> rows;
+  char const* end = _::index_rows(text.data(), text.data() + text.size(), max_rows, rows);
+
+  std::size_t const n_tasks = (rows.size() + rows_per_task - 1) / rows_per_task;
+  std::vector<std::vector<field_error_t>> task_errors(n_tasks);
+  auto task = [&](std::size_t t) {
+    std::size_t const begin = t * rows_per_task;
+    std::size_t const stop =
+        (rows.size() - begin) < rows_per_task ? rows.size() : begin + rows_per_task;
+    for (std::size_t i = begin; i < stop; ++i) {
+      _::parse_row(rows[i], i, columns, n_columns, format.separator, task_errors[t]);
+    }
+  };
+  thread_pool::global().for_each_index(n_tasks, format.n_threads, task);
+
+  parse_columns_result_t result{end, rows.size(), {}};
+  for (auto const& errors : task_errors) {
+    result.errors.insert(result.errors.end(), errors.begin(), errors.end());
+  }
+  return result;
+}
+
+} // namespace _
+
+/// Reads a table of numbers from `text`, with one row per line and one column per output. Blank
+/// lines are skipped, and the fields may be surrounded by spaces and tabs. Each field is read as
+/// `from_chars` would in the general notation, and must be a number as a whole.\n
+/// The rows are located in a first pass, then converted on the thread pool. Reading stops once
+/// the shortest column is full.
+///
+/// \return The number of rows read, and the fields that could not be read, whose values are set
+/// to NaN. Fields missing from a row are reported as invalid. Extra fields are reported once per
+/// row.
+///
+/// @param[in] text     Input text.
+/// @param[in] format   Separator of the fields, and number of threads.
+/// @param[out] columns Outputs, one per column, each convertible to `span<mp_float_t<P>>`.
+template <precision_t P, typename... Columns>
+auto parse_columns(span<char const> text, columns_format_t const& format, Columns&&... columns)
+    -> parse_columns_result_t {
+  span<mp_float_t<P>> const spans[] = {span<mp_float_t<P>>{columns}..., span<mp_float_t<P>>{}};
+  return _::parse_columns_impl<P>(text, format, spans, sizeof...(Columns));
+}
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard COLUMNS_HPP_H3VX9PLA */
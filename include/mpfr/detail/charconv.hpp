@@ -0,0 +1,967 @@
+#ifndef CHARCONV_HPP_2HXW9QBU
+#define CHARCONV_HPP_2HXW9QBU
+
+#include "mpfr/detail/radix.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ios>
+#include <utility>
+#include <vector>
+
+namespace mpfr {
+namespace _ {
+
+/// `shortest` picks the shorter of `fixed` and `exp`, preferring `fixed` on ties.
+enum struct float_format_e : unsigned char { general, exp, fixed, hex, binary, shortest };
+
+/// Formatting options of a floating point number, following the printf conventions.
+struct float_spec_t {
+  float_format_e format = float_format_e::general;
+  /// Digits after the point for `exp` and `fixed`, significant digits for `general`, and digits
+  /// after the point for `hex` and `binary`, where a negative value means as many as needed for
+  /// an exact representation.
+  long precision = 6;
+  bool upper = false;
+  /// Same as the `#` printf flag.
+  bool alt = false;
+  /// Whether hexadecimal output starts with `0x`.
+  bool hex_prefix = true;
+  /// When nonzero, decimal formats ignore `precision` and use the fewest significant digits that
+  /// read back to the same number in this precision.
+  mpfr_prec_t round_trip_prec = 0;
+};
+
+/// Bounds checked writer into a character range.
+struct char_sink_t {
+  char* pos;
+  char* end;
+
+  auto put(char c) noexcept -> bool {
+    if (pos == end) {
+      return false;
+    }
+    *pos++ = c;
+    return true;
+  }
+  auto put(char const* s, std::size_t n) noexcept -> bool {
+    if (static_cast<std::size_t>(end - pos) < n) {
+      return false;
+    }
+    std::memcpy(pos, s, n);
+    pos += n;
+    return true;
+  }
+  auto put_n(char c, std::size_t n) noexcept -> bool {
+    if (static_cast<std::size_t>(end - pos) < n) {
+      return false;
+    }
+    std::memset(pos, c, n);
+    pos += n;
+    return true;
+  }
+};
+
+/// Upper bound of `floor(log10(2^e2))`, with a margin for the rounding of the product.
+inline auto log10_pow2_upper(long e2) noexcept -> long {
+  return static_cast<long>(static_cast<long double>(e2) * 0.30102999566398119521L) + 2;
+}
+
+/// Scratch characters, on the stack for small sizes.
+struct scratch_chars_t /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+  char stack[256];
+  heap_str_t heap{0};
+
+  auto get(std::size_t n) -> char* {
+    if (n <= sizeof(stack)) {
+      return stack;
+    }
+    heap.init(n);
+    return heap.p;
+  }
+};
+
+/// Decimal digits of a number, rounded to nearest with ties to even. The value is
+/// `0.d[0]d[1]...d[n_digits - 1] * 10^(exp10 + 1)`, and is zero if `n_digits` is zero.
+struct decimal_t {
+  char* digits;
+  long n_digits;
+  long exp10;
+};
+
+/// Number of significant digits kept by `format` with precision `p`, for a number whose leading
+/// digit has weight `10^exp10`.
+inline auto kept_digits(float_format_e format, long p, long exp10) noexcept -> long {
+  switch (format) {
+  case float_format_e::fixed:
+    return exp10 + 1 + p;
+  case float_format_e::exp:
+    return p + 1;
+  default:
+    return p == 0 ? 1 : p;
+  }
+}
+
+/// Decimal digits of the positive regular number `x`, as kept by `format` with precision `p`.\n
+/// The digits are obtained from a single truncated conversion with one more digit than needed,
+/// and are then rounded here. When the discarded digits are exactly a half unit, a second
+/// conversion rounding upwards tells whether the conversion was exact.
+inline auto to_decimal(mpfr_srcptr x, float_format_e format, long p, scratch_chars_t& scratch)
+    -> decimal_t {
+  long const k_hi = kept_digits(format, p, log10_pow2_upper(mpfr_get_exp(x)));
+  std::size_t const n = static_cast<std::size_t>(k_hi + 1 < 2 ? 2 : k_hi + 1);
+
+  // room for a truncated and an upward rounded conversion
+  char* const buf = scratch.get(2 * (n + 2));
+  mpfr_exp_t e10 = 0;
+  get_decimal_str(buf, &e10, n, x, MPFR_RNDZ);
+
+  long exp10 = static_cast<long>(e10) - 1;
+  long k = kept_digits(format, p, exp10);
+  if (k < 0) {
+    // below half a unit of the last kept digit
+    return {buf, 0, 0};
+  }
+
+  char const next = buf[k];
+  bool round_up = next > '5';
+  if (next == '5') {
+    bool above_half = false;
+    for (std::size_t i = static_cast<std::size_t>(k) + 1; i < n; ++i) {
+      if (buf[i] != '0') {
+        above_half = true;
+        break;
+      }
+    }
+    if (not above_half) {
+      char* const buf_up = buf + n + 2;
+      mpfr_exp_t e10_up = 0;
+      get_decimal_str(buf_up, &e10_up, n, x, MPFR_RNDU);
+      above_half = e10_up != e10 or std::memcmp(buf, buf_up, n) != 0;
+    }
+    bool const odd = k > 0 and (buf[k - 1] - '0') % 2 == 1;
+    round_up = above_half or odd;
+  }
+
+  if (round_up) {
+    long i = k - 1;
+    while (i >= 0 and buf[i] == '9') {
+      buf[i] = '0';
+      --i;
+    }
+    if (i >= 0) {
+      ++buf[i];
+    } else {
+      // carry out of the leading digit
+      buf[0] = '1';
+      ++exp10;
+      if (format == float_format_e::fixed) {
+        // one more integral digit
+        if (k > 0) {
+          buf[k] = '0';
+        }
+        ++k;
+      }
+    }
+  }
+  if (k == 0) {
+    return {buf, 0, 0};
+  }
+  return {buf, k, exp10};
+}
+
+/// Number of significant decimal digits that always suffice to read back a number of precision
+/// `prec`, plus one.
+inline auto round_trip_digits(mpfr_prec_t prec) noexcept -> long {
+  return static_cast<long>(static_cast<long double>(prec) * 0.30102999566398119521L) + 3;
+}
+
+/// Adds one to the `n` digits at `d`.
+/// \return Whether the addition carries out of the leading digit.
+inline auto increment_digits(char* d, long n) noexcept -> bool {
+  for (long i = n - 1; i >= 0; --i) {
+    if (d[i] != '9') {
+      ++d[i];
+      return false;
+    }
+    d[i] = '0';
+  }
+  return true;
+}
+
+/// Subtracts one from the `n` nonzero digits at `d`.
+inline void decrement_digits(char* d, long n) noexcept {
+  for (long i = n - 1; i >= 0; --i) {
+    if (d[i] != '0') {
+      --d[i];
+      return;
+    }
+    d[i] = '9';
+  }
+}
+
+/// Adds `v` to the `n` digits at `d`, which must not overflow.
+inline void add_to_digits(char* d, long n, unsigned long v) noexcept {
+  for (long i = n - 1; i >= 0 and v != 0; --i) {
+    v += static_cast<unsigned long>(d[i] - '0');
+    d[i] = static_cast<char>('0' + v % 10);
+    v /= 10;
+  }
+}
+
+/// Subtracts `v` from the `n` digits at `d`, which must not underflow.
+inline void sub_from_digits(char* d, long n, unsigned long v) noexcept {
+  for (long i = n - 1; i >= 0 and v != 0; --i) {
+    long digit = static_cast<long>(d[i] - '0') - static_cast<long>(v % 10);
+    v /= 10;
+    if (digit < 0) {
+      digit += 10;
+      ++v;
+    }
+    d[i] = static_cast<char>('0' + digit);
+  }
+}
+
+/// Rounds the `n` digits at `d` up to a multiple of `10^(n - k)`, and stores the leading `k`
+/// digits to `out`.
+inline void ceil_digits(char* out, char const* d, long n, long k) noexcept {
+  std::memcpy(out, d, static_cast<std::size_t>(k));
+  if (std::any_of(d + k, d + n, [](char c) { return c != '0'; })) {
+    increment_digits(out, k);
+  }
+}
+
+/// Fewest decimal digits that read back to the positive regular number `x` in precision `prec`,
+/// with round to nearest, ties to even. Among the candidates with that many digits, the closest
+/// to `x` is chosen, with ties to even.\n
+/// As in Grisu, `x` is converted once with a few guard digits, and the half width of its rounding
+/// interval is estimated in units of the last digit. The candidates that are inside of the
+/// interval whatever the errors of the conversion and of the estimate are kept as is, while the
+/// few that are within those errors of a bound are checked by reading them back.
+inline auto shortest_decimal(mpfr_srcptr x, mpfr_prec_t prec, scratch_chars_t& scratch)
+    -> decimal_t {
+  // digits of x, behind a slot for carries
+  long const n = round_trip_digits(prec) + 2;
+  long const m = n + 1;
+  auto const slot = static_cast<std::size_t>(m) + 2;
+  constexpr std::size_t exponent_len = 32;
+  char* const x_digits = scratch.get(9 * slot + exponent_len);
+  char* const wide_lo = x_digits + slot;
+  char* const wide_hi = wide_lo + slot;
+  char* const safe_lo = wide_hi + slot;
+  char* const safe_hi = safe_lo + slot;
+  char* const lo_k = safe_hi + slot;
+  char* const hi_k = lo_k + slot;
+  char* const out = hi_k + slot;
+  char* const tmp = out + slot;
+
+  // value: 0.x_digits * 10^(e10 + 1), the weight of the i-th digit being 10^(e10 - i)
+  mpfr_exp_t e10 = 0;
+  x_digits[0] = '0';
+  get_decimal_str(x_digits + 1, &e10, static_cast<std::size_t>(n), x, MPFR_RNDN);
+
+  // the bounds are at half an ulp from x, or a quarter below powers of two
+  mpfr_exp_t const e2 = mpfr_get_exp(x) - prec - 1;
+  long double log_w = 0;
+  constexpr mpfr_exp_t exact_product_limit = mpfr_exp_t{1} << 32;
+  if (e2 > -exact_product_limit and e2 < exact_product_limit) {
+    log_w = static_cast<long double>(e2) * 0.30102999566398119521L +
+            static_cast<long double>(n - e10);
+  } else {
+    mp_limb_t limbs[prec_to_nlimb(128)];
+    mpfr_t t;
+    mpfr_custom_init(limbs, 128);
+    mpfr_custom_init_set(t, MPFR_ZERO_KIND, 0, 128, limbs);
+    mpfr_set_ui(t, 2, MPFR_RNDN);
+    mpfr_log10(t, t, MPFR_RNDN);
+    mpfr_mul_si(t, t, e2, MPFR_RNDN);
+    mpfr_add_si(t, t, n - e10, MPFR_RNDN);
+    log_w = mpfr_get_ld(t, MPFR_RNDN);
+  }
+  long double const w_hi = std::pow(10.0L, log_w);
+  long double const w_lo = mpfr_min_prec(x) == 1 ? w_hi / 2 : w_hi;
+  // half a unit for the conversion of x, and a generous bound of the error of the estimate
+  long double const margin = 0.5L + w_hi * 1e-8L;
+
+  std::size_t const um = static_cast<std::size_t>(m);
+  for (char* d : {wide_lo, wide_hi, safe_lo, safe_hi}) {
+    std::memcpy(d, x_digits, um);
+  }
+  sub_from_digits(wide_lo, m, static_cast<unsigned long>(w_lo + margin));
+  add_to_digits(wide_hi, m, static_cast<unsigned long>(w_hi + margin));
+  sub_from_digits(safe_lo, m, static_cast<unsigned long>(w_lo - margin));
+  add_to_digits(safe_hi, m, static_cast<unsigned long>(w_hi - margin));
+
+  auto reads_back = [&](char const* digits, long k) -> bool {
+    std::memcpy(tmp, digits, static_cast<std::size_t>(k));
+    std::snprintf(tmp + k, exponent_len, "e%ld", static_cast<long>(e10) + 1 - k);
+    std::vector<mp_limb_t> limbs(prec_to_nlimb(prec));
+    mpfr_t y;
+    mpfr_custom_init(limbs.data(), prec);
+    mpfr_custom_init_set(y, MPFR_ZERO_KIND, 0, prec, limbs.data());
+    parse_decimal(tmp, tmp + std::strlen(tmp), false, y, MPFR_RNDN);
+    return mpfr_equal_p(y, x);
+  };
+
+  // fewer digits than the common prefix of the wide bounds leave no candidate, unless the lower
+  // bound ends within it
+  long j = 0;
+  while (j < m and wide_lo[j] == wide_hi[j]) {
+    ++j;
+  }
+  long lo_end = m;
+  while (lo_end > 0 and wide_lo[lo_end - 1] == '0') {
+    --lo_end;
+  }
+  long k = lo_end <= j ? (lo_end > 1 ? lo_end : 1) : j + 1;
+
+  for (;; ++k) {
+    auto const uk = static_cast<std::size_t>(k);
+    ceil_digits(lo_k, wide_lo, m, k);
+    std::memcpy(hi_k, wide_hi, uk);
+    // candidates between the wide and the safe bounds
+    ceil_digits(out, safe_lo, m, k);
+    while (std::memcmp(lo_k, out, uk) < 0 and std::memcmp(lo_k, hi_k, uk) <= 0 and
+           not reads_back(lo_k, k)) {
+      increment_digits(lo_k, k);
+    }
+    while (std::memcmp(hi_k, safe_hi, uk) > 0 and std::memcmp(lo_k, hi_k, uk) <= 0 and
+           not reads_back(hi_k, k)) {
+      decrement_digits(hi_k, k);
+    }
+    if (std::memcmp(lo_k, hi_k, uk) > 0) {
+      continue;
+    }
+
+    // closest candidate to x
+    bool round_up = false;
+    if (k < m) {
+      char const* tail = x_digits + k;
+      bool const rest_zero =
+          std::all_of(tail + 1, tail + (m - k), [](char c) { return c == '0'; });
+      round_up = tail[0] > '5' or (tail[0] == '5' and not rest_zero);
+      if (tail[0] == '5' and rest_zero) {
+        // x was rounded to the midpoint of two candidates, the directed conversions tell where it
+        // actually is
+        mpfr_exp_t e = 0;
+        get_decimal_str(tmp, &e, static_cast<std::size_t>(n), x, MPFR_RNDZ);
+        bool const below = e != e10 or std::memcmp(tmp, x_digits + 1, um - 1) != 0;
+        get_decimal_str(tmp, &e, static_cast<std::size_t>(n), x, MPFR_RNDU);
+        bool const above = e != e10 or std::memcmp(tmp, x_digits + 1, um - 1) != 0;
+        round_up = above or (not below and (x_digits[k - 1] - '0') % 2 == 1);
+      }
+    }
+    std::memcpy(out, x_digits, uk);
+    bool const carry = round_up and increment_digits(out, k);
+    if (carry or std::memcmp(out, hi_k, uk) > 0) {
+      std::memcpy(out, hi_k, uk);
+    } else if (std::memcmp(out, lo_k, uk) < 0) {
+      std::memcpy(out, lo_k, uk);
+    }
+    break;
+  }
+
+  long first = 0;
+  while (out[first] == '0') {
+    ++first;
+  }
+  while (out[k - 1] == '0') {
+    --k;
+  }
+  return {out + first, k - first, static_cast<long>(e10) - first};
+}
+
+/// Writes the exponent `e` after `marker`, with its sign and at least `min_digits` digits.
+inline auto
+write_exponent(char_sink_t& out, char marker, long e, std::size_t min_digits = 2) noexcept -> bool {
+  char digits[24];
+  std::size_t n = 0;
+  unsigned long u = e < 0 ? 0UL - static_cast<unsigned long>(e) : static_cast<unsigned long>(e);
+  do {
+    digits[n++] = static_cast<char>('0' + u % 10);
+    u /= 10;
+  } while (u != 0);
+  while (n < min_digits) {
+    digits[n++] = '0';
+  }
+  bool ok = out.put(marker) and out.put(e < 0 ? '-' : '+');
+  while (ok and n > 0) {
+    ok = out.put(digits[--n]);
+  }
+  return ok;
+}
+
+/// Writes the digits of `d` in fixed notation with `p` digits after the point.
+inline auto write_fixed(char_sink_t& out, decimal_t d, long p, bool point) noexcept -> bool {
+  auto const up = static_cast<std::size_t>(p);
+  if (d.n_digits == 0) {
+    return out.put('0') and (not point or out.put('.')) and out.put_n('0', up);
+  }
+  if (d.exp10 >= 0) {
+    auto const n_int = static_cast<std::size_t>(d.exp10 + 1);
+    return out.put(d.digits, n_int) and (not point or out.put('.')) and
+           out.put(d.digits + n_int, static_cast<std::size_t>(d.n_digits) - n_int);
+  }
+  auto const n_zeros = static_cast<std::size_t>(-d.exp10 - 1);
+  return out.put('0') and (not point or out.put('.')) and out.put_n('0', n_zeros) and
+         out.put(d.digits, static_cast<std::size_t>(d.n_digits));
+}
+
+/// Writes the digits of `d` in scientific notation with `p` digits after the point.
+inline auto write_exp(char_sink_t& out, decimal_t d, long p, bool point, bool upper) noexcept
+    -> bool {
+  if (d.n_digits == 0) {
+    return out.put('0') and (not point or out.put('.')) and
+           out.put_n('0', static_cast<std::size_t>(p)) and
+           write_exponent(out, upper ? 'E' : 'e', 0);
+  }
+  return out.put(d.digits[0]) and (not point or out.put('.')) and
+         out.put(d.digits + 1, static_cast<std::size_t>(d.n_digits - 1)) and
+         write_exponent(out, upper ? 'E' : 'e', d.exp10);
+}
+
+/// Writes the shortest digits `d` of `x` in fixed notation. When they stop before the point, the
+/// integral digits of `x` are written instead of zeros, since they are closer to `x` for the same
+/// length.
+inline auto write_fixed_round_trip(char_sink_t& out, mpfr_srcptr x, decimal_t d) -> bool {
+  if (d.n_digits == 0) {
+    return out.put('0');
+  }
+  if (d.exp10 + 1 > d.n_digits) {
+    scratch_chars_t scratch;
+    return write_fixed(out, to_decimal(x, float_format_e::fixed, 0, scratch), 0, false);
+  }
+  if (d.exp10 + 1 == d.n_digits) {
+    return write_fixed(out, d, 0, false);
+  }
+  return write_fixed(out, d, d.n_digits - 1 - d.exp10, true);
+}
+
+/// Writes `x` with its shortest digits `d`, which hold no trailing zeros, in the notation
+/// `format`.
+inline auto write_round_trip(
+    char_sink_t& out, mpfr_srcptr x, decimal_t d, float_format_e format, bool upper) -> bool {
+  long const n = d.n_digits == 0 ? 1 : d.n_digits;
+  switch (format) {
+  case float_format_e::fixed:
+    return write_fixed_round_trip(out, x, d);
+  case float_format_e::exp:
+    return write_exp(out, d, n - 1, n > 1, upper);
+  case float_format_e::general:
+    // the notation of printf with the default precision, as std::to_chars
+    if (d.exp10 >= -4 and d.exp10 < 6) {
+      return write_fixed_round_trip(out, x, d);
+    }
+    return write_exp(out, d, n - 1, n > 1, upper);
+  default: {
+    long exp_digits = 1;
+    for (long e = d.exp10 < 0 ? -d.exp10 : d.exp10; e >= 10; e /= 10) {
+      ++exp_digits;
+    }
+    long const exp_len = n + (n > 1 ? 1 : 0) + 2 + (exp_digits < 2 ? 2 : exp_digits);
+    long const fixed_len = d.exp10 >= 0 ? (d.exp10 + 1 >= n ? d.exp10 + 1 : n + 1)
+                                        : n + 1 - d.exp10;
+    if (fixed_len <= exp_len) {
+      return write_fixed_round_trip(out, x, d);
+    }
+    return write_exp(out, d, n - 1, n > 1, upper);
+  }
+  }
+}
+
+/// Bits of the significand of a regular number, indexed from the leading one.
+struct significand_bits_t {
+  mp_limb_t const* limbs;
+  mpfr_prec_t n_limbs;
+
+  explicit significand_bits_t(mpfr_srcptr x) noexcept
+      : limbs{static_cast<mp_limb_t const*>(mpfr_custom_get_significand(x))},
+        n_limbs{static_cast<mpfr_prec_t>(prec_to_nlimb(mpfr_get_prec(x)))} {}
+
+  /// \return The `n <= 4` bits starting at index `i`, with zeros past the end.
+  auto get(mpfr_prec_t i, int n) const noexcept -> unsigned {
+    constexpr mpfr_prec_t limb_bits = GMP_NUMB_BITS;
+    mpfr_prec_t const li = i / limb_bits;
+    if (li >= n_limbs) {
+      return 0;
+    }
+    auto const off = static_cast<int>(i % limb_bits);
+    mp_limb_t const hi = limbs[n_limbs - 1 - li];
+    mp_limb_t const mask = (mp_limb_t{1} << n) - 1;
+    if (off + n <= limb_bits) {
+      return static_cast<unsigned>((hi >> (limb_bits - off - n)) & mask);
+    }
+    // straddles two limbs
+    int const n_lo = off + n - static_cast<int>(limb_bits);
+    mp_limb_t const lo = li + 1 < n_limbs ? limbs[n_limbs - 2 - li] : 0;
+    mp_limb_t const bits = (hi << n_lo) | (lo >> (limb_bits - n_lo));
+    return static_cast<unsigned>(bits & mask);
+  }
+
+  /// \return Whether any bit from index `i` onwards is set.
+  auto any_from(mpfr_prec_t i) const noexcept -> bool {
+    constexpr mpfr_prec_t limb_bits = GMP_NUMB_BITS;
+    mpfr_prec_t const li = i / limb_bits;
+    if (li >= n_limbs) {
+      return false;
+    }
+    auto const off = static_cast<int>(i % limb_bits);
+    mp_limb_t const first = off == 0 ? limbs[n_limbs - 1 - li]
+                                     : limbs[n_limbs - 1 - li] << off;
+    if (first != 0) {
+      return true;
+    }
+    for (mpfr_prec_t k = n_limbs - 2 - li; k >= 0; --k) {
+      if (limbs[k] != 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/// Writes `|x|` in hexadecimal or binary scientific notation, as `1.ddd` followed by a binary
+/// exponent, with the digits read directly from the significand and rounded to nearest, ties to
+/// even. A negative precision writes all the digits up to the last nonzero one.
+inline auto write_pow2(char_sink_t& out, mpfr_srcptr x, float_spec_t const& spec) noexcept
+    -> bool {
+  bool const hex = spec.format == float_format_e::hex;
+  int const digit_bits = hex ? 4 : 1;
+  char const* const digit_chars = spec.upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  char const marker = hex ? (spec.upper ? 'P' : 'p') : 'p';
+
+  if (hex and spec.hex_prefix and not out.put(spec.upper ? "0X" : "0x", 2)) {
+    return false;
+  }
+  if (mpfr_zero_p(x)) {
+    auto const p = static_cast<std::size_t>(spec.precision < 0 ? 0 : spec.precision);
+    return out.put('0') and (not(p > 0 or spec.alt) or out.put('.')) and out.put_n('0', p) and
+           write_exponent(out, marker, 0, 1);
+  }
+
+  mpfr_prec_t const prec = mpfr_get_prec(x);
+  significand_bits_t const bits{x};
+  bool const exact = spec.precision < 0;
+  mpfr_prec_t const p = exact ? (prec - 1 + digit_bits - 1) / digit_bits : spec.precision;
+  long exp2 = static_cast<long>(mpfr_get_exp(x)) - 1;
+
+  bool const point = p > 0 or spec.alt;
+  char* const leading = out.pos;
+  if (not(out.put('1') and (not point or out.put('.')))) {
+    return false;
+  }
+  if (static_cast<mpfr_prec_t>(out.end - out.pos) < p) {
+    return false;
+  }
+  char* const digits = out.pos;
+  for (mpfr_prec_t i = 0; i < p; ++i) {
+    digits[i] = digit_chars[bits.get(1 + i * digit_bits, digit_bits)];
+  }
+  out.pos += p;
+
+  // round to nearest on the first discarded bit, ties to even
+  mpfr_prec_t const n_kept = 1 + p * digit_bits;
+  if (not exact and n_kept < prec and bits.get(n_kept, 1) == 1) {
+    bool const odd = (bits.get(n_kept - 1, 1) == 1);
+    if (odd or bits.any_from(n_kept + 1)) {
+      mpfr_prec_t i = p - 1;
+      char const max_digit = digit_chars[(1 << digit_bits) - 1];
+      while (i >= 0 and digits[i] == max_digit) {
+        digits[i] = '0';
+        --i;
+      }
+      if (i >= 0) {
+        auto const pos = static_cast<std::size_t>(
+            std::strchr(digit_chars, digits[i]) - digit_chars);
+        digits[i] = digit_chars[pos + 1];
+      } else if (hex) {
+        // 1.ff...f rounds up to 2.00...0, as printf does
+        *leading = '2';
+      } else {
+        // 1.11...1 rounds up to 1.00...0 with a larger exponent
+        ++exp2;
+      }
+    }
+  }
+  if (exact) {
+    while (out.pos != digits and out.pos[-1] == '0') {
+      --out.pos;
+    }
+    if (point and out.pos == digits and not spec.alt) {
+      // drop the point
+      --out.pos;
+    }
+  }
+  return write_exponent(out, marker, exp2, 1);
+}
+
+/// \return The value of the digit `c`, or a value larger than any digit if it is not one.
+constexpr auto digit_value(char c) noexcept -> unsigned {
+  return (c >= '0' and c <= '9')   ? static_cast<unsigned>(c - '0')
+         : (c >= 'a' and c <= 'f') ? static_cast<unsigned>(c - 'a' + 10)
+         : (c >= 'A' and c <= 'F') ? static_cast<unsigned>(c - 'A' + 10)
+                                   : 255U;
+}
+
+/// Sets `out` to the number `[first, last)` written in base `2^digit_bits` as `ddd.ddd`, followed
+/// by an optional binary exponent `p[+-]ddd`, with the sign given by `negative`. The input must
+/// be well formed.\n
+/// The digits are copied bit by bit to a significand with two more bits than `out`, the last
+/// one being set if any of the remaining bits are, which is then rounded once to `out`.
+inline void parse_pow2(
+    char const* first,
+    char const* last,
+    int digit_bits,
+    bool negative,
+    mpfr_ptr out,
+    mpfr_rnd_t rnd) {
+  constexpr mpfr_prec_t limb_bits = GMP_NUMB_BITS;
+  mpfr_prec_t const prec = mpfr_get_prec(out) + 2;
+  auto const n_limbs = static_cast<mpfr_prec_t>(prec_to_nlimb(prec));
+  mp_limb_t stack_limbs[16] = {};
+  std::vector<mp_limb_t> heap_limbs(n_limbs > 16 ? static_cast<std::size_t>(n_limbs) : 0);
+  mp_limb_t* const limbs = heap_limbs.empty() ? stack_limbs : heap_limbs.data();
+
+  // value: 0.b[0]b[1]... * 2^exp2, where b[0] is the leading one
+  mpfr_prec_t n_bits = 0;
+  bool sticky = false;
+  long long exp2 = 0;
+  bool after_point = false;
+
+  constexpr long long exp_limit = 1LL << 58;
+  char const* it = first;
+  for (; it != last and *it != 'p' and *it != 'P'; ++it) {
+    if (*it == '.') {
+      after_point = true;
+      continue;
+    }
+    unsigned const d = digit_value(*it);
+    for (int b = digit_bits - 1; b >= 0; --b) {
+      bool const bit = ((d >> b) & 1U) == 1U;
+      if (n_bits == 0 and not bit) {
+        // leading zero
+        exp2 -= after_point ? 1 : 0;
+        continue;
+      }
+      if (not after_point and exp2 < exp_limit) {
+        ++exp2;
+      }
+      if (n_bits < prec - 1) {
+        if (bit) {
+          limbs[n_limbs - 1 - n_bits / limb_bits] |= mp_limb_t{1}
+                                                     << (limb_bits - 1 - n_bits % limb_bits);
+        }
+        ++n_bits;
+      } else {
+        sticky = sticky or bit;
+      }
+    }
+  }
+
+  if (n_bits == 0) {
+    mpfr_set_zero(out, negative ? -1 : 1);
+    return;
+  }
+
+  if (it != last) {
+    // binary exponent, saturated far beyond any exponent range
+    ++it;
+    bool const exp_negative = *it == '-';
+    if (*it == '+' or *it == '-') {
+      ++it;
+    }
+    long long e = 0;
+    for (; it != last; ++it) {
+      e = e < exp_limit ? 10 * e + (*it - '0') : e;
+    }
+    exp2 += exp_negative ? -e : e;
+  }
+  if (sticky) {
+    limbs[0] |= mp_limb_t{1} << (n_limbs * limb_bits - prec);
+  }
+
+  mpfr_t significand;
+  mpfr_custom_init_set(
+      significand, (negative ? -1 : 1) * MPFR_REGULAR_KIND, 0, prec, limbs);
+  mpfr_exp_t const exp_max = mpfr_get_emax_max();
+  mpfr_exp_t const exp_min = mpfr_get_emin_min();
+  mpfr_exp_t const clamped = exp2 > exp_max   ? exp_max
+                             : exp2 < exp_min ? exp_min
+                                              : static_cast<mpfr_exp_t>(exp2);
+  mpfr_mul_2si(out, significand, clamped, rnd);
+}
+
+/// Removes the trailing zeros of the fractional part in `[begin, end)`, along with the point if
+/// nothing remains after it.
+inline auto strip_trailing_zeros(char* begin, char* end) noexcept -> char* {
+  char* point = static_cast<char*>(std::memchr(begin, '.', static_cast<std::size_t>(end - begin)));
+  if (point == nullptr) {
+    return end;
+  }
+  while (end[-1] == '0') {
+    --end;
+  }
+  if (end[-1] == '.') {
+    --end;
+  }
+  return end;
+}
+
+/// \return An upper bound of the number of characters written by `write_float_abs`.
+inline auto float_chars_bound(mpfr_srcptr x, float_spec_t const& spec) noexcept -> std::size_t {
+  constexpr std::size_t exponent_and_point = 32;
+  bool const hex_or_binary =
+      spec.format == float_format_e::hex or spec.format == float_format_e::binary;
+  auto const p = static_cast<std::size_t>(
+      spec.precision >= 0 ? spec.precision : hex_or_binary ? 0 : 6);
+  if (not mpfr_regular_p(x)) {
+    return exponent_and_point + p;
+  }
+  if (spec.round_trip_prec > 0 and not hex_or_binary) {
+    auto const digits = static_cast<std::size_t>(round_trip_digits(spec.round_trip_prec));
+    if (spec.format != float_format_e::fixed) {
+      return exponent_and_point + digits;
+    }
+    long const exp10 = log10_pow2_upper(mpfr_get_exp(x));
+    return exponent_and_point + digits + static_cast<std::size_t>(exp10 < 0 ? 2 - exp10 : exp10);
+  }
+  switch (spec.format) {
+  case float_format_e::hex:
+  case float_format_e::binary: {
+    long const digits =
+        spec.precision >= 0 ? spec.precision : static_cast<long>(mpfr_get_prec(x)) + 1;
+    return exponent_and_point + static_cast<std::size_t>(digits);
+  }
+  case float_format_e::fixed: {
+    long const exp10 = log10_pow2_upper(mpfr_get_exp(x));
+    return exponent_and_point + static_cast<std::size_t>(exp10 < 0 ? 0 : exp10) + p;
+  }
+  default:
+    return exponent_and_point + p;
+  }
+}
+
+/// Writes `|x|` to `[first, last)` following `spec`.
+/// \return The end of the written characters, or `nullptr` if they do not fit.
+inline auto write_float_abs(char* first, char* last, mpfr_cref_t x, float_spec_t spec) -> char* {
+  MPFR_SIGN(&x.m) = 1;
+  char_sink_t out{first, last};
+
+  if (mpfr_nan_p(&x.m)) {
+    return out.put(spec.upper ? "NAN" : "nan", 3) ? out.pos : nullptr;
+  }
+  if (mpfr_inf_p(&x.m)) {
+    return out.put(spec.upper ? "INF" : "inf", 3) ? out.pos : nullptr;
+  }
+
+  if (spec.format == float_format_e::hex or spec.format == float_format_e::binary) {
+    return write_pow2(out, &x.m, spec) ? out.pos : nullptr;
+  }
+
+  scratch_chars_t scratch;
+  if (spec.round_trip_prec > 0) {
+    decimal_t d = mpfr_zero_p(&x.m) ? decimal_t{nullptr, 0, 0}
+                                    : shortest_decimal(&x.m, spec.round_trip_prec, scratch);
+    return write_round_trip(out, &x.m, d, spec.format, spec.upper) ? out.pos : nullptr;
+  }
+  if (spec.format == float_format_e::shortest) {
+    spec.format = float_format_e::general;
+  }
+
+  long p = spec.precision < 0 ? 6 : spec.precision;
+  bool const point = p > 0 or spec.alt;
+
+  if (spec.format == float_format_e::fixed) {
+    decimal_t d = mpfr_zero_p(&x.m) ? decimal_t{nullptr, 0, 0}
+                                    : to_decimal(&x.m, float_format_e::fixed, p, scratch);
+    return write_fixed(out, d, p, point) ? out.pos : nullptr;
+  }
+  if (spec.format == float_format_e::exp) {
+    decimal_t d = mpfr_zero_p(&x.m) ? decimal_t{nullptr, 0, 0}
+                                    : to_decimal(&x.m, float_format_e::exp, p, scratch);
+    return write_exp(out, d, p, point, spec.upper) ? out.pos : nullptr;
+  }
+
+  // general, the notation depends on the exponent after rounding
+  p = p == 0 ? 1 : p;
+  decimal_t d = mpfr_zero_p(&x.m) ? decimal_t{nullptr, 0, 0}
+                                  : to_decimal(&x.m, float_format_e::general, p, scratch);
+  bool ok = false;
+  if (p > d.exp10 and d.exp10 >= -4) {
+    long const p_fixed = p - 1 - d.exp10;
+    ok = write_fixed(out, d, p_fixed, p_fixed > 0 or spec.alt);
+  } else {
+    ok = write_exp(out, d, p - 1, p > 1 or spec.alt, spec.upper);
+  }
+  if (not ok) {
+    return nullptr;
+  }
+  if (spec.alt) {
+    return out.pos;
+  }
+  if (p > d.exp10 and d.exp10 >= -4) {
+    return strip_trailing_zeros(first, out.pos);
+  }
+  // trailing zeros of the mantissa, before the exponent
+  char* exp_marker = out.pos - 1;
+  while (*exp_marker != 'e' and *exp_marker != 'E') {
+    --exp_marker;
+  }
+  char* mantissa_end = strip_trailing_zeros(first, exp_marker);
+  std::size_t const exp_len = static_cast<std::size_t>(out.pos - exp_marker);
+  std::memmove(mantissa_end, exp_marker, exp_len);
+  return mantissa_end + exp_len;
+}
+
+/// \return The formatting options of `out`. As with the standard streams, hexfloat output ignores
+/// the precision.
+template <typename CharT, typename Traits>
+auto ostream_spec(std::basic_ostream<CharT, Traits>& out) -> float_spec_t {
+  using ostr = std::basic_ostream<CharT, Traits>;
+  float_spec_t spec;
+  bool hf = _::has_flag(out, ostr::scientific) and _::has_flag(out, ostr::fixed);
+  spec.format = hf                                  ? float_format_e::hex
+                : _::has_flag(out, ostr::scientific) ? float_format_e::exp
+                : _::has_flag(out, ostr::fixed)      ? float_format_e::fixed
+                                                    : float_format_e::general;
+  spec.precision =
+      hf ? -1 : (out.precision() > 0 ? static_cast<long>(out.precision()) : 0);
+  spec.upper = _::has_flag(out, ostr::uppercase);
+  spec.alt = _::has_flag(out, ostr::showpoint);
+  return spec;
+}
+
+/// Number of characters needed by `write_padded`.
+inline auto padded_chars_bound(mpfr_srcptr x, float_spec_t const& spec, std::size_t width) noexcept
+    -> std::size_t {
+  std::size_t const n = float_chars_bound(x, spec);
+  return 1 + width + (n > width ? n : width);
+}
+
+/// Writes `x` to `buf`, which must hold `padded_chars_bound(x, spec, width)` characters, padded
+/// with `fill` to `width` characters following the adjustment flags of `flags`, as the standard
+/// streams do.\n
+/// The digits are written first, at a position leaving room for the sign and the largest
+/// padding in front of them, so that the padding and the sign can then be written around them
+/// without moving any character.
+///
+/// \return The range of the written characters.
+inline auto write_padded(
+    char* buf,
+    mpfr_cref_t x,
+    float_spec_t const& spec,
+    std::ios_base::fmtflags flags,
+    char fill,
+    std::size_t width) noexcept -> std::pair<char*, char*> {
+  char* const digits = buf + 1 + width;
+  char* const end = write_float_abs(digits, buf + padded_chars_bound(&x.m, spec, width), x, spec);
+  auto const len = static_cast<std::size_t>(end - digits);
+
+  bool const signbit = mpfr_signbit(&x.m);
+  std::size_t const n_sign = (signbit or (flags & std::ios_base::showpos) != 0) ? 1 : 0;
+  std::size_t const n_padding = width > len + n_sign ? width - len - n_sign : 0;
+  char const sign = signbit ? '-' : '+';
+
+  auto const adjust = flags & std::ios_base::adjustfield;
+  if (adjust == std::ios_base::left) {
+    char* const first = digits - n_sign;
+    std::memset(first, sign, n_sign);
+    std::memset(end, fill, n_padding);
+    return {first, end + n_padding};
+  }
+  char* const first = digits - n_sign - n_padding;
+  if (adjust == std::ios_base::internal) {
+    std::memset(first, sign, n_sign);
+    std::memset(first + n_sign, fill, n_padding);
+  } else {
+    std::memset(first, fill, n_padding);
+    std::memset(first + n_padding, sign, n_sign);
+  }
+  return {first, end};
+}
+
+template <typename CharT, typename Traits>
+void write_to_ostream(
+    std::basic_ostream<CharT, Traits>& out,
+    mpfr_cref_t x_,
+    char* stack_buffer,
+    size_t stack_bufsize) {
+  using ostr = std::basic_ostream<CharT, Traits>;
+
+  float_spec_t const spec = _::ostream_spec(out);
+  bool signbit = mpfr_signbit(&x_.m);
+
+  std::size_t const bound = _::float_chars_bound(&x_.m, spec) + 1;
+  bool use_heap = bound > stack_bufsize;
+  _::heap_str_t heap_buffer{use_heap ? bound : 0};
+  char* ptr = use_heap ? heap_buffer.p : stack_buffer;
+
+  char* end = _::write_float_abs(ptr, ptr + bound, x_, spec);
+  *end = '\0';
+  auto const len = static_cast<std::size_t>(end - ptr);
+
+  std::size_t n_sign = (signbit or _::has_flag(out, ostr::showpos)) ? 1 : 0;
+  std::size_t n_padding = 0;
+  if (static_cast<std::size_t>(out.width()) >= len + n_sign) {
+    n_padding = static_cast<std::size_t>(out.width()) - len - n_sign;
+  }
+
+  out.width(0);
+  if (not _::has_flag(out, ostr::left) and not _::has_flag(out, ostr::internal)) {
+    _::print_n(out, out.fill(), n_padding);
+  }
+
+  if (signbit) {
+    out.put(out.widen('-'));
+  } else if (_::has_flag(out, ostr::showpos)) {
+    out.put(out.widen('+'));
+  }
+
+  if (_::has_flag(out, ostr::internal)) {
+    _::print_n(out, out.fill(), n_padding);
+  }
+
+  out << ptr;
+
+  if (_::has_flag(out, ostr::left)) {
+    _::print_n(out, out.fill(), n_padding);
+  }
+}
+
+/// Same as above for narrow streams, whose characters are the ones of `write_float_abs`, since
+/// the output does not depend on the locale. The whole field is formatted in memory and handed to
+/// the stream buffer with a single `sputn`, under a single sentry.
+template <typename Traits>
+void write_to_ostream(
+    std::basic_ostream<char, Traits>& out,
+    mpfr_cref_t x_,
+    char* stack_buffer,
+    size_t stack_bufsize) {
+  typename std::basic_ostream<char, Traits>::sentry guard{out};
+  if (not guard) {
+    return;
+  }
+  float_spec_t const spec = _::ostream_spec(out);
+  auto const width = static_cast<std::size_t>(out.width() > 0 ? out.width() : 0);
+  out.width(0);
+
+  std::size_t const bound = _::padded_chars_bound(&x_.m, spec, width);
+  bool use_heap = bound > stack_bufsize;
+  _::heap_str_t heap_buffer{use_heap ? bound : 0};
+  char* ptr = use_heap ? heap_buffer.p : stack_buffer;
+
+  auto const chars = _::write_padded(ptr, x_, spec, out.flags(), out.fill(), width);
+  auto const n = static_cast<std::streamsize>(chars.second - chars.first);
+  if (out.rdbuf()->sputn(chars.first, n) != n) {
+    out.setstate(std::ios_base::badbit);
+  }
+}
+
+} // namespace _
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard CHARCONV_HPP_2HXW9QBU */
@@ -8,6 +8,7 @@
 #include <limits>
 #include <iosfwd>
 #include <initializer_list>
+#include <utility>
 
 #if MPFR_CXX_HAS_MATH_BUILTINS == 0
 // for std::{fabs,frexp,signbit}
@@ -325,15 +326,65 @@ struct impl_access {
   }
 };
 
+/// Copy of the exponent range of MPFR for the calling thread, that is only read while `enabled`
+/// is set, since the exponent range can otherwise be changed directly with MPFR. It is enabled
+/// by `thread_env` and on the workers of the thread pool, where the exponent range is set with
+/// `set_exp_range`.
+struct exp_range_cache_t {
+  mpfr_exp_t emin;
+  mpfr_exp_t emax;
+  bool enabled;
+};
+
+inline auto exp_range_cache() noexcept -> exp_range_cache_t& {
+  thread_local exp_range_cache_t cache{0, 0, false};
+  return cache;
+}
+
+HEDLEY_ALWAYS_INLINE auto get_emin() noexcept -> mpfr_exp_t {
+  exp_range_cache_t const& cache = _::exp_range_cache();
+  return cache.enabled ? cache.emin : mpfr_get_emin();
+}
+
+HEDLEY_ALWAYS_INLINE auto get_emax() noexcept -> mpfr_exp_t {
+  exp_range_cache_t const& cache = _::exp_range_cache();
+  return cache.enabled ? cache.emax : mpfr_get_emax();
+}
+
+/// Sets the exponent range of MPFR for the calling thread, and its cached copy.
+inline void set_exp_range(mpfr_exp_t emin, mpfr_exp_t emax) noexcept {
+  mpfr_set_emin(emin);
+  mpfr_set_emax(emax);
+  exp_range_cache_t& cache = _::exp_range_cache();
+  cache.emin = mpfr_get_emin();
+  cache.emax = mpfr_get_emax();
+}
+
+/// Frees the caches that MPFR keeps for the calling thread, such as the constants, when the
+/// thread exits. The caches shared by all threads are left alone.
+inline void free_cache_at_thread_exit() noexcept {
+  struct guard_t /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+    ~guard_t() {
+#if MPFR_VERSION_MAJOR >= 4
+      mpfr_free_cache2(MPFR_FREE_LOCAL_CACHE);
+#else
+      mpfr_free_cache();
+#endif
+    }
+  };
+  thread_local guard_t guard;
+  static_cast<void>(guard);
+}
+
 HEDLEY_ALWAYS_INLINE auto mul_b_is_pow2_check(mpfr_exp_t a_exp, mpfr_exp_t b_exponent, bool div)
     -> bool {
   typename _::remove_pointer<mpfr_ptr>::type ea_{0, 0, a_exp, nullptr};
 
   mpfr_prec_t eb{div ? (1 - b_exponent) : b_exponent - 1};
 
-  return mpfr_regular_p(&ea_) and           //
-         (a_exp + eb) < mpfr_get_emax() and //
-         (a_exp + eb) >= mpfr_get_emin();
+  return mpfr_regular_p(&ea_) and         //
+         (a_exp + eb) < _::get_emax() and //
+         (a_exp + eb) >= _::get_emin();
 }
 
 HEDLEY_ALWAYS_INLINE void mul_b_is_pow2(
@@ -642,6 +693,132 @@ template <> struct is_arithmetic<long double> {
   }
 };
 
+#if MPFR_CXX_USE_FLOAT128 == 1
+
+namespace float128 {
+
+static_assert(GMP_NUMB_BITS == 64, "the float128 backend requires 64 bit limbs");
+
+__extension__ typedef unsigned __int128 u128;
+constexpr mpfr_exp_t exp_bias = 16383;
+constexpr unsigned frac_bits = 112;
+constexpr u128 frac_mask = (u128{1} << frac_bits) - 1U;
+constexpr u128 exp_mask = u128{0x7fff} << frac_bits;
+// exponent range of binary128 with mpfr conventions, including subnormals
+constexpr mpfr_exp_t emin_subnormal = -16493;
+constexpr mpfr_exp_t emin_normal = -16381;
+constexpr mpfr_exp_t emax = 16384;
+
+inline auto count_leading_zeros(u128 x) -> int {
+  auto const hi = static_cast<std::uint64_t>(x >> 64U);
+  auto const lo = static_cast<std::uint64_t>(x);
+  return hi != 0 ? __builtin_clzll(hi) : 64 + __builtin_clzll(lo);
+}
+
+inline auto to_bits(__float128 x) noexcept -> u128 {
+  u128 bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return bits;
+}
+
+inline auto from_bits(u128 bits) noexcept -> __float128 {
+  __float128 x;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+/// Rounds x to binary128 with the rounding mode rnd, handling overflow and subnormals.
+inline auto from_mpfr(mpfr_srcptr x, mpfr_rnd_t rnd) noexcept -> __float128 {
+  mp_limb_t limbs[2]{};
+  mpfr_t r;
+  mpfr_custom_init_set(r, MPFR_ZERO_KIND, 0, static_cast<mpfr_prec_t>(frac_bits + 1), limbs);
+
+  mpfr_exp_t const old_emin = mpfr_get_emin();
+  mpfr_exp_t const old_emax = mpfr_get_emax();
+  mpfr_set_emin(emin_subnormal);
+  mpfr_set_emax(emax);
+  int ternary = mpfr_set(r, x, rnd);
+  ternary = mpfr_check_range(r, ternary, rnd);
+  mpfr_subnormalize(r, ternary, rnd);
+  mpfr_set_emin(old_emin);
+  mpfr_set_emax(old_emax);
+
+  u128 bits = static_cast<u128>(mpfr_signbit(r) != 0) << 127U;
+  if (mpfr_nan_p(r)) {
+    return from_bits(exp_mask | (u128{1} << (frac_bits - 1)));
+  }
+  if (mpfr_inf_p(r)) {
+    return from_bits(bits | exp_mask);
+  }
+  if (mpfr_zero_p(r)) {
+    return from_bits(bits);
+  }
+  u128 const significand = ((static_cast<u128>(limbs[1]) << 64U) | limbs[0]) >> (127 - frac_bits);
+  mpfr_exp_t const exp = mpfr_get_exp(r);
+  if (exp >= emin_normal) {
+    bits |= static_cast<u128>(exp - 1 + exp_bias) << frac_bits;
+    bits |= significand & frac_mask;
+  } else {
+    bits |= significand >> static_cast<unsigned>(emin_normal - exp);
+  }
+  return from_bits(bits);
+}
+
+} // namespace float128
+
+template <> struct is_arithmetic<__float128> {
+  static constexpr bool value = true;
+  static HEDLEY_ALWAYS_INLINE void
+  set(mpfr_exp_t& m_exponent,
+      mpfr_prec_t& m_actual_prec_sign,
+      mpfr_prec_t precision_mpfr,
+      mp_limb_t* m_mantissa,
+      size_t size,
+      __float128 a) {
+    using float128::u128;
+    u128 const bits = float128::to_bits(a);
+    bool const signbit = (bits >> 127U) != 0;
+    auto const biased_exp = static_cast<mpfr_exp_t>((bits & float128::exp_mask) >> 112U);
+    u128 const frac = bits & float128::frac_mask;
+
+    if (biased_exp == 0 and frac == 0) {
+      m_exponent = 0;
+      m_actual_prec_sign = prec_negate_if(0, signbit);
+      std::memset(m_mantissa, 0, sizeof(mp_limb_t) * size);
+      return;
+    }
+
+    _::mpfr_raii_setter_t g{
+        precision_mpfr,
+        m_mantissa,
+        &m_exponent,
+        &m_actual_prec_sign,
+    };
+    if (biased_exp == 0x7fff) {
+      if (frac != 0) {
+        mpfr_set_nan(&g.m);
+      } else {
+        mpfr_set_inf(&g.m, signbit ? -1 : 1);
+      }
+      return;
+    }
+
+    // a = significand * 2^(exp - 112), subnormals have the exponent of the smallest normal numbers
+    u128 const significand = (biased_exp == 0) ? frac : (frac | (u128{1} << 112U));
+    mpfr_exp_t const exp = ((biased_exp == 0) ? 1 : biased_exp) - float128::exp_bias;
+    int const shift = float128::count_leading_zeros(significand);
+    u128 const aligned = significand << static_cast<unsigned>(shift);
+    mp_limb_t limbs[2]{static_cast<mp_limb_t>(aligned), static_cast<mp_limb_t>(aligned >> 64U)};
+
+    mpfr_t x;
+    mpfr_custom_init_set(
+        x, (signbit ? -1 : 1) * MPFR_REGULAR_KIND, exp + 128 - 112 - shift, 128, limbs);
+    mpfr_set(&g.m, x, _::get_rnd());
+  }
+};
+
+#endif
+
 template <typename T> struct is_mp_float { static constexpr bool value = false; };
 template <precision_t P> struct is_mp_float<mp_float_t<P>> { static constexpr bool value = true; };
 template <precision_t P> struct is_mp_float<mp_float_t<P> const> {
@@ -676,11 +853,197 @@ inline void set_div(mpfr_raii_setter_t& out, mpfr_cref_t a, mpfr_cref_t b) {
   mpfr_div(&out.m, &a.m, &b.m, _::get_rnd());
 }
 
+#if MPFR_CXX_USE_FLOAT128 == 1
+
+namespace float128 {
+
+// fast path for the basic operations when the operands and the result fit in a single limb.
+// the exact result, or a truncation of it with a sticky bit, is computed in a 128 bit integer,
+// then rounded once to the target precision, so it matches what mpfr returns including the
+// inexact flag. results outside the exponent range are recomputed by mpfr.
+constexpr mpfr_prec_t max_prec = 63;
+
+enum struct op_e { add, sub, mul, div, other };
+
+inline auto op_kind(void (*op)(mpfr_raii_setter_t&, mpfr_cref_t, mpfr_cref_t)) -> op_e {
+  return op == &set_add   ? op_e::add
+         : op == &set_sub ? op_e::sub
+         : op == &set_mul ? op_e::mul
+         : op == &set_div ? op_e::div
+                          : op_e::other;
+}
+
+template <precision_t P> constexpr auto is_supported() -> bool {
+  return static_cast<mpfr_prec_t>(P) <= max_prec;
+}
+
+/// Rounds x * 2^(exp - 128), where the most significant bit of x is set, to the precision of
+/// out. The sticky bit is set if the exact value is larger than x.
+/// \return false if the result is outside the current exponent range, in which case out is left
+/// untouched.
+template <precision_t P>
+auto round_into(mp_float_t<P>& out, u128 x, bool sticky, mpfr_exp_t exp, bool signbit)
+    -> bool {
+  constexpr auto prec = static_cast<unsigned>(P);
+  u128 q = x >> (128U - prec);
+  u128 const rem = x & ((u128{1} << (128U - prec)) - 1U);
+  u128 const half = u128{1} << (127U - prec);
+  bool const inexact = rem != 0 or sticky;
+
+  bool round_up = false;
+  switch (_::get_rnd()) {
+  case MPFR_RNDN:
+    round_up = rem > half or (rem == half and (sticky or (q & 1U) != 0));
+    break;
+  case MPFR_RNDU:
+    round_up = inexact and not signbit;
+    break;
+  case MPFR_RNDD:
+    round_up = inexact and signbit;
+    break;
+  default:
+    break;
+  }
+  if (round_up) {
+    ++q;
+    if ((q >> prec) != 0) {
+      q >>= 1U;
+      ++exp;
+    }
+  }
+  if (exp < _::get_emin() or exp > _::get_emax()) {
+    return false;
+  }
+
+  auto const limb = static_cast<mp_limb_t>(q) << (64U - prec);
+  impl_access::mantissa_mut(out)[0] = limb;
+  impl_access::exp_mut(out) = exp;
+  impl_access::actual_prec_sign_mut(out) =
+      prec_negate_if(64 - _::count_trailing_zeros(limb), signbit);
+  if (inexact) {
+    mpfr_set_inexflag();
+  }
+  return true;
+}
+
+template <precision_t R, precision_t P, precision_t Q>
+auto add(mp_float_t<R>& out, mp_float_t<P> const& a, mp_float_t<Q> const& b, bool negate_b)
+    -> bool {
+  mp_limb_t ma = impl_access::mantissa_const(a)[0];
+  mp_limb_t mb = impl_access::mantissa_const(b)[0];
+  mpfr_exp_t ea = impl_access::exp_const(a);
+  mpfr_exp_t eb = impl_access::exp_const(b);
+  bool sa = impl_access::actual_prec_sign_const(a) < 0;
+  bool sb = (impl_access::actual_prec_sign_const(b) < 0) != negate_b;
+  if (ea < eb or (ea == eb and ma < mb)) {
+    std::swap(ma, mb);
+    std::swap(ea, eb);
+    std::swap(sa, sb);
+  }
+
+  // |a| >= |b|, the top bit is kept free for the carry.
+  // the bits of b that are shifted out can only be nonzero when the exponents differ by more
+  // than one, so the result loses at most one leading bit, and is computed rounded down, with a
+  // sticky bit far below the rounding position.
+  u128 const x = static_cast<u128>(ma) << 63U;
+  u128 y = static_cast<u128>(mb) << 63U;
+  bool sticky = false;
+  mpfr_exp_t const diff = ea - eb;
+  if (diff >= 128) {
+    y = 0;
+    sticky = true;
+  } else if (diff > 0) {
+    auto const shift = static_cast<unsigned>(diff);
+    sticky = (y & ((u128{1} << shift) - 1U)) != 0;
+    y >>= shift;
+  }
+
+  u128 const sum = (sa == sb) ? x + y : x - y - static_cast<u128>(sticky);
+  if (sum == 0) {
+    impl_access::mantissa_mut(out)[0] = 0;
+    impl_access::exp_mut(out) = 0;
+    impl_access::actual_prec_sign_mut(out) = prec_negate_if(0, _::get_rnd() == MPFR_RNDD);
+    return true;
+  }
+  int const shift = count_leading_zeros(sum);
+  return round_into(out, sum << static_cast<unsigned>(shift), sticky, ea + 1 - shift, sa);
+}
+
+template <precision_t R, precision_t P, precision_t Q>
+auto mul(mp_float_t<R>& out, mp_float_t<P> const& a, mp_float_t<Q> const& b) -> bool {
+  u128 const prod = static_cast<u128>(impl_access::mantissa_const(a)[0]) *
+                    impl_access::mantissa_const(b)[0];
+  int const shift = count_leading_zeros(prod);
+  return round_into(
+      out,
+      prod << static_cast<unsigned>(shift),
+      false,
+      impl_access::exp_const(a) + impl_access::exp_const(b) - shift,
+      (impl_access::actual_prec_sign_const(a) < 0) != (impl_access::actual_prec_sign_const(b) < 0));
+}
+
+template <precision_t R, precision_t P, precision_t Q>
+auto div(mp_float_t<R>& out, mp_float_t<P> const& a, mp_float_t<Q> const& b) -> bool {
+  // the quotient has at least 64 significant bits, which leaves a rounding bit for max_prec
+  u128 const num = static_cast<u128>(impl_access::mantissa_const(a)[0]) << 64U;
+  mp_limb_t const den = impl_access::mantissa_const(b)[0];
+  u128 const quot = num / den;
+  int const shift = count_leading_zeros(quot);
+  return round_into(
+      out,
+      quot << static_cast<unsigned>(shift),
+      num % den != 0,
+      impl_access::exp_const(a) - impl_access::exp_const(b) + 64 - shift,
+      (impl_access::actual_prec_sign_const(a) < 0) != (impl_access::actual_prec_sign_const(b) < 0));
+}
+
+template <bool Supported> struct binary_op_impl {
+  template <precision_t R, precision_t P, precision_t Q>
+  static auto apply(mp_float_t<R>&, mp_float_t<P> const&, mp_float_t<Q> const&, op_e) -> bool {
+    return false;
+  }
+};
+
+template <> struct binary_op_impl<true> {
+  template <precision_t R, precision_t P, precision_t Q>
+  static auto apply(mp_float_t<R>& out, mp_float_t<P> const& a, mp_float_t<Q> const& b, op_e op)
+      -> bool {
+    if (prec_abs(impl_access::actual_prec_sign_const(a)) == 0 or
+        prec_abs(impl_access::actual_prec_sign_const(b)) == 0) {
+      return false;
+    }
+    switch (op) {
+    case op_e::add:
+      return float128::add(out, a, b, false);
+    case op_e::sub:
+      return float128::add(out, a, b, true);
+    case op_e::mul:
+      return float128::mul(out, a, b);
+    case op_e::div:
+      return float128::div(out, a, b);
+    default:
+      return false;
+    }
+  }
+};
+
+/// \return whether the operation was carried out, otherwise it must be computed by mpfr.
+template <precision_t R, precision_t P, precision_t Q>
+auto try_binary_op(mp_float_t<R>& out, mp_float_t<P> const& a, mp_float_t<Q> const& b, op_e op)
+    -> bool {
+  return binary_op_impl<is_supported<R>() and is_supported<P>() and is_supported<Q>()>::apply(
+      out, a, b, op);
+}
+
+} // namespace float128
+
+#endif
+
 struct heap_str_t /* NOLINT(cppcoreguidelines-special-member-functions) */ {
   char* p;
   explicit heap_str_t(size_t n) : p{n > 0 ? new char[n] : nullptr} {}
   void init(size_t n) {
-    if (p == nullptr) {
+    if (p != nullptr) {
       _::crash_with_message("can only be used on uninitialized pointer");
     }
     p = n > 0 ? new char[n] : nullptr;
@@ -713,94 +1076,6 @@ void print_n(
   out.write(buffer, static_cast<std::streamsize>(n));
 }
 
-template <typename CharT, typename Traits>
-void write_to_ostream(
-    std::basic_ostream<CharT, Traits>& out,
-    mpfr_cref_t x_,
-    char* stack_buffer,
-    size_t stack_bufsize) {
-  using ostr = std::basic_ostream<CharT, Traits>;
-
-  char format[128] = {};
-  std::size_t pos = 0;
-  format[pos++] = '%';
-  format[pos++] = '.';
-
-  bool hf = _::has_flag(out, ostr::scientific) and _::has_flag(out, ostr::fixed);
-  long precision = hf ? mpfr_get_prec(&x_.m) / 4 : static_cast<long>(out.precision());
-  if (precision > 0) {
-    std::snprintf(format + pos, sizeof(format) - pos, "%ld", precision);
-  }
-  pos = std::strlen(format);
-  format[pos++] = 'R';
-
-  bool u = has_flag(out, ostr::uppercase);
-  if (hf) {
-    format[pos++] = u ? 'A' : 'a';
-  } else if (_::has_flag(out, ostr::scientific)) {
-    format[pos++] = u ? 'E' : 'e';
-  } else if (_::has_flag(out, ostr::fixed)) {
-    format[pos++] = u ? 'F' : 'f';
-  } else {
-    format[pos++] = u ? 'G' : 'g';
-  }
-  format[pos++] = '\0';
-
-  bool signbit = mpfr_signbit(&x_.m);
-  MPFR_SIGN(&x_.m) = 1;
-
-  auto const size_needed = static_cast<std::size_t>(mpfr_snprintf(nullptr, 0, format, &x_.m)) + 1;
-
-  std::size_t zero_padding = 0;
-
-  bool use_heap = size_needed > stack_bufsize;
-  _::heap_str_t heap_buffer{use_heap ? size_needed : 0};
-
-  char* ptr = use_heap ? heap_buffer.p : stack_buffer;
-
-  mpfr_snprintf(ptr, size_needed, format, &x_.m);
-  if (not hf and _::has_flag(out, ostr::showpoint) and out.precision() > 0) {
-    char* dot_ptr = std::strchr(ptr, '.');
-    if (dot_ptr == nullptr) {
-      zero_padding = 1 + static_cast<std::size_t>(out.precision()) - size_needed;
-    }
-  }
-
-  std::size_t n_padding = 0;
-  if (static_cast<std::size_t>(out.width()) >=
-      size_needed - 1 + ((signbit or _::has_flag(out, ostr::showpos)) ? 1 : 0)) {
-
-    n_padding = static_cast<std::size_t>(out.width()) - size_needed + 1 -
-                ((signbit or _::has_flag(out, ostr::showpos)) ? 1 : 0) - zero_padding;
-  }
-
-  out.width(0);
-  if (not _::has_flag(out, ostr::left) and not _::has_flag(out, ostr::internal)) {
-    _::print_n(out, out.fill(), n_padding);
-  }
-
-  if (signbit) {
-    out.put(out.widen('-'));
-  } else if (_::has_flag(out, ostr::showpos)) {
-    out.put(out.widen('+'));
-  }
-
-  if (_::has_flag(out, ostr::internal)) {
-    _::print_n(out, out.fill(), n_padding);
-  }
-
-  out << ptr;
-
-  if (zero_padding > 0) {
-    out.put(out.widen('.'));
-    _::print_n(out, '0', zero_padding - 1);
-  }
-
-  if (_::has_flag(out, ostr::left)) {
-    _::print_n(out, out.fill(), n_padding);
-  }
-}
-
 template <precision_t P> inline void dump_repr(mp_float_t<P> const& x) {
   using lld = long long int;
   using llu = long long unsigned;
@@ -879,6 +1154,11 @@ template <typename U, typename V>
   typename _::common_type<U, V>::type out;
   typename _::into_mp_float_lossless<U>::type const& a_{a};
   typename _::into_mp_float_lossless<V>::type const& b_{b};
+#if MPFR_CXX_USE_FLOAT128 == 1
+  if (_::float128::try_binary_op(out, a_, b_, _::float128::op_kind(op))) {
+    return out;
+  }
+#endif
   {
     _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
     _::mpfr_cref_t ac = _::impl_access::mpfr_cref(a_);
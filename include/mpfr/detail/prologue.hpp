@@ -7,6 +7,14 @@
 #define MPFR_CXX_DEBUG 0
 #endif
 
+#ifndef MPFR_CXX_USE_FLOAT128
+#define MPFR_CXX_USE_FLOAT128 0
+#endif
+
+#if MPFR_CXX_USE_FLOAT128 == 1 and not(defined(__SIZEOF_FLOAT128__) and defined(__SIZEOF_INT128__))
+#error "MPFR_CXX_USE_FLOAT128 requires compiler support for __float128 and __int128"
+#endif
+
 #if MPFR_CXX_DEBUG == 1
 #define MPFR_CXX_STRINGIZE2(...) #__VA_ARGS__
 #define MPFR_CXX_STRINGIZE(...) MPFR_CXX_STRINGIZE2(__VA_ARGS__)
@@ -0,0 +1,377 @@
+#ifndef RADIX_HPP_K3V8QZ1M
+#define RADIX_HPP_K3V8QZ1M
+
+#include "mpfr/detail/thread_pool.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace mpfr {
+namespace _ {
+
+/// Number of decimal digits from which conversions use the divide and conquer algorithms below
+/// instead of the ones of MPFR, when the thread pool has more than one thread. The sequential
+/// cost of both is similar, since GMP already converts integers with a subquadratic algorithm.
+constexpr std::size_t radix_dc_threshold = 16384;
+
+/// Number of decimal digits at the leaves of the conversion trees, which GMP converts directly.
+constexpr std::size_t radix_leaf_digits = 1024;
+
+struct mpz_raii_t /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+  mpz_t m;
+  mpz_raii_t() noexcept { mpz_init(m); }
+  mpz_raii_t(mpz_raii_t const&) = delete;
+  ~mpz_raii_t() { mpz_clear(m); }
+};
+
+/// Powers `10^(radix_leaf_digits * 2^i)`, computed on demand and shared by all threads. Levels
+/// are never modified once published.
+struct pow10_tree_t /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+private:
+  static constexpr std::size_t max_levels = 48;
+  std::mutex m_mutex;
+  std::atomic<std::size_t> m_n_levels{0};
+  mpz_t m_levels[max_levels];
+
+  pow10_tree_t() = default;
+
+public:
+  pow10_tree_t(pow10_tree_t const&) = delete;
+  ~pow10_tree_t() {
+    for (std::size_t i = 0; i < m_n_levels.load(std::memory_order_relaxed); ++i) {
+      mpz_clear(m_levels[i]);
+    }
+  }
+
+  static auto global() -> pow10_tree_t& {
+    static pow10_tree_t tree;
+    return tree;
+  }
+
+  /// \return `10^(radix_leaf_digits * 2^i)`, computing the missing levels first.
+  auto get(std::size_t i) -> mpz_srcptr {
+    if (i >= max_levels) {
+      crash_with_message("radix conversion: number too large");
+    }
+    if (i >= m_n_levels.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      for (std::size_t n = m_n_levels.load(std::memory_order_relaxed); n <= i; ++n) {
+        mpz_init(m_levels[n]);
+        if (n == 0) {
+          mpz_ui_pow_ui(m_levels[0], 10, radix_leaf_digits);
+        } else {
+          mpz_mul(m_levels[n], m_levels[n - 1], m_levels[n - 1]);
+        }
+        m_n_levels.store(n + 1, std::memory_order_release);
+      }
+    }
+    return m_levels[i];
+  }
+};
+
+/// When set, conversions use the divide and conquer algorithms regardless of their length and of
+/// the number of threads, so that the tests cover them on any machine.
+inline auto radix_dc_forced() noexcept -> std::atomic<bool>& {
+  static std::atomic<bool> forced{false};
+  return forced;
+}
+
+/// \return Whether a conversion of `n_digits` digits should use the divide and conquer
+/// algorithms.
+inline auto use_radix_dc(std::size_t n_digits) -> bool {
+  return radix_dc_forced().load(std::memory_order_relaxed) or
+         (n_digits >= radix_dc_threshold and thread_pool::global().n_threads() > 1);
+}
+
+/// \return The number of levels of the tree whose leaves cover `n_digits` digits.
+inline auto radix_tree_depth(std::size_t n_digits) noexcept -> std::size_t {
+  std::size_t const n_leaves = (n_digits + radix_leaf_digits - 1) / radix_leaf_digits;
+  std::size_t depth = 0;
+  while ((std::size_t{1} << depth) < n_leaves) {
+    ++depth;
+  }
+  return depth;
+}
+
+/// Writes the decimal digits of `n`, zero padded to exactly `len` characters, to `out`.
+/// `n` must be nonnegative and below `10^len`.\n
+/// `n` is split recursively into a quotient and a remainder by the powers of the tree, and the
+/// pieces of each level are split in parallel.
+inline void integer_to_digits_dc(char* out, std::size_t len, mpz_srcptr n) {
+  constexpr std::size_t leaf = radix_leaf_digits;
+  std::size_t const depth = radix_tree_depth(len);
+  pow10_tree_t& tree = pow10_tree_t::global();
+  if (depth > 0) {
+    tree.get(depth - 1);
+  }
+
+  // the i-th piece of a level holds the digits of weight 10^(i * leaf * 2^level) onwards
+  std::unique_ptr<mpz_raii_t[]> pieces{new mpz_raii_t[1]};
+  mpz_set(pieces[0].m, n);
+  for (std::size_t level = depth; level-- > 0;) {
+    std::size_t const n_pieces = std::size_t{1} << (depth - level);
+    std::unique_ptr<mpz_raii_t[]> next{new mpz_raii_t[n_pieces]};
+    mpz_srcptr const p = tree.get(level);
+    auto split = [&](std::size_t i) {
+      mpz_tdiv_qr(next[2 * i + 1].m, next[2 * i].m, pieces[i].m, p);
+    };
+    thread_pool::global().for_each_index(n_pieces / 2, 0, split);
+    pieces = std::move(next);
+  }
+
+  auto write_leaf = [&](std::size_t i) {
+    std::size_t const lo = i * leaf;
+    if (lo >= len) {
+      return;
+    }
+    std::size_t const width = (len - lo) < leaf ? len - lo : leaf;
+    char* const dst = out + (len - lo - width);
+    char digits[leaf + 2];
+    mpz_get_str(digits, 10, pieces[i].m);
+    std::size_t const n_digits = std::strlen(digits);
+    std::memset(dst, '0', width - n_digits);
+    std::memcpy(dst + (width - n_digits), digits, n_digits);
+  };
+  thread_pool::global().for_each_index(std::size_t{1} << depth, 0, write_leaf);
+}
+
+/// Sets `out` to the integer whose decimal digits are `[digits, digits + len)`.\n
+/// The leaves are combined pairwise with the powers of the tree, in parallel for each level.
+inline void digits_to_integer_dc(mpz_ptr out, char const* digits, std::size_t len) {
+  constexpr std::size_t leaf = radix_leaf_digits;
+  std::size_t n_pieces = (len + leaf - 1) / leaf;
+  if (n_pieces == 0) {
+    mpz_set_ui(out, 0);
+    return;
+  }
+  pow10_tree_t& tree = pow10_tree_t::global();
+  std::size_t const depth = radix_tree_depth(len);
+  if (depth > 0) {
+    tree.get(depth - 1);
+  }
+
+  // the i-th leaf holds the digits of weight 10^(i * leaf) onwards
+  std::unique_ptr<mpz_raii_t[]> pieces{new mpz_raii_t[n_pieces]};
+  auto read_leaf = [&](std::size_t i) {
+    std::size_t const lo = i * leaf;
+    std::size_t const width = (len - lo) < leaf ? len - lo : leaf;
+    char buf[leaf + 1];
+    std::memcpy(buf, digits + (len - lo - width), width);
+    buf[width] = '\0';
+    mpz_set_str(pieces[i].m, buf, 10);
+  };
+  thread_pool::global().for_each_index(n_pieces, 0, read_leaf);
+
+  for (std::size_t level = 0; n_pieces > 1; ++level) {
+    std::size_t const n_next = (n_pieces + 1) / 2;
+    mpz_srcptr const p = tree.get(level);
+    auto combine = [&](std::size_t i) {
+      if (2 * i + 1 < n_pieces) {
+        mpz_mul(pieces[2 * i + 1].m, pieces[2 * i + 1].m, p);
+        mpz_add(pieces[2 * i + 1].m, pieces[2 * i + 1].m, pieces[2 * i].m);
+        mpz_swap(pieces[2 * i].m, pieces[2 * i + 1].m);
+      }
+    };
+    thread_pool::global().for_each_index(n_next, 0, combine);
+    // compact the results to the front
+    for (std::size_t i = 1; i < n_next; ++i) {
+      mpz_swap(pieces[i].m, pieces[2 * i].m);
+    }
+    n_pieces = n_next;
+  }
+  mpz_swap(out, pieces[0].m);
+}
+
+/// Same as `mpfr_get_str(buf, e10, 10, n, x, rnd)` for a positive regular `x`, and `rnd` one of
+/// `MPFR_RNDN`, `MPFR_RNDZ` and `MPFR_RNDU`.\n
+/// For long outputs, `floor(x * 10^q)` is computed exactly with integer
+/// arithmetic for a `q` giving a few more digits than needed, converted to decimal with
+/// `integer_to_digits_dc`, and rounded using the extra digits and the remainder.
+inline void
+get_decimal_str(char* buf, mpfr_exp_t* e10, std::size_t n, mpfr_srcptr x, mpfr_rnd_t rnd) {
+  auto const n_ = static_cast<long>(n);
+  // lower bound of the position of the leading digit, such that 10^e10_lo <= x
+  auto const e10_lo = static_cast<long>(
+      std::floor(static_cast<long double>(mpfr_get_exp(x) - 1) * 0.30102999566398119521L)) - 1;
+  long const q = n_ + 2 - e10_lo;
+  // 5^|q| must stay comparable in size with the result
+  if (q > 4 * n_ or q < -4 * n_ or not use_radix_dc(n)) {
+    mpfr_get_str(buf, e10, 10, n, x, rnd);
+    return;
+  }
+
+  // x * 10^q = z * 2^(s + q) * 5^q
+  mpz_raii_t z;
+  mpz_raii_t v;
+  bool sticky = false;
+  long const t = static_cast<long>(mpfr_get_z_2exp(z.m, x)) + q;
+  if (q >= 0) {
+    mpz_ui_pow_ui(v.m, 5, static_cast<unsigned long>(q));
+    mpz_mul(v.m, v.m, z.m);
+    if (t >= 0) {
+      mpz_mul_2exp(v.m, v.m, static_cast<mp_bitcnt_t>(t));
+    } else {
+      sticky = mpz_scan1(v.m, 0) < static_cast<mp_bitcnt_t>(-t);
+      mpz_tdiv_q_2exp(v.m, v.m, static_cast<mp_bitcnt_t>(-t));
+    }
+  } else {
+    mpz_raii_t den;
+    mpz_raii_t rem;
+    mpz_ui_pow_ui(den.m, 5, static_cast<unsigned long>(-q));
+    if (t >= 0) {
+      mpz_mul_2exp(z.m, z.m, static_cast<mp_bitcnt_t>(t));
+    } else {
+      mpz_mul_2exp(den.m, den.m, static_cast<mp_bitcnt_t>(-t));
+    }
+    mpz_tdiv_qr(v.m, rem.m, z.m, den.m);
+    sticky = mpz_sgn(rem.m) != 0;
+  }
+
+  // v has at least n + 2 digits, the ones past the n-th decide the rounding
+  std::size_t const len_bound = mpz_sizeinbase(v.m, 10);
+  std::vector<char> all(len_bound);
+  integer_to_digits_dc(all.data(), len_bound, v.m);
+  char const* const digits = all.data() + (all[0] == '0' ? 1 : 0);
+  auto const len = static_cast<long>(all.data() + len_bound - digits);
+
+  bool round_up = false;
+  bool tail_nonzero = sticky;
+  for (long i = n_ + 1; i < len and not tail_nonzero; ++i) {
+    tail_nonzero = digits[i] != '0';
+  }
+  if (rnd == MPFR_RNDU or rnd == MPFR_RNDA) {
+    round_up = tail_nonzero or digits[n] != '0';
+  } else if (rnd == MPFR_RNDN) {
+    bool const odd = (digits[n - 1] - '0') % 2 == 1;
+    round_up = digits[n] > '5' or (digits[n] == '5' and (tail_nonzero or odd));
+  }
+
+  std::memcpy(buf, digits, n);
+  buf[n] = '\0';
+  *e10 = static_cast<mpfr_exp_t>(len - q);
+  if (round_up) {
+    long i = n_ - 1;
+    while (i >= 0 and buf[i] == '9') {
+      buf[i] = '0';
+      --i;
+    }
+    if (i >= 0) {
+      ++buf[i];
+    } else {
+      buf[0] = '1';
+      ++*e10;
+    }
+  }
+}
+
+/// Sets `out` to the decimal number `[first, last)`, written as `ddd.ddd` followed by an optional
+/// exponent `e[+-]ddd`, with the sign given by `negative`, rounded with `rnd`. The input must be
+/// well formed.\n
+/// For long inputs, the digits are converted exactly with
+/// `digits_to_integer_dc`, then scaled by the power of ten with a single rounding.
+/// \return The ternary value, as `mpfr_strtofr`.
+inline auto parse_decimal(
+    char const* first,
+    char const* last,
+    bool negative,
+    mpfr_ptr out,
+    mpfr_rnd_t rnd) -> int {
+  auto const len = static_cast<std::size_t>(last - first);
+  if (use_radix_dc(len)) {
+    // digits without the point and the leading zeros
+    std::vector<char> digits;
+    digits.reserve(len);
+    long n_frac = 0;
+    bool after_point = false;
+    char const* it = first;
+    for (; it != last and *it != 'e' and *it != 'E'; ++it) {
+      if (*it == '.') {
+        after_point = true;
+        continue;
+      }
+      n_frac += after_point ? 1 : 0;
+      if (not(digits.empty() and *it == '0')) {
+        digits.push_back(*it);
+      }
+    }
+    long long e = 0;
+    bool exp_small = true;
+    if (it != last) {
+      ++it;
+      bool const exp_negative = *it == '-';
+      if (*it == '+' or *it == '-') {
+        ++it;
+      }
+      for (; it != last; ++it) {
+        exp_small = exp_small and e < (1LL << 40);
+        e = exp_small ? 10 * e + (*it - '0') : e;
+      }
+      e = exp_negative ? -e : e;
+    }
+    e -= n_frac;
+
+    auto const n_digits = static_cast<long long>(digits.size());
+    if (digits.empty()) {
+      mpfr_set_zero(out, negative ? -1 : 1);
+      return 0;
+    }
+    if (exp_small and e <= 4 * n_digits and e >= -4 * n_digits) {
+      mpz_raii_t v;
+      digits_to_integer_dc(v.m, digits.data(), digits.size());
+      if (negative) {
+        mpz_neg(v.m, v.m);
+      }
+
+      // exact up to the final rounding, with the exponent range checked afterwards
+      mpfr_exp_t const emin = mpfr_get_emin();
+      mpfr_exp_t const emax = mpfr_get_emax();
+      mpfr_set_emin(mpfr_get_emin_min());
+      mpfr_set_emax(mpfr_get_emax_max());
+      mpz_raii_t p;
+      mpz_ui_pow_ui(p.m, 10, static_cast<unsigned long>(e < 0 ? -e : e));
+      int ternary = 0;
+      if (e >= 0) {
+        mpz_mul(v.m, v.m, p.m);
+        ternary = mpfr_set_z(out, v.m, rnd);
+      } else {
+        auto exact_prec = [](mpz_srcptr a) {
+          auto const bits = static_cast<mpfr_prec_t>(mpz_sizeinbase(a, 2));
+          return bits < MPFR_PREC_MIN ? MPFR_PREC_MIN : bits;
+        };
+        mpfr_t num;
+        mpfr_t den;
+        mpfr_init2(num, exact_prec(v.m));
+        mpfr_init2(den, exact_prec(p.m));
+        mpfr_set_z(num, v.m, MPFR_RNDN);
+        mpfr_set_z(den, p.m, MPFR_RNDN);
+        ternary = mpfr_div(out, num, den, rnd);
+        mpfr_clear(num);
+        mpfr_clear(den);
+      }
+      mpfr_set_emin(emin);
+      mpfr_set_emax(emax);
+      return mpfr_check_range(out, ternary, rnd);
+    }
+  }
+
+  // mpfr_strtofr needs a null terminated string
+  char stack_buffer[128];
+  heap_str_t heap_buffer{len + 4 > sizeof(stack_buffer) ? len + 4 : 0};
+  char* buf = heap_buffer.p != nullptr ? heap_buffer.p : stack_buffer;
+  std::size_t pos = 0;
+  if (negative) {
+    buf[pos++] = '-';
+  }
+  std::memcpy(buf + pos, first, len);
+  buf[pos + len] = '\0';
+  return mpfr_strtofr(out, buf, nullptr, 10, rnd);
+}
+
+} // namespace _
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard RADIX_HPP_K3V8QZ1M */
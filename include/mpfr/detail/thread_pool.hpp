@@ -0,0 +1,337 @@
+#ifndef THREAD_POOL_HPP_5JX0RMCE
+#define THREAD_POOL_HPP_5JX0RMCE
+
+#include "mpfr/detail/mpfr.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mpfr {
+namespace _ {
+
+/// Thread local state of the caller that the workers must agree with for results to be
+/// identical to a single threaded run.
+struct thread_state_t {
+  mpfr_exp_t emin;
+  mpfr_exp_t emax;
+  int fe_round;
+
+  static auto capture() noexcept -> thread_state_t {
+    return {mpfr_get_emin(), mpfr_get_emax(), std::fegetround()};
+  }
+
+  void apply() const noexcept {
+    _::set_exp_range(emin, emax);
+    std::fesetround(fe_round);
+  }
+};
+
+/// Fork-join pool. The calling thread always takes part in the work, so that a pool with no
+/// workers runs everything sequentially.
+struct thread_pool /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+private:
+  struct job_t {
+    void (*fn)(void* ctx, std::size_t i);
+    void* ctx;
+    std::size_t n_tasks;
+    std::size_t max_workers;
+    thread_state_t state;
+    std::atomic<std::size_t> next;
+    std::atomic<mpfr_flags_t> flags;
+    // first exception thrown by a task, set by the thread that sets `failed`
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+  };
+
+  std::mutex m_mutex;
+  std::mutex m_run_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  std::vector<std::thread> m_workers;
+  job_t* m_job = nullptr;
+  std::size_t m_generation = 0;
+  std::size_t m_joined = 0;
+  std::size_t m_active = 0;
+  bool m_stop = false;
+
+  static auto is_worker() noexcept -> bool& {
+    thread_local bool worker = false;
+    return worker;
+  }
+
+  /// Runs the tasks of `job` that are left. If a task throws, the exception is kept in the job
+  /// for the caller, and the tasks that are left are skipped.
+  static void work_on(job_t& job) noexcept {
+#if defined(__cpp_exceptions)
+    try {
+#endif
+      for (;;) {
+        std::size_t i = job.next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= job.n_tasks) {
+          break;
+        }
+        job.fn(job.ctx, i);
+      }
+#if defined(__cpp_exceptions)
+    } catch (...) {
+      if (not job.failed.exchange(true, std::memory_order_relaxed)) {
+        job.error = std::current_exception();
+      }
+      job.next.store(job.n_tasks, std::memory_order_relaxed);
+    }
+#endif
+  }
+
+  /// Detaches the job of the calling thread from the pool once the caller is done with it, and
+  /// waits for the workers that took part in it, so that it can be destroyed.
+  struct join_guard_t /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+    thread_pool& pool;
+    ~join_guard_t() {
+      is_worker() = false;
+      std::unique_lock<std::mutex> lock{pool.m_mutex};
+      pool.m_job = nullptr;
+      pool.m_done.wait(lock, [&] { return pool.m_active == 0; });
+    }
+  };
+
+  void worker_loop() {
+    is_worker() = true;
+    _::set_exp_range(mpfr_get_emin(), mpfr_get_emax());
+    _::exp_range_cache().enabled = true;
+    _::free_cache_at_thread_exit();
+    std::size_t seen = 0;
+    std::unique_lock<std::mutex> lock{m_mutex};
+    for (;;) {
+      m_wake.wait(lock, [&] { return m_stop or (m_job != nullptr and m_generation != seen); });
+      if (m_stop) {
+        return;
+      }
+      seen = m_generation;
+      if (m_joined >= m_job->max_workers) {
+        continue;
+      }
+      ++m_joined;
+      ++m_active;
+      job_t& job = *m_job;
+      lock.unlock();
+
+      job.state.apply();
+      mpfr_clear_flags();
+      work_on(job);
+      job.flags.fetch_or(mpfr_flags_save(), std::memory_order_relaxed);
+
+      lock.lock();
+      if (--m_active == 0) {
+        m_done.notify_all();
+      }
+    }
+  }
+
+public:
+  explicit thread_pool(std::size_t n_workers) {
+    m_workers.reserve(n_workers);
+    for (std::size_t i = 0; i < n_workers; ++i) {
+      m_workers.emplace_back([this] { worker_loop(); });
+    }
+  }
+
+  ~thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_workers) {
+      t.join();
+    }
+  }
+
+  /// Pool shared by the parallel algorithms, with one worker per hardware thread besides the
+  /// caller.
+  static auto global() -> thread_pool& {
+    static thread_pool pool{
+        std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0};
+    return pool;
+  }
+
+  /// \return Maximum number of threads that can work on a job, including the caller.
+  [[MPFR_CXX_NODISCARD]] auto n_threads() const noexcept -> std::size_t {
+    return m_workers.size() + 1;
+  }
+
+  /// Calls `fn(ctx, i)` for every `i` in `[0, n_tasks)`, using at most `n_threads` threads
+  /// (all of them if zero). Workers run with the exponent range and rounding mode of the
+  /// caller, and the MPFR flags they raise are raised in the caller once the job is done.\n
+  /// If a call throws, the calls that did not start yet are skipped, and the first exception is
+  /// rethrown on the caller once the workers are done with the job.
+  ///
+  /// Nested calls, and calls made while the pool is busy, run sequentially on the caller.
+  void run(std::size_t n_tasks, std::size_t n_threads, void (*fn)(void*, std::size_t), void* ctx) {
+    if (n_tasks == 0) {
+      return;
+    }
+    std::size_t max_workers = (n_threads == 0 or n_threads > this->n_threads())
+                                  ? m_workers.size()
+                                  : n_threads - 1;
+    max_workers = max_workers < n_tasks - 1 ? max_workers : n_tasks - 1;
+
+    std::unique_lock<std::mutex> run_lock{m_run_mutex, std::defer_lock};
+    if (max_workers == 0 or is_worker() or not run_lock.try_lock()) {
+      for (std::size_t i = 0; i < n_tasks; ++i) {
+        fn(ctx, i);
+      }
+      return;
+    }
+
+    job_t job{fn, ctx, n_tasks, max_workers, thread_state_t::capture(), {0}, {0}, {false}, {}};
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_job = &job;
+      m_joined = 0;
+      ++m_generation;
+    }
+    m_wake.notify_all();
+
+    {
+      join_guard_t guard{*this};
+      // nested calls from the tasks of the caller run sequentially, as they do on the workers
+      is_worker() = true;
+      work_on(job);
+    }
+    mpfr_flags_set(job.flags.load(std::memory_order_relaxed));
+#if defined(__cpp_exceptions)
+    if (job.error) {
+      std::rethrow_exception(job.error);
+    }
+#endif
+  }
+
+  /// Calls `fn(i)` for every `i` in `[0, n_tasks)`. See `run`.
+  template <typename Fn> void for_each_index(std::size_t n_tasks, std::size_t n_threads, Fn& fn) {
+    run(
+        n_tasks,
+        n_threads,
+        [](void* ctx, std::size_t i) { (*static_cast<Fn*>(ctx))(i); },
+        static_cast<void*>(&fn));
+  }
+};
+
+/// Time that `steal_work` aims to spend on each chunk of indices. It is long enough for taking
+/// the chunk and reading the clock to be negligible, and short enough to balance the load.
+constexpr std::chrono::nanoseconds steal_target_chunk_duration{50000};
+
+/// Indices that a thread of `steal_work` takes from the front, and that the other threads steal
+/// from the back.
+struct steal_range_t {
+  std::mutex mutex;
+  std::size_t begin = 0;
+  std::size_t end = 0;
+};
+
+/// \return The number of indices to take next, so that a chunk lasts about
+/// `steal_target_chunk_duration`, given that the last `len` ones took `elapsed`.
+inline auto next_grain(std::size_t len, std::chrono::nanoseconds elapsed) -> std::size_t {
+  auto const ns = static_cast<std::uint64_t>(elapsed.count() > 0 ? elapsed.count() : 1);
+  auto const target = static_cast<std::uint64_t>(steal_target_chunk_duration.count());
+  // the growth is limited, so that a chunk that was unusually fast is not followed by a huge one
+  std::uint64_t const estimate = std::uint64_t{len} * target / ns;
+  std::uint64_t const grain = estimate < 2 * std::uint64_t{len} ? estimate : 2 * std::uint64_t{len};
+  return grain == 0 ? 1 : static_cast<std::size_t>(grain);
+}
+
+/// Calls `fn(begin, end)` on disjoint ranges that cover `[0, n)`, using at most `n_threads`
+/// threads of the global pool (all of them if zero).\n
+/// Each thread starts with an equal share of the indices, and takes chunks from it whose size
+/// adapts to the measured cost of the previous ones, starting from a single index. A thread that
+/// is done steals the back half of the largest remaining share.
+template <typename Fn> void steal_work(std::size_t n, std::size_t n_threads, Fn& fn) {
+  if (n == 0) {
+    return;
+  }
+  thread_pool& pool = thread_pool::global();
+  std::size_t k = (n_threads == 0 or n_threads > pool.n_threads()) ? pool.n_threads() : n_threads;
+  k = k < n ? k : n;
+  if (k == 1) {
+    fn(std::size_t{0}, n);
+    return;
+  }
+
+  std::vector<steal_range_t> ranges(k);
+  for (std::size_t i = 0; i < k; ++i) {
+    ranges[i].begin = n / k * i + (i < n % k ? i : n % k);
+    ranges[i].end = ranges[i].begin + n / k + (i < n % k ? 1 : 0);
+  }
+
+  auto steal = [&](std::size_t thief) -> bool {
+    for (;;) {
+      std::size_t victim = k;
+      std::size_t largest = 0;
+      for (std::size_t j = 0; j < k; ++j) {
+        std::lock_guard<std::mutex> lock{ranges[j].mutex};
+        if (ranges[j].end - ranges[j].begin > largest) {
+          largest = ranges[j].end - ranges[j].begin;
+          victim = j;
+        }
+      }
+      if (victim == k) {
+        return false;
+      }
+      std::size_t begin = 0;
+      std::size_t end = 0;
+      {
+        std::lock_guard<std::mutex> lock{ranges[victim].mutex};
+        std::size_t const remaining = ranges[victim].end - ranges[victim].begin;
+        end = ranges[victim].end;
+        begin = end - (remaining + 1) / 2;
+        ranges[victim].end = begin;
+      }
+      if (begin != end) {
+        std::lock_guard<std::mutex> lock{ranges[thief].mutex};
+        ranges[thief].begin = begin;
+        ranges[thief].end = end;
+        return true;
+      }
+    }
+  };
+
+  auto participant = [&](std::size_t i) {
+    std::size_t grain = 1;
+    for (;;) {
+      std::size_t begin = 0;
+      std::size_t end = 0;
+      {
+        std::lock_guard<std::mutex> lock{ranges[i].mutex};
+        begin = ranges[i].begin;
+        std::size_t const remaining = ranges[i].end - begin;
+        end = begin + (remaining < grain ? remaining : grain);
+        ranges[i].begin = end;
+      }
+      if (begin == end) {
+        if (not steal(i)) {
+          return;
+        }
+        continue;
+      }
+      auto const start = std::chrono::steady_clock::now();
+      fn(begin, end);
+      grain = _::next_grain(
+          end - begin,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start));
+    }
+  };
+  pool.for_each_index(k, k, participant);
+}
+
+} // namespace _
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard THREAD_POOL_HPP_5JX0RMCE */
@@ -0,0 +1,385 @@
+#ifndef TWO_LIMB_HPP_QW7N3KZD
+#define TWO_LIMB_HPP_QW7N3KZD
+
+#include "mpfr/detail/mpfr.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <cstdint>
+#include <utility>
+
+// Correctly rounded add, mul and fma for numbers whose mantissa spans two limbs, i.e. precisions
+// from 65 to 128 bits. The exact result, or a truncation of it with a sticky bit, is computed in
+// a fixed size integer of N limbs, then rounded once, so the results match mpfr, including the
+// inexact flag. Operations that involve special values, or whose result is outside the exponent
+// range, are reported as unsupported and left to mpfr.
+
+#if defined(__SIZEOF_INT128__)
+#define MPFR_CXX_HAS_TWO_LIMB_KERNELS 1
+#else
+#define MPFR_CXX_HAS_TWO_LIMB_KERNELS 0
+#endif
+
+#if MPFR_CXX_HAS_TWO_LIMB_KERNELS == 1
+
+namespace mpfr {
+namespace _ {
+namespace two_limb {
+
+using u64 = std::uint64_t;
+__extension__ typedef unsigned __int128 u128;
+
+template <precision_t P> constexpr auto is_supported() -> bool {
+  return GMP_NUMB_BITS == 64 and prec_to_nlimb(static_cast<std::uint64_t>(P)) == 2;
+}
+
+/// Little endian fixed size unsigned integer.
+template <std::size_t N> struct wide_t {
+  u64 limbs[N];
+};
+
+template <std::size_t N> auto is_zero(wide_t<N> const& x) -> bool {
+  u64 acc = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    acc |= x.limbs[i];
+  }
+  return acc == 0;
+}
+
+template <std::size_t N> auto count_leading_zeros(wide_t<N> const& x) -> int {
+  for (std::size_t i = N; i > 0; --i) {
+    if (x.limbs[i - 1] != 0) {
+      return static_cast<int>((N - i) * 64) + __builtin_clzll(x.limbs[i - 1]);
+    }
+  }
+  return static_cast<int>(N * 64);
+}
+
+template <std::size_t N> auto less(wide_t<N> const& x, wide_t<N> const& y) -> bool {
+  for (std::size_t i = N; i > 0; --i) {
+    if (x.limbs[i - 1] != y.limbs[i - 1]) {
+      return x.limbs[i - 1] < y.limbs[i - 1];
+    }
+  }
+  return false;
+}
+
+/// x += y, the carry out is dropped.
+template <std::size_t N> void add_to(wide_t<N>& x, wide_t<N> const& y) {
+  u64 carry = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    u128 const s = static_cast<u128>(x.limbs[i]) + y.limbs[i] + carry;
+    x.limbs[i] = static_cast<u64>(s);
+    carry = static_cast<u64>(s >> 64U);
+  }
+}
+
+/// x -= y + borrow, where x >= y + borrow.
+template <std::size_t N> void sub_from(wide_t<N>& x, wide_t<N> const& y, bool borrow) {
+  u64 b = borrow ? 1 : 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    u64 const xi = x.limbs[i];
+    u64 const d = xi - y.limbs[i] - b;
+    b = (xi < y.limbs[i] or (xi == y.limbs[i] and b != 0)) ? 1 : 0;
+    x.limbs[i] = d;
+  }
+}
+
+template <std::size_t N> void shift_left(wide_t<N>& x, unsigned shift) {
+  std::size_t const limb_shift = shift / 64;
+  unsigned const bit_shift = shift % 64;
+  for (std::size_t i = N; i > 0; --i) {
+    std::size_t const dst = i - 1;
+    u64 v = 0;
+    if (dst >= limb_shift) {
+      std::size_t const src = dst - limb_shift;
+      v = x.limbs[src] << bit_shift;
+      if (bit_shift != 0 and src > 0) {
+        v |= x.limbs[src - 1] >> (64U - bit_shift);
+      }
+    }
+    x.limbs[dst] = v;
+  }
+}
+
+/// Shifts x right, and returns whether nonzero bits were shifted out.
+template <std::size_t N> auto shift_right_sticky(wide_t<N>& x, mpfr_exp_t shift) -> bool {
+  if (shift <= 0) {
+    return false;
+  }
+  if (shift >= static_cast<mpfr_exp_t>(N * 64)) {
+    bool const sticky = not is_zero(x);
+    x = {};
+    return sticky;
+  }
+  auto const limb_shift = static_cast<std::size_t>(shift / 64);
+  auto const bit_shift = static_cast<unsigned>(shift % 64);
+
+  u64 lost = 0;
+  for (std::size_t i = 0; i < limb_shift; ++i) {
+    lost |= x.limbs[i];
+  }
+  if (bit_shift != 0) {
+    lost |= x.limbs[limb_shift] << (64U - bit_shift);
+  }
+  for (std::size_t dst = 0; dst < N; ++dst) {
+    std::size_t const src = dst + limb_shift;
+    u64 v = 0;
+    if (src < N) {
+      v = x.limbs[src] >> bit_shift;
+      if (bit_shift != 0 and src + 1 < N) {
+        v |= x.limbs[src + 1] << (64U - bit_shift);
+      }
+    }
+    x.limbs[dst] = v;
+  }
+  return lost != 0;
+}
+
+/// Operand unpacked from a regular `mp_float_t`, value = 0.m * 2^exp.
+struct operand_t {
+  u64 hi;
+  u64 lo;
+  mpfr_exp_t exp;
+  bool signbit;
+};
+
+template <precision_t P> auto unpack(mp_float_t<P> const& x, operand_t& out) -> bool {
+  mpfr_prec_t const prec_sign = impl_access::actual_prec_sign_const(x);
+  if (prec_abs(prec_sign) == 0) {
+    return false;
+  }
+  out.hi = impl_access::mantissa_const(x)[1];
+  out.lo = impl_access::mantissa_const(x)[0];
+  out.exp = impl_access::exp_const(x);
+  out.signbit = prec_sign < 0;
+  return true;
+}
+
+/// Places the mantissa at the top of an N limb integer, shifted right by one bit so that the
+/// top bit is free for a carry.
+template <std::size_t N> auto widen(operand_t const& x) -> wide_t<N> {
+  wide_t<N> w{};
+  w.limbs[N - 1] = x.hi >> 1U;
+  w.limbs[N - 2] = (x.hi << 63U) | (x.lo >> 1U);
+  w.limbs[N - 3] = x.lo << 63U;
+  return w;
+}
+
+/// Exact 256 bit product of the mantissas, normalized so that its top bit is set.
+inline auto mul_mantissas(operand_t const& a, operand_t const& b, mpfr_exp_t& exp) -> wide_t<4> {
+  u128 const ll = static_cast<u128>(a.lo) * b.lo;
+  u128 const lh = static_cast<u128>(a.lo) * b.hi;
+  u128 const hl = static_cast<u128>(a.hi) * b.lo;
+  u128 const hh = static_cast<u128>(a.hi) * b.hi;
+
+  wide_t<4> p{};
+  p.limbs[0] = static_cast<u64>(ll);
+  u128 mid = (ll >> 64U) + static_cast<u64>(lh) + static_cast<u64>(hl);
+  p.limbs[1] = static_cast<u64>(mid);
+  mid = (mid >> 64U) + (lh >> 64U) + (hl >> 64U) + static_cast<u64>(hh);
+  p.limbs[2] = static_cast<u64>(mid);
+  p.limbs[3] = static_cast<u64>((mid >> 64U) + (hh >> 64U));
+
+  // the product of two mantissas in [1/2, 1) is in [1/4, 1)
+  exp = a.exp + b.exp;
+  if ((p.limbs[3] >> 63U) == 0) {
+    shift_left(p, 1);
+    --exp;
+  }
+  return p;
+}
+
+/// Rounds x * 2^(exp - 64 * N), where the top bit of x is set, to the precision of out.
+/// The sticky bit is set if the exact value is larger than x.
+/// \return false if the result is outside the exponent range [emin, emax], in which case out is
+/// left untouched.
+template <precision_t P, std::size_t N>
+auto round_into(
+    mp_float_t<P>& out,
+    wide_t<N> const& x,
+    bool sticky,
+    mpfr_exp_t exp,
+    bool signbit,
+    mpfr_rnd_t rnd,
+    mpfr_exp_t emin,
+    mpfr_exp_t emax) -> bool {
+  constexpr auto prec = static_cast<unsigned>(P);
+  constexpr unsigned drop = 128U - prec;
+
+  u128 const top = (static_cast<u128>(x.limbs[N - 1]) << 64U) | x.limbs[N - 2];
+  u64 rest = sticky ? 1 : 0;
+  for (std::size_t i = 0; i + 3 < N; ++i) {
+    rest |= x.limbs[i];
+  }
+  bool round_bit = false;
+  if (drop == 0) {
+    round_bit = (x.limbs[N - 3] >> 63U) != 0;
+    rest |= x.limbs[N - 3] << 1U;
+  } else {
+    constexpr unsigned round_pos = (drop == 0) ? 0 : drop - 1;
+    round_bit = ((top >> round_pos) & 1U) != 0;
+    rest |= static_cast<u64>((top & ((u128{1} << round_pos) - 1U)) != 0);
+    rest |= x.limbs[N - 3];
+  }
+  bool const inexact = round_bit or rest != 0;
+
+  constexpr u128 ulp = u128{1} << drop;
+  u128 q = top & ~(ulp - 1U);
+  bool round_up = false;
+  switch (rnd) {
+  case MPFR_RNDN:
+    round_up = round_bit and (rest != 0 or (q & ulp) != 0);
+    break;
+  case MPFR_RNDU:
+    round_up = inexact and not signbit;
+    break;
+  case MPFR_RNDD:
+    round_up = inexact and signbit;
+    break;
+  default:
+    break;
+  }
+  if (round_up) {
+    q += ulp;
+    if (q == 0) {
+      q = u128{1} << 127U;
+      ++exp;
+    }
+  }
+  if (exp < emin or exp > emax) {
+    return false;
+  }
+
+  auto const hi = static_cast<u64>(q >> 64U);
+  auto const lo = static_cast<u64>(q);
+  int const trailing_zeros = (lo != 0) ? __builtin_ctzll(lo) : 64 + __builtin_ctzll(hi);
+  impl_access::mantissa_mut(out)[1] = hi;
+  impl_access::mantissa_mut(out)[0] = lo;
+  impl_access::exp_mut(out) = exp;
+  impl_access::actual_prec_sign_mut(out) = prec_negate_if(128 - trailing_zeros, signbit);
+  if (inexact) {
+    mpfr_set_inexflag();
+  }
+  return true;
+}
+
+template <precision_t P> void set_zero(mp_float_t<P>& out, bool signbit) {
+  impl_access::mantissa_mut(out)[1] = 0;
+  impl_access::mantissa_mut(out)[0] = 0;
+  impl_access::exp_mut(out) = 0;
+  impl_access::actual_prec_sign_mut(out) = prec_negate_if(0, signbit);
+}
+
+/// Adds x * 2^ex and y * 2^ey, with the signs sx and sy, where the top bit of both is free.
+/// The smaller operand is shifted with a sticky bit. Its shifted out bits can only be nonzero
+/// when the exponents differ by more than one, so the result loses at most one leading bit and
+/// the sticky bit stays far below the rounding position.
+template <precision_t P, std::size_t N>
+auto add_wide(
+    mp_float_t<P>& out,
+    wide_t<N> x,
+    mpfr_exp_t ex,
+    bool sx,
+    wide_t<N> y,
+    mpfr_exp_t ey,
+    bool sy,
+    mpfr_rnd_t rnd,
+    mpfr_exp_t emin,
+    mpfr_exp_t emax) -> bool {
+  if (ex < ey or (ex == ey and less(x, y))) {
+    std::swap(x, y);
+    std::swap(ex, ey);
+    std::swap(sx, sy);
+  }
+  bool const sticky = shift_right_sticky(y, ex - ey);
+  if (sx == sy) {
+    add_to(x, y);
+  } else {
+    // rounded down when bits of y were lost
+    sub_from(x, y, sticky);
+  }
+  if (is_zero(x)) {
+    set_zero(out, rnd == MPFR_RNDD);
+    return true;
+  }
+  int const shift = count_leading_zeros(x);
+  shift_left(x, static_cast<unsigned>(shift));
+  return round_into(out, x, sticky, ex + 1 - shift, sx, rnd, emin, emax);
+}
+
+/// \return whether out = a + b was computed, otherwise it must be computed by mpfr.
+template <precision_t P>
+auto add(
+    mp_float_t<P>& out,
+    mp_float_t<P> const& a,
+    mp_float_t<P> const& b,
+    mpfr_rnd_t rnd,
+    mpfr_exp_t emin,
+    mpfr_exp_t emax) -> bool {
+  operand_t x;
+  operand_t y;
+  if (not unpack(a, x) or not unpack(b, y)) {
+    return false;
+  }
+  return add_wide(
+      out, widen<4>(x), x.exp, x.signbit, widen<4>(y), y.exp, y.signbit, rnd, emin, emax);
+}
+
+/// \return whether out = a * b was computed, otherwise it must be computed by mpfr.
+template <precision_t P>
+auto mul(
+    mp_float_t<P>& out,
+    mp_float_t<P> const& a,
+    mp_float_t<P> const& b,
+    mpfr_rnd_t rnd,
+    mpfr_exp_t emin,
+    mpfr_exp_t emax) -> bool {
+  operand_t x;
+  operand_t y;
+  if (not unpack(a, x) or not unpack(b, y)) {
+    return false;
+  }
+  mpfr_exp_t exp{};
+  wide_t<4> const p = mul_mantissas(x, y, exp);
+  return round_into(out, p, false, exp, x.signbit != y.signbit, rnd, emin, emax);
+}
+
+/// \return whether out = a * b + c was computed with a single rounding, otherwise it must be
+/// computed by mpfr.
+template <precision_t P>
+auto fma(
+    mp_float_t<P>& out,
+    mp_float_t<P> const& a,
+    mp_float_t<P> const& b,
+    mp_float_t<P> const& c,
+    mpfr_rnd_t rnd,
+    mpfr_exp_t emin,
+    mpfr_exp_t emax) -> bool {
+  operand_t x;
+  operand_t y;
+  operand_t z;
+  if (not unpack(a, x) or not unpack(b, y) or not unpack(c, z)) {
+    return false;
+  }
+  mpfr_exp_t exp{};
+  wide_t<4> const p = mul_mantissas(x, y, exp);
+
+  // 384 bits hold the exact product, and the addend when it is not shifted too far
+  wide_t<6> wp{};
+  for (std::size_t i = 0; i < 4; ++i) {
+    wp.limbs[i + 2] = p.limbs[i];
+  }
+  shift_right_sticky(wp, 1);
+  return add_wide(
+      out, wp, exp, x.signbit != y.signbit, widen<6>(z), z.exp, z.signbit, rnd, emin, emax);
+}
+
+} // namespace two_limb
+} // namespace _
+} // namespace mpfr
+
+#endif
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard TWO_LIMB_HPP_QW7N3KZD */
@@ -2,8 +2,12 @@
 #define FMT_HPP_8STTEZY1
 
 #include "mpfr/detail/handle_as_mpfr.hpp"
+#include "mpfr/detail/charconv.hpp"
 #include "mpfr/detail/prologue.hpp"
 
+#include <iterator>
+#include <type_traits>
+
 #if defined(__has_include)
 #if __has_include(<fmt/core.h>)
 #include <fmt/core.h>
@@ -39,7 +43,6 @@ struct fill_t {
 
 enum struct align_e : unsigned char { left, right, center };
 enum struct sign_e : unsigned char { plus, minus, space };
-enum struct float_format_e : unsigned char { general, exp, fixed, hex, binary };
 
 struct error_handler_ref_t {
 private:
@@ -124,7 +127,8 @@ struct mp_float_specs {
   bool dyn_prec = false;
   int prec_or_id = -1;
 
-  float_format_e format = float_format_e::general;
+  /// `shortest` when the type is omitted or `r`.
+  float_format_e format = float_format_e::shortest;
   bool upper = false;
 };
 
@@ -264,6 +268,9 @@ parse_width_to_end(mp_float_specs& specs, typename Parse_Context::iterator it, P
     case 'b':
       specs.format = float_format_e::binary;
       break;
+    case 'r':
+      specs.format = float_format_e::shortest;
+      break;
     default:
       eh.on_error("invalid type specifier for mp_float_t");
       break;
@@ -480,93 +487,103 @@ void parse_dynamic_args(
   }
 }
 
-inline char* format_to_buf(
-    char* stack_buffer,
-    size_t stack_bufsize,
-    heap_str_t& heap_buffer,
-    long& precision,
-    long& width,
-    bool& signbit,
-    size_t& zero_padding,
-    size_t& n_padding,
-    size_t& left_padding,
-    size_t& right_padding,
-    mp_float_specs const& fspecs,
-    mpfr_cref_t x) {
-  char format[128] = {};
-  std::size_t pos = 0;
-  format[pos++] = '%';
-  format[pos++] = '.';
-
-  bool hex = fspecs.format == float_format_e::hex;
-  bool bin = fspecs.format == float_format_e::binary;
-  precision = hex   ? mpfr_get_prec(&x.m) / 4
-              : bin ? mpfr_get_prec(&x.m)
-                    : static_cast<long>(fspecs.prec_or_id);
-  width = static_cast<long>(fspecs.width_or_id);
-  signbit = mpfr_signbit(&x.m);
-
-  if (precision < 0) {
-    precision = 6;
-  }
-  std::snprintf(format + pos, sizeof(format) - pos, "%ld", precision);
-  pos = std::strlen(format);
-  format[pos++] = 'R';
-
-  bool u = fspecs.upper;
-  if (fspecs.format == float_format_e::hex) {
-    format[pos++] = u ? 'A' : 'a';
-  } else if (fspecs.format == float_format_e::binary) {
-    format[pos++] = 'b';
-  } else if (fspecs.format == float_format_e::exp) {
-    format[pos++] = u ? 'E' : 'e';
-  } else if (fspecs.format == float_format_e::fixed) {
-    format[pos++] = u ? 'F' : 'f';
-  } else {
-    format[pos++] = u ? 'G' : 'g';
+/// Reserves `n` characters at the end of the contiguous container `c`, with the interface of
+/// `fmt::detail::buffer`. Unless `exact` is set, the characters are taken from the spare capacity
+/// and are not part of the container until they are committed, since some buffers of fmt grow
+/// the underlying container to their whole capacity.
+template <typename C>
+auto reserve_in(C& c, std::size_t n, bool exact, int)
+    -> decltype(c.try_resize(0), static_cast<char*>(nullptr)) {
+  std::size_t size = c.size();
+  if (c.capacity() - size < n) {
+    if (not exact) {
+      return nullptr;
+    }
+    c.try_reserve(size + n);
+    // the buffer may have been flushed
+    size = c.size();
+    if (c.capacity() - size < n) {
+      return nullptr;
+    }
   }
-  format[pos++] = '\0';
-
-  MPFR_SIGN(&x.m) = 1;
-  auto const size_needed = static_cast<std::size_t>(mpfr_snprintf(nullptr, 0, format, &x.m)) + 1;
+  if (exact) {
+    c.try_resize(size + n);
+  }
+  return c.data() + size;
+}
+/// Same as above, for standard contiguous containers such as `std::string`.
+template <typename C>
+auto reserve_in(C& c, std::size_t n, bool exact, long)
+    -> decltype(c.resize(0), static_cast<char*>(c.data())) {
+  if (not exact) {
+    return nullptr;
+  }
+  std::size_t const size = c.size();
+  c.resize(size + n);
+  return c.data() + size;
+}
+template <typename C>
+auto reserve_in(C& /*c*/, std::size_t /*n*/, bool /*exact*/, ...) -> char* {
+  return nullptr;
+}
 
-  bool use_heap = size_needed > stack_bufsize;
-  heap_buffer.init(use_heap ? size_needed : 0);
+template <typename C>
+auto commit_in(C& c, char* end, int) -> decltype(c.try_resize(0)) {
+  c.try_resize(static_cast<std::size_t>(end - c.data()));
+}
+template <typename C>
+auto commit_in(C& c, char* end, long)
+    -> decltype(c.resize(0), static_cast<char*>(c.data()), void()) {
+  c.resize(static_cast<std::size_t>(end - c.data()));
+}
+template <typename C> void commit_in(C& /*c*/, char* /*end*/, ...) {}
+
+/// Direct access to the characters behind an output iterator. `reserve(it, n, exact)` returns
+/// room for `n` characters, or `nullptr` if the iterator does not write to contiguous storage or
+/// if `exact` is not set and the room is not available without growing the storage.
+/// `commit(it, end)` keeps the characters up to `end`, which must be all of them if `exact` was
+/// set, and moves the iterator past them.
+template <typename Out_Iter, typename Enable = void> struct contiguous_out_t {
+  static auto reserve(Out_Iter& /*it*/, std::size_t /*n*/, bool /*exact*/) -> char* {
+    return nullptr;
+  }
+  static void commit(Out_Iter& /*it*/, char* /*end*/) {}
+};
 
-  char* ptr = use_heap ? heap_buffer.p : stack_buffer;
+template <> struct contiguous_out_t<char*, void> {
+  static auto reserve(char*& it, std::size_t /*n*/, bool /*exact*/) -> char* { return it; }
+  static void commit(char*& it, char* end) { it = end; }
+};
 
-  mpfr_snprintf(ptr, size_needed, format, &x.m);
-  if (not hex and fspecs.alt and precision > 0) {
-    char* dot_ptr = std::strchr(ptr, '.');
-    if (dot_ptr == nullptr) {
-      zero_padding = 1 + static_cast<std::size_t>(precision) - size_needed;
+/// Back inserters into character containers, which include the buffer appenders of fmt.
+template <typename Out_Iter>
+struct contiguous_out_t<
+    Out_Iter,
+    typename enable_if<
+        std::is_base_of<std::back_insert_iterator<typename Out_Iter::container_type>, Out_Iter>::
+                value and
+            std::is_same<typename Out_Iter::container_type::value_type, char>::value,
+        void>::type> {
+  using container_t = typename Out_Iter::container_type;
+
+  struct access : std::back_insert_iterator<container_t> {
+    static auto get(std::back_insert_iterator<container_t>& it) -> container_t& {
+      return *(it.*&access::container);
     }
-  }
-
-  if (static_cast<std::size_t>(width) >=
-      size_needed - 1 + ((signbit or fspecs.sign == sign_e::plus) ? 1 : 0)) {
+  };
 
-    n_padding = static_cast<std::size_t>(width) - size_needed + 1 -
-                ((signbit or fspecs.sign == sign_e::plus) ? 1 : 0) - zero_padding;
+  static auto reserve(Out_Iter& it, std::size_t n, bool exact) -> char* {
+    return libfmt::reserve_in(access::get(it), n, exact, 0);
   }
-
-  left_padding = (fspecs.align == align_e::right) //
-                     ? n_padding
-                     : (fspecs.align == align_e::center) //
-                           ? (n_padding / 2)
-                           : 0;
-  right_padding = (fspecs.align == align_e::left) //
-                      ? n_padding
-                      : (fspecs.align == align_e::center) //
-                            ? (n_padding - left_padding)
-                            : 0;
-  return ptr;
-}
+  static void commit(Out_Iter& it, char* end) { libfmt::commit_in(access::get(it), end, 0); }
+};
 
 struct out_iter_ref_t {
 private:
   void* m_out;
   void (*m_copy_to)(void* out, char const* begin, char const* end);
+  auto (*m_reserve)(void* out, std::size_t n, bool exact) -> char*;
+  void (*m_commit)(void* out, char* end);
 
   template <typename Out_Iter>
   static void copy_into_out_impl(void* out, char const* begin, char const* end) {
@@ -577,46 +594,110 @@ private:
       ++begin;
     }
   }
+  template <typename Out_Iter>
+  static auto reserve_impl(void* out, std::size_t n, bool exact) -> char* {
+    return contiguous_out_t<Out_Iter>::reserve(*static_cast<Out_Iter*>(out), n, exact);
+  }
+  template <typename Out_Iter> static void commit_impl(void* out, char* end) {
+    contiguous_out_t<Out_Iter>::commit(*static_cast<Out_Iter*>(out), end);
+  }
 
 public:
   template <typename Out_Iter>
   out_iter_ref_t(Out_Iter* out) // NOLINT(hicpp-explicit-conversions)
-      : m_out{out}, m_copy_to{&copy_into_out_impl<Out_Iter>} {}
+      : m_out{out},
+        m_copy_to{&copy_into_out_impl<Out_Iter>},
+        m_reserve{&reserve_impl<Out_Iter>},
+        m_commit{&commit_impl<Out_Iter>} {}
 
   void copy_into_out(char const* begin, char const* end) const { m_copy_to(m_out, begin, end); }
+
+  /// \return Room for `n` characters in the output, or `nullptr`. See `contiguous_out_t`.
+  /// `commit` must be called with the end of the written characters before any other output.
+  auto reserve(std::size_t n, bool exact) const -> char* { return m_reserve(m_out, n, exact); }
+  void commit(char* end) const { m_commit(m_out, end); }
 };
 
+/// Formats `value` following `specs`. Without a type or with the type `r`, and without a
+/// precision, the output is the shortest one that reads back to the same number in precision
+/// `round_trip_prec`.
 inline void format_impl(
     mpfr_cref_t value,
     out_iter_ref_t out,
     char* stack_buffer,
     std::size_t stack_bufsize,
-    mp_float_specs const& specs) {
+    mp_float_specs const& specs,
+    mpfr_prec_t round_trip_prec) {
 
   using std::size_t;
 
-  long precision = 0;
-  long width = 0;
-  size_t zero_padding = 0;
-  size_t n_padding = 0;
-  bool signbit = false;
-  size_t left_padding = 0;
-  size_t right_padding = 0;
-
-  mpfr::_::heap_str_t heap_buffer{0};
-  char const* const ptr = format_to_buf(
-      stack_buffer,
-      stack_bufsize,
-      heap_buffer,
-      precision,
-      width,
-      signbit,
-      zero_padding,
-      n_padding,
-      left_padding,
-      right_padding,
-      specs,
-      value);
+  float_spec_t spec;
+  spec.format = specs.format;
+  if (specs.format == float_format_e::shortest) {
+    if (specs.prec_or_id < 0) {
+      spec.round_trip_prec = round_trip_prec;
+    } else {
+      spec.format = float_format_e::general;
+    }
+  }
+  bool const hex_or_binary =
+      specs.format == float_format_e::hex or specs.format == float_format_e::binary;
+  // hexadecimal and binary output is exact unless a precision is given
+  spec.precision = specs.prec_or_id >= 0 ? static_cast<long>(specs.prec_or_id)
+                   : hex_or_binary       ? -1
+                                         : 6;
+  spec.upper = specs.upper;
+  spec.alt = specs.alt;
+
+  bool const signbit = mpfr_signbit(&value.m);
+  size_t const n_sign = (signbit or specs.sign != sign_e::minus) ? 1 : 0;
+
+  size_t const bound = float_chars_bound(&value.m, spec);
+  char const* const sign = signbit ? "-" : specs.sign == sign_e::plus ? "+" : " ";
+
+  if (specs.width_or_id <= 1) {
+    // no padding, the characters are written in place when the output is contiguous
+    if (char* const dst = out.reserve(n_sign + bound, false)) {
+      std::memcpy(dst, sign, n_sign);
+      out.commit(write_float_abs(dst + n_sign, dst + n_sign + bound, value, spec));
+      return;
+    }
+  }
+
+  bool const use_heap = bound > stack_bufsize;
+  mpfr::_::heap_str_t heap_buffer{use_heap ? bound : 0};
+  char* const ptr = use_heap ? heap_buffer.p : stack_buffer;
+  char const* const end = write_float_abs(ptr, ptr + bound, value, spec);
+  auto const len = static_cast<size_t>(end - ptr);
+
+  auto const width = static_cast<size_t>(specs.width_or_id);
+  size_t const n_padding = (width > len + n_sign) ? (width - len - n_sign) : 0;
+  size_t const left_padding = (specs.align == align_e::right)    ? n_padding
+                              : (specs.align == align_e::center) ? (n_padding / 2)
+                                                                 : 0;
+  size_t const right_padding = n_padding - left_padding;
+
+  if (char* dst = out.reserve(n_padding * specs.fill.size + n_sign + len, true)) {
+    auto fill_n = [&](size_t n) {
+      if (specs.fill.size == 1) {
+        std::memset(dst, specs.fill.data[0], n);
+        dst += n;
+        return;
+      }
+      for (size_t i = 0; i < n; ++i) {
+        std::memcpy(dst, specs.fill.data, specs.fill.size);
+        dst += specs.fill.size;
+      }
+    };
+    fill_n(left_padding);
+    std::memcpy(dst, sign, n_sign);
+    dst += n_sign;
+    std::memcpy(dst, ptr, len);
+    dst += len;
+    fill_n(right_padding);
+    out.commit(dst);
+    return;
+  }
 
   alignas(0x400) char buffer[0x400];
 
@@ -629,16 +710,18 @@ inline void format_impl(
     space = sizeof(buffer);
   };
 
-  auto chars_to_buf = [&](char const* begin, std::size_t len) {
-    while (len > 0) {
-      if (len <= space) {
-        std::memcpy(pos, begin, len);
-        pos += len;
-        space -= len;
+  auto chars_to_buf = [&](char const* begin, std::size_t n) {
+    while (n > 0) {
+      if (n <= space) {
+        std::memcpy(pos, begin, n);
+        pos += n;
+        space -= n;
         return;
       } else {
         std::memcpy(pos, begin, space);
-        len -= space;
+        begin += space;
+        n -= space;
+        pos += space;
         flush_buf();
       }
     }
@@ -651,13 +734,10 @@ inline void format_impl(
   };
 
   fill_n(left_padding);
-  (signbit ? chars_to_buf("-", 1) : specs.sign == sign_e::plus ? chars_to_buf("+", 1) : (void)0);
-  fill_n(0); // inner padding?
-  chars_to_buf(ptr, std::strlen(ptr));
-  ((zero_padding > 0) ? chars_to_buf(".", 1) : (void)0);
-  for (size_t i = 0; i < zero_padding; ++i) {
-    chars_to_buf("0", 1);
+  if (n_sign > 0) {
+    chars_to_buf(sign, 1);
   }
+  chars_to_buf(ptr, len);
   fill_n(right_padding);
   flush_buf();
 }
@@ -698,7 +778,8 @@ struct formatter<mpfr::mp_float_t<P>, char, void> : ::mpfr::_::libfmt::base_pars
         ::mpfr::_::libfmt::out_iter_ref_t(&out),
         stack_buffer,
         stack_bufsize,
-        ::mpfr::_::libfmt::base_parser::specs);
+        ::mpfr::_::libfmt::base_parser::specs,
+        static_cast<mpfr_prec_t>(P));
     return out;
   }
 };
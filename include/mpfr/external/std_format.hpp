@@ -0,0 +1,146 @@
+#ifndef STD_FORMAT_HPP_R6WQ1JZD
+#define STD_FORMAT_HPP_R6WQ1JZD
+
+#include "mpfr/external/fmt.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+#if defined(__cpp_lib_format)
+
+#include <format>
+#include <limits>
+
+namespace mpfr {
+namespace _ {
+namespace stdfmt {
+
+/// Reports invalid specs with `std::format_error`. When a constant format string is checked at
+/// compile time, reaching it makes the check fail to be a constant expression instead.
+struct error_handler_t {
+  [[noreturn]] void on_error(char const* msg) {
+#if defined(__cpp_exceptions)
+    throw std::format_error(msg);
+#else
+    _::crash_with_message(msg);
+#endif
+  }
+};
+
+/// Parse context of `std::format`, with the interface expected by `parse_mp_float_type_specs`.
+template <typename Parse_Context> struct parse_context_ref_t {
+  using iterator = typename Parse_Context::iterator;
+
+  Parse_Context& ctx;
+
+  constexpr auto begin() const -> iterator { return ctx.begin(); }
+  constexpr auto end() const -> iterator { return ctx.end(); }
+  constexpr auto next_arg_id() -> int { return static_cast<int>(ctx.next_arg_id()); }
+  constexpr void check_arg_id(int id) { ctx.check_arg_id(static_cast<std::size_t>(id)); }
+  constexpr auto error_handler() const -> error_handler_t { return {}; }
+};
+
+/// \return The value of the dynamic width or precision `id`, which must be an integer no smaller
+/// than `min_val`.
+template <typename Format_Context>
+auto dynamic_arg_to_int(
+    Format_Context& ctx,
+    int id,
+    int min_val,
+    char const* not_integral_msg,
+    char const* too_small_msg,
+    char const* too_large_msg) -> int {
+  auto to_int = [&](auto val) -> int {
+    using T = decltype(val);
+    error_handler_t eh;
+    if constexpr (
+        std::is_integral_v<T> and not std::is_same_v<T, bool> and
+        not std::is_same_v<T, typename Format_Context::char_type>) {
+      if (libfmt::cmp_less(val, min_val)) {
+        eh.on_error(too_small_msg);
+      }
+      if (libfmt::cmp_less(std::numeric_limits<int>::max(), val)) {
+        eh.on_error(too_large_msg);
+      }
+      return static_cast<int>(val);
+    } else {
+      eh.on_error(not_integral_msg);
+    }
+  };
+  auto const arg = ctx.arg(static_cast<std::size_t>(id));
+#if __cpp_lib_format >= 202306L
+  return arg.visit(to_int);
+#else
+  return std::visit_format_arg(to_int, arg);
+#endif
+}
+
+template <typename Format_Context>
+void parse_dynamic_args(libfmt::mp_float_specs& specs, Format_Context& ctx) {
+  if (specs.dyn_prec) {
+    specs.prec_or_id = stdfmt::dynamic_arg_to_int(
+        ctx,
+        specs.prec_or_id,
+        0,
+        "precision is not integral",
+        "precision must be non negative",
+        "precision is too large");
+  }
+  if (specs.dyn_width) {
+    specs.width_or_id = stdfmt::dynamic_arg_to_int(
+        ctx,
+        specs.width_or_id,
+        1,
+        "width is not integral",
+        "width must be positive",
+        "width is too large");
+  }
+}
+
+} // namespace stdfmt
+} // namespace _
+} // namespace mpfr
+
+/// Same specs as the `fmt` formatter. `parse` is a constant expression, so that constant format
+/// strings are checked and parsed at compile time.
+template <mpfr::precision_t P> struct std::formatter<mpfr::mp_float_t<P>, char> {
+  template <typename Parse_Context>
+  constexpr auto parse(Parse_Context& ctx) -> typename Parse_Context::iterator {
+    ::mpfr::_::stdfmt::parse_context_ref_t<Parse_Context> ref{ctx};
+    return ::mpfr::_::libfmt::parse_mp_float_type_specs(m_specs, ref);
+  }
+
+  template <typename Format_Context>
+  auto format(mpfr::mp_float_t<P> const& value, Format_Context& ctx) const ->
+      typename Format_Context::iterator {
+    ::mpfr::_::libfmt::mp_float_specs specs = m_specs;
+    ::mpfr::_::stdfmt::parse_dynamic_args(specs, ctx);
+
+    constexpr std::size_t stack_bufsize =
+        ::mpfr::_::digits2_to_10(static_cast<std::size_t>(::mpfr::mp_float_t<P>::precision) + 64);
+    char stack_buffer[stack_bufsize];
+
+    auto out = ctx.out();
+    ::mpfr::_::libfmt::format_impl(
+        ::mpfr::_::impl_access::mpfr_cref(value),
+        ::mpfr::_::libfmt::out_iter_ref_t(&out),
+        stack_buffer,
+        stack_bufsize,
+        specs,
+        static_cast<mpfr_prec_t>(P));
+    return out;
+  }
+
+private:
+  ::mpfr::_::libfmt::mp_float_specs m_specs;
+};
+
+#endif
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard STD_FORMAT_HPP_R6WQ1JZD */
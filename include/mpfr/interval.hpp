@@ -0,0 +1,409 @@
+#ifndef INTERVAL_HPP_T3NW8KFQ
+#define INTERVAL_HPP_T3NW8KFQ
+
+#include "mpfr/mp_float.hpp"
+#include "mpfr/math.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <limits>
+
+namespace mpfr {
+namespace _ {
+
+using unary_op_t = int (*)(mpfr_ptr, mpfr_srcptr, mpfr_rnd_t);
+using binary_op_t = int (*)(mpfr_ptr, mpfr_srcptr, mpfr_srcptr, mpfr_rnd_t);
+
+/// Same as `apply_unary_op`, with the rounding mode `rnd` rather than the one of the floating
+/// point environment.
+template <precision_t P>
+auto round_unary(mp_float_t<P> const& x, unary_op_t op, mpfr_rnd_t rnd) noexcept
+    -> mp_float_t<P> {
+  mp_float_t<P> out;
+  {
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
+    _::mpfr_cref_t x_ = _::impl_access::mpfr_cref(x);
+    op(&g.m, &x_.m, rnd);
+  }
+  return out;
+}
+
+/// Same as `apply_binary_op`, with the rounding mode `rnd` rather than the one of the floating
+/// point environment.
+template <precision_t P>
+auto round_binary(mp_float_t<P> const& x, mp_float_t<P> const& y, binary_op_t op, mpfr_rnd_t rnd)
+    noexcept -> mp_float_t<P> {
+  mp_float_t<P> out;
+  {
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
+    _::mpfr_cref_t x_ = _::impl_access::mpfr_cref(x);
+    _::mpfr_cref_t y_ = _::impl_access::mpfr_cref(y);
+    op(&g.m, &x_.m, &y_.m, rnd);
+  }
+  return out;
+}
+
+/// Product of two bounds, where zero times infinity is zero, since the bounds are limits of
+/// the values of the intervals.
+template <precision_t P>
+auto bound_mul(mp_float_t<P> const& x, mp_float_t<P> const& y, mpfr_rnd_t rnd) noexcept
+    -> mp_float_t<P> {
+  if (x == 0 or y == 0) {
+    return {};
+  }
+  return _::round_binary(x, y, mpfr_mul, rnd);
+}
+
+/// \return The smaller of `a` and `b`, ignoring a NaN.
+template <precision_t P>
+auto bound_min(mp_float_t<P> const& a, mp_float_t<P> const& b) noexcept -> mp_float_t<P> const& {
+  return (b < a or mpfr::isnan(a)) ? b : a;
+}
+
+/// \return The larger of `a` and `b`, ignoring a NaN.
+template <precision_t P>
+auto bound_max(mp_float_t<P> const& a, mp_float_t<P> const& b) noexcept -> mp_float_t<P> const& {
+  return (b > a or mpfr::isnan(a)) ? b : a;
+}
+
+/// \return `x` rounded to precision `P` in the direction `rnd`.
+template <precision_t P, precision_t Q>
+auto round_to(mp_float_t<Q> const& x, mpfr_rnd_t rnd) noexcept -> mp_float_t<P> {
+  mp_float_t<P> out;
+  {
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
+    _::mpfr_cref_t x_ = _::impl_access::mpfr_cref(x);
+    mpfr_set(&g.m, &x_.m, rnd);
+  }
+  return out;
+}
+
+template <precision_t P> auto const_pi_rnd(mpfr_rnd_t rnd) noexcept -> mp_float_t<P> {
+  mp_float_t<P> out;
+  {
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
+    mpfr_const_pi(&g.m, rnd);
+  }
+  return out;
+}
+
+} // namespace _
+
+/// Closed interval `[lo, hi]` of real numbers, with bounds of type `mp_float_t<P>`.\n
+/// The operations round the lower bound of their result down and the upper bound up, with the
+/// rounding modes of MPFR rather than the floating point environment, so that the result
+/// contains the exact result for every value of the arguments. Running a computation with
+/// intervals thus certifies the accuracy of its result, at the cost of about twice the
+/// operations.\n
+/// A bound of an argument that is outside of the domain of a function gives a NaN bound.
+template <precision_t P> class interval_t {
+public:
+  /// Interval `[0, 0]`.
+  interval_t() noexcept = default;
+
+  /// Interval `[x, x]`.
+  interval_t(mp_float_t<P> const& x) noexcept : m_lo{x}, m_hi{x} {} // NOLINT
+
+  /// Interval `[lo, hi]`. `lo` must not be greater than `hi`.
+  interval_t(mp_float_t<P> const& lo, mp_float_t<P> const& hi) noexcept : m_lo{lo}, m_hi{hi} {
+    MPFR_CXX_ASSERT(not(lo > hi));
+  }
+
+  /// Smallest interval that contains `x`.
+  template <precision_t Q>
+  interval_t(mp_float_t<Q> const& x) noexcept // NOLINT
+      : m_lo{_::round_to<P>(x, MPFR_RNDD)}, m_hi{_::round_to<P>(x, MPFR_RNDU)} {}
+
+  /// Smallest interval that contains `x`.
+  template <typename T, typename = _::enable_if_t<_::is_arithmetic<T>::value>>
+  interval_t(T const& x) noexcept // NOLINT
+      // wide enough for the builtin types, so that the conversion is exact
+      : interval_t{mp_float_t<digits2{128}>{x}} {}
+
+  /// \return The lower bound.
+  [[MPFR_CXX_NODISCARD]] auto lo() const noexcept -> mp_float_t<P> const& { return m_lo; }
+  /// \return The upper bound.
+  [[MPFR_CXX_NODISCARD]] auto hi() const noexcept -> mp_float_t<P> const& { return m_hi; }
+
+  /// \return The midpoint, rounded to nearest.
+  [[MPFR_CXX_NODISCARD]] auto mid() const noexcept -> mp_float_t<P> {
+    mp_float_t<P> const sum = _::round_binary(m_lo, m_hi, mpfr_add, MPFR_RNDN);
+    return _::round_binary(sum, mp_float_t<P>{0.5}, mpfr_mul, MPFR_RNDN);
+  }
+
+  /// \return An upper bound of the width `hi - lo`.
+  [[MPFR_CXX_NODISCARD]] auto width() const noexcept -> mp_float_t<P> {
+    return _::round_binary(m_hi, m_lo, mpfr_sub, MPFR_RNDU);
+  }
+
+  /// \return Whether `x` lies in the interval.
+  [[MPFR_CXX_NODISCARD]] auto contains(mp_float_t<P> const& x) const noexcept -> bool {
+    return m_lo <= x and x <= m_hi;
+  }
+
+  /** @name Arithmetic operators
+   */
+  ///@{
+  /// \n
+  [[MPFR_CXX_NODISCARD]] auto operator+() const noexcept -> interval_t { return *this; }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] auto operator-() const noexcept -> interval_t { return {-m_hi, -m_lo}; }
+
+  /// \n
+  auto operator+=(interval_t const& b) noexcept -> interval_t& { return *this = *this + b; }
+  /// \n
+  auto operator-=(interval_t const& b) noexcept -> interval_t& { return *this = *this - b; }
+  /// \n
+  auto operator*=(interval_t const& b) noexcept -> interval_t& { return *this = *this * b; }
+  /// \n
+  auto operator/=(interval_t const& b) noexcept -> interval_t& { return *this = *this / b; }
+
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator+(interval_t const& a, interval_t const& b) noexcept
+      -> interval_t {
+    return {
+        _::round_binary(a.m_lo, b.m_lo, mpfr_add, MPFR_RNDD),
+        _::round_binary(a.m_hi, b.m_hi, mpfr_add, MPFR_RNDU)};
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator-(interval_t const& a, interval_t const& b) noexcept
+      -> interval_t {
+    return {
+        _::round_binary(a.m_lo, b.m_hi, mpfr_sub, MPFR_RNDD),
+        _::round_binary(a.m_hi, b.m_lo, mpfr_sub, MPFR_RNDU)};
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator*(interval_t const& a, interval_t const& b) noexcept
+      -> interval_t {
+    if (not(a.m_lo < 0) and not(b.m_lo < 0)) {
+      return {_::bound_mul(a.m_lo, b.m_lo, MPFR_RNDD), _::bound_mul(a.m_hi, b.m_hi, MPFR_RNDU)};
+    }
+    mp_float_t<P> lo = _::bound_mul(a.m_lo, b.m_lo, MPFR_RNDD);
+    mp_float_t<P> hi = _::bound_mul(a.m_lo, b.m_lo, MPFR_RNDU);
+    interval_t::extend(lo, hi, a.m_lo, b.m_hi, _::bound_mul<P>);
+    interval_t::extend(lo, hi, a.m_hi, b.m_lo, _::bound_mul<P>);
+    interval_t::extend(lo, hi, a.m_hi, b.m_hi, _::bound_mul<P>);
+    return {lo, hi};
+  }
+  /// Division. If `b` contains zero, the result is the whole real line.
+  [[MPFR_CXX_NODISCARD]] friend auto operator/(interval_t const& a, interval_t const& b) noexcept
+      -> interval_t {
+    if (b.m_lo <= 0 and b.m_hi >= 0) {
+      mp_float_t<P> const inf = std::numeric_limits<mp_float_t<P>>::infinity();
+      return {-inf, inf};
+    }
+    auto div = [](mp_float_t<P> const& x, mp_float_t<P> const& y, mpfr_rnd_t rnd) {
+      return _::round_binary(x, y, mpfr_div, rnd);
+    };
+    mp_float_t<P> lo = div(a.m_lo, b.m_lo, MPFR_RNDD);
+    mp_float_t<P> hi = div(a.m_lo, b.m_lo, MPFR_RNDU);
+    interval_t::extend(lo, hi, a.m_lo, b.m_hi, div);
+    interval_t::extend(lo, hi, a.m_hi, b.m_lo, div);
+    interval_t::extend(lo, hi, a.m_hi, b.m_hi, div);
+    return {lo, hi};
+  }
+  ///@}
+
+private:
+  /// Extends `[lo, hi]` to contain `op(x, y)`. A NaN candidate is ignored, which only happens
+  /// for infinite bounds, where it is never the extremum.
+  template <typename Op>
+  static void extend(
+      mp_float_t<P>& lo,
+      mp_float_t<P>& hi,
+      mp_float_t<P> const& x,
+      mp_float_t<P> const& y,
+      Op const& op) noexcept {
+    lo = _::bound_min(lo, op(x, y, MPFR_RNDD));
+    hi = _::bound_max(hi, op(x, y, MPFR_RNDU));
+  }
+
+  mp_float_t<P> m_lo;
+  mp_float_t<P> m_hi;
+};
+
+namespace _ {
+
+/// \return The image of `x` by an increasing function.
+template <precision_t P>
+auto interval_increasing(interval_t<P> const& x, unary_op_t op) noexcept -> interval_t<P> {
+  return {_::round_unary(x.lo(), op, MPFR_RNDD), _::round_unary(x.hi(), op, MPFR_RNDU)};
+}
+
+/// \return The image of `x` by a decreasing function.
+template <precision_t P>
+auto interval_decreasing(interval_t<P> const& x, unary_op_t op) noexcept -> interval_t<P> {
+  return {_::round_unary(x.hi(), op, MPFR_RNDD), _::round_unary(x.lo(), op, MPFR_RNDU)};
+}
+
+/// \return The image of `x` by `op`, which is either sine or cosine, and reaches its extrema at
+/// `(k + shift) pi` for integers `k`, the maxima for even `k`.\n
+/// The extrema are located with an enclosure of `x / pi - shift`. When an integer is too close
+/// to the bounds of the enclosure to decide, the extremum is assumed to be in the interval.
+template <precision_t P>
+auto interval_trig(interval_t<P> const& x, unary_op_t op, mp_float_t<P> const& shift) noexcept
+    -> interval_t<P> {
+  if (mpfr::isnan(x.lo()) or mpfr::isnan(x.hi())) {
+    return {x.lo() + x.hi()};
+  }
+  interval_t<P> const unit{-1, 1};
+  if (not mpfr::isfinite(x.lo()) or not mpfr::isfinite(x.hi())) {
+    return unit;
+  }
+  mp_float_t<P> const pi_lo = _::const_pi_rnd<P>(MPFR_RNDD);
+  mp_float_t<P> const pi_hi = _::const_pi_rnd<P>(MPFR_RNDU);
+  // x / pi is smallest with the largest pi for positive x, and with the smallest for negative x
+  mp_float_t<P> const q_lo = _::round_binary(
+      _::round_binary(x.lo(), x.lo() < 0 ? pi_lo : pi_hi, mpfr_div, MPFR_RNDD),
+      shift,
+      mpfr_sub,
+      MPFR_RNDD);
+  mp_float_t<P> const q_hi = _::round_binary(
+      _::round_binary(x.hi(), x.hi() < 0 ? pi_hi : pi_lo, mpfr_div, MPFR_RNDU),
+      shift,
+      mpfr_sub,
+      MPFR_RNDU);
+
+  mp_float_t<P> const k = _::round_unary(q_lo, mpfr_rint_ceil, MPFR_RNDU);
+  bool const has_k = k <= q_hi;
+  bool const has_next = _::round_binary(k, mp_float_t<P>{1}, mpfr_add, MPFR_RNDD) <= q_hi;
+  if (has_k and has_next) {
+    return unit;
+  }
+
+  mp_float_t<P> lo = _::bound_min(
+      _::round_unary(x.lo(), op, MPFR_RNDD), _::round_unary(x.hi(), op, MPFR_RNDD));
+  mp_float_t<P> hi = _::bound_max(
+      _::round_unary(x.lo(), op, MPFR_RNDU), _::round_unary(x.hi(), op, MPFR_RNDU));
+  if (has_k) {
+    mp_float_t<P> const half_k = _::round_binary(k, mp_float_t<P>{0.5}, mpfr_mul, MPFR_RNDN);
+    _::mpfr_cref_t const h = _::impl_access::mpfr_cref(half_k);
+    if (mpfr_integer_p(&h.m) != 0) {
+      hi = 1;
+    } else {
+      lo = -1;
+    }
+  }
+  return {lo, hi};
+}
+
+} // namespace _
+
+/// \return The absolute values of `x`.
+template <precision_t P> auto abs(interval_t<P> const& x) noexcept -> interval_t<P> {
+  if (not(x.lo() < 0)) {
+    return x;
+  }
+  if (not(x.hi() > 0)) {
+    return -x;
+  }
+  return {{}, _::bound_max(-x.lo(), x.hi())};
+}
+
+/// \return An interval that contains the squares of the values of `x`.
+template <precision_t P> auto sqr(interval_t<P> const& x) noexcept -> interval_t<P> {
+  interval_t<P> const a = mpfr::abs(x);
+  return {_::bound_mul(a.lo(), a.lo(), MPFR_RNDD), _::bound_mul(a.hi(), a.hi(), MPFR_RNDU)};
+}
+
+/// \return Square roots of `x`.
+template <precision_t P> auto sqrt(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_sqrt);
+}
+/// \return Cubic roots of `x`.
+template <precision_t P> auto cbrt(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_cbrt);
+}
+
+/// \return Sines of `x`.
+template <precision_t P> auto sin(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_trig(x, mpfr_sin, mp_float_t<P>{0.5});
+}
+/// \return Cosines of `x`.
+template <precision_t P> auto cos(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_trig(x, mpfr_cos, mp_float_t<P>{0});
+}
+/// \return Arc sines of `x`.
+template <precision_t P> auto asin(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_asin);
+}
+/// \return Arc cosines of `x`.
+template <precision_t P> auto acos(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_decreasing(x, mpfr_acos);
+}
+/// \return Arc tangents of `x`.
+template <precision_t P> auto atan(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_atan);
+}
+
+/// \return Hyperbolic sines of `x`.
+template <precision_t P> auto sinh(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_sinh);
+}
+/// \return Hyperbolic cosines of `x`.
+template <precision_t P> auto cosh(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(mpfr::abs(x), mpfr_cosh);
+}
+/// \return Hyperbolic tangents of `x`.
+template <precision_t P> auto tanh(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_tanh);
+}
+/// \return Inverse hyperbolic sines of `x`.
+template <precision_t P> auto asinh(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_asinh);
+}
+/// \return Inverse hyperbolic cosines of `x`.
+template <precision_t P> auto acosh(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_acosh);
+}
+/// \return Inverse hyperbolic tangents of `x`.
+template <precision_t P> auto atanh(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_atanh);
+}
+
+/// \return Exponentials of `x`.
+template <precision_t P> auto exp(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_exp);
+}
+/// \return Two to the power of `x`.
+template <precision_t P> auto exp2(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_exp2);
+}
+/// \return Ten to the power of `x`.
+template <precision_t P> auto exp10(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_exp10);
+}
+/// \return Exponentials of `x`, minus one.
+template <precision_t P> auto expm1(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_expm1);
+}
+/// \return Natural logarithms of `x`.
+template <precision_t P> auto log(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_log);
+}
+/// \return Base two logarithms of `x`.
+template <precision_t P> auto log2(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_log2);
+}
+/// \return Base ten logarithms of `x`.
+template <precision_t P> auto log10(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_log10);
+}
+/// \return Natural logarithms of one plus `x`.
+template <precision_t P> auto log1p(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_log1p);
+}
+
+/// \return Error functions of `x`.
+template <precision_t P> auto erf(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_increasing(x, mpfr_erf);
+}
+/// \return Complementary error functions of `x`.
+template <precision_t P> auto erfc(interval_t<P> const& x) noexcept -> interval_t<P> {
+  return _::interval_decreasing(x, mpfr_erfc);
+}
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard INTERVAL_HPP_T3NW8KFQ */
@@ -0,0 +1,547 @@
+#ifndef LINALG_HPP_M6YV2CTE
+#define LINALG_HPP_M6YV2CTE
+
+#include "mpfr/span.hpp"
+#include "mpfr/detail/thread_pool.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <cmath>
+
+namespace mpfr {
+namespace linalg {
+
+/// Non owning view over a row major matrix.
+template <typename T> struct matrix_view {
+private:
+  T* m_data = nullptr;
+  std::size_t m_rows = 0;
+  std::size_t m_cols = 0;
+  std::size_t m_stride = 0;
+
+public:
+  /// Constructs an empty view.
+  constexpr matrix_view() noexcept = default;
+  /// Constructs a view over a matrix whose rows are stored contiguously.
+  constexpr matrix_view(T* data, std::size_t rows, std::size_t cols) noexcept
+      : m_data{data}, m_rows{rows}, m_cols{cols}, m_stride{cols} {}
+  /// Constructs a view over a matrix whose rows start every `stride` elements.
+  constexpr matrix_view(T* data, std::size_t rows, std::size_t cols, std::size_t stride) noexcept
+      : m_data{data}, m_rows{rows}, m_cols{cols}, m_stride{stride} {}
+  /// Conversion from a view over mutable objects to a view over immutable objects.
+  template <typename U, typename = _::enable_if_t<_::is_same<U const, T>::value>>
+  constexpr matrix_view(matrix_view<U> m) noexcept // NOLINT(hicpp-explicit-conversions)
+      : m_data{m.data()}, m_rows{m.rows()}, m_cols{m.cols()}, m_stride{m.stride()} {}
+
+  [[MPFR_CXX_NODISCARD]] constexpr auto data() const noexcept -> T* { return m_data; }
+  [[MPFR_CXX_NODISCARD]] constexpr auto rows() const noexcept -> std::size_t { return m_rows; }
+  [[MPFR_CXX_NODISCARD]] constexpr auto cols() const noexcept -> std::size_t { return m_cols; }
+  /// Distance in elements between the start of two consecutive rows.
+  [[MPFR_CXX_NODISCARD]] constexpr auto stride() const noexcept -> std::size_t { return m_stride; }
+
+  [[MPFR_CXX_NODISCARD]] constexpr auto operator()(std::size_t i, std::size_t j) const noexcept
+      -> T& {
+    return m_data[i * m_stride + j];
+  }
+  /// \return The view over the `n_rows` by `n_cols` block whose top left element is at `(i, j)`.
+  [[MPFR_CXX_NODISCARD]] constexpr auto
+  block(std::size_t i, std::size_t j, std::size_t n_rows, std::size_t n_cols) const noexcept
+      -> matrix_view {
+    return {m_data + i * m_stride + j, n_rows, n_cols, m_stride};
+  }
+  /// \return The view over the `i`-th row.
+  [[MPFR_CXX_NODISCARD]] constexpr auto row(std::size_t i) const noexcept -> span<T> {
+    return {m_data + i * m_stride, m_cols};
+  }
+};
+
+namespace _ {
+using namespace ::mpfr::_;
+
+/// Cache sizes the blocking of the matrix product is tuned for.
+constexpr std::size_t l1_cache_bytes = std::size_t{32} << 10U;
+constexpr std::size_t l2_cache_bytes = std::size_t{256} << 10U;
+
+constexpr auto max(std::size_t a, std::size_t b) -> std::size_t { return a > b ? a : b; }
+constexpr auto min(std::size_t a, std::size_t b) -> std::size_t { return a < b ? a : b; }
+
+/// Block sizes of the matrix product, from the size of an element.\n
+/// A row of `kc` elements of `a` and a packed column of `kc` elements of `b` fit in L1, and the
+/// packed `kc` by `nc` panel of `b` fits in L2.
+template <typename T> struct gemm_blocking {
+  static constexpr std::size_t kc = max(16, l1_cache_bytes / 2 / sizeof(T));
+  static constexpr std::size_t nc = max(4, l2_cache_bytes / 2 / (kc * sizeof(T)));
+  static constexpr std::size_t mc = 4 * nc;
+};
+
+/// Correctly rounded dot product of `n` pairs of already bound operands.
+inline void
+dot_refs(mpfr_raii_setter_t& out, mpfr_ptr const* xs, mpfr_ptr const* ys, std::size_t n) {
+#if MPFR_VERSION_MAJOR > 4 or (MPFR_VERSION_MAJOR == 4 and MPFR_VERSION_MINOR >= 1)
+  mpfr_dot(&out.m, xs, ys, n, _::get_rnd());
+#else
+  // no mpfr_dot before MPFR 4.1, fall back to an fma chain
+  mpfr_set_zero(&out.m, 1);
+  for (std::size_t i = 0; i < n; ++i) {
+    mpfr_fma(&out.m, xs[i], ys[i], &out.m, _::get_rnd());
+  }
+#endif
+}
+
+/// Scratch memory of a thread computing tiles of the product.
+template <typename T> struct gemm_workspace {
+  using blocking = gemm_blocking<T>;
+  std::vector<T> packed_b = std::vector<T>(blocking::kc * blocking::nc);
+  std::vector<mpfr_cref_t> b_refs = std::vector<mpfr_cref_t>(blocking::kc * blocking::nc);
+  std::vector<mpfr_ptr> b_ptrs = std::vector<mpfr_ptr>(blocking::kc * blocking::nc);
+  std::vector<mpfr_cref_t> a_refs = std::vector<mpfr_cref_t>(blocking::kc);
+  std::vector<mpfr_ptr> a_ptrs = std::vector<mpfr_ptr>(blocking::kc);
+};
+
+/// Computes the tile of the product whose top left element is at `(i0, j0)`.
+template <precision_t P>
+void gemm_tile(
+    matrix_view<mp_float_t<P>> c,
+    matrix_view<mp_float_t<P> const> a,
+    matrix_view<mp_float_t<P> const> b,
+    std::size_t i0,
+    std::size_t j0,
+    bool accumulate,
+    gemm_workspace<mp_float_t<P>>& ws) {
+  using T = mp_float_t<P>;
+  using blocking = gemm_blocking<T>;
+  constexpr std::size_t kc = blocking::kc;
+  constexpr std::size_t nc = blocking::nc;
+
+  std::size_t const m_len = min(blocking::mc, c.rows() - i0);
+  std::size_t const n_len = min(nc, c.cols() - j0);
+  std::size_t const k = a.cols();
+
+  T* packed_b = ws.packed_b.data();
+  mpfr_cref_t* a_refs = ws.a_refs.data();
+  mpfr_ptr* a_ptrs = ws.a_ptrs.data();
+  mpfr_cref_t* b_refs = ws.b_refs.data();
+  mpfr_ptr* b_ptrs = ws.b_ptrs.data();
+
+  if (k == 0 and not accumulate) {
+    for (std::size_t i = 0; i < m_len; ++i) {
+      for (std::size_t j = 0; j < n_len; ++j) {
+        c(i0 + i, j0 + j) = 0;
+      }
+    }
+  }
+
+  for (std::size_t k0 = 0; k0 < k; k0 += kc) {
+    std::size_t const k_len = min(kc, k - k0);
+
+    // pack the panel of b column by column, so that the operands of each dot product are
+    // contiguous
+    for (std::size_t j = 0; j < n_len; ++j) {
+      for (std::size_t p = 0; p < k_len; ++p) {
+        std::memcpy(&packed_b[j * kc + p], &b(k0 + p, j0 + j), sizeof(T));
+      }
+    }
+    for (std::size_t j = 0; j < n_len; ++j) {
+      for (std::size_t p = 0; p < k_len; ++p) {
+        b_refs[j * kc + p] = impl_access::mpfr_cref(packed_b[j * kc + p]);
+        b_ptrs[j * kc + p] = &b_refs[j * kc + p].m;
+      }
+    }
+
+    for (std::size_t i = 0; i < m_len; ++i) {
+      for (std::size_t p = 0; p < k_len; ++p) {
+        a_refs[p] = impl_access::mpfr_cref(a(i0 + i, k0 + p));
+        a_ptrs[p] = &a_refs[p].m;
+      }
+      for (std::size_t j = 0; j < n_len; ++j) {
+        T& c_ij = c(i0 + i, j0 + j);
+        if (k0 == 0 and not accumulate) {
+          mpfr_raii_setter_t&& g = impl_access::mpfr_setter(c_ij);
+          _::dot_refs(g, a_ptrs, b_ptrs + j * kc, k_len);
+        } else {
+          T partial;
+          {
+            mpfr_raii_setter_t&& g = impl_access::mpfr_setter(partial);
+            _::dot_refs(g, a_ptrs, b_ptrs + j * kc, k_len);
+          }
+          c_ij += partial;
+        }
+      }
+    }
+  }
+}
+
+} // namespace _
+
+/// Matrix product `c = a * b`, or `c += a * b` if `accumulate` is `true`.\n
+/// The computation is blocked with sizes derived from the size of `mp_float_t<P>`, and the output
+/// tiles are distributed over the thread pool. Each entry is accumulated over blocks of the inner
+/// dimension, and the contribution of each block is a correctly rounded dot product. The result
+/// does not depend on the number of threads.
+///
+/// `c` must not overlap with `a` or `b`.
+///
+/// @param[out] c         Output matrix with as many rows as `a` and as many columns as `b`.
+/// @param[in] a          Left operand.
+/// @param[in] b          Right operand, with as many rows as `a` has columns.
+/// @param[in] accumulate Whether the product is added to the previous contents of `c`.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <precision_t P>
+void gemm(
+    matrix_view<mp_float_t<P>> c,
+    matrix_view<mp_float_t<P> const> a,
+    matrix_view<mp_float_t<P> const> b,
+    bool accumulate = false,
+    std::size_t n_threads = 0) {
+  if (a.cols() != b.rows() or c.rows() != a.rows() or c.cols() != b.cols()) {
+    ::mpfr::_::crash_with_message("gemm: incompatible matrix dimensions");
+  }
+  if (c.rows() == 0 or c.cols() == 0) {
+    return;
+  }
+
+  using T = mp_float_t<P>;
+  using blocking = _::gemm_blocking<T>;
+  std::size_t const m_tiles = (c.rows() + blocking::mc - 1) / blocking::mc;
+  std::size_t const n_tiles = (c.cols() + blocking::nc - 1) / blocking::nc;
+
+  auto task = [&](std::size_t tile) {
+    _::gemm_workspace<T> ws;
+    _::gemm_tile(
+        c, a, b, (tile / n_tiles) * blocking::mc, (tile % n_tiles) * blocking::nc, accumulate, ws);
+  };
+  ::mpfr::_::thread_pool::global().for_each_index(m_tiles * n_tiles, n_threads, task);
+}
+
+/// Outcome of an iteratively refined linear solve.
+struct solve_result_t {
+  /// Whether the refinement converged to the target precision.
+  bool success;
+  /// Number of corrections applied to the solution, including the initial solve.
+  std::size_t iterations;
+};
+
+namespace _ {
+
+/// Conversions from the target precision to the precision of the factorization.
+template <typename Work> struct work_traits;
+
+template <> struct work_traits<double> {
+  template <precision_t P> static auto from(mp_float_t<P> const& x) noexcept -> double {
+    mpfr_cref_t x_ = impl_access::mpfr_cref(x);
+    return mpfr_get_d(&x_.m, MPFR_RNDN);
+  }};
+
+template <precision_t Q> struct work_traits<mp_float_t<Q>> {
+  template <precision_t P> static auto from(mp_float_t<P> const& x) noexcept -> mp_float_t<Q> {
+    return x;
+  }};
+
+inline auto abs_of(double x) noexcept -> double { return x < 0 ? -x : x; }
+template <precision_t Q> auto abs_of(mp_float_t<Q> const& x) noexcept -> mp_float_t<Q> {
+  return mpfr::fabs(x);
+}
+inline auto sqrt_of(double x) noexcept -> double { return std::sqrt(x); }
+template <precision_t Q> auto sqrt_of(mp_float_t<Q> const& x) noexcept -> mp_float_t<Q> {
+  return mpfr::sqrt(x);
+}
+
+/// LU factorization with partial pivoting of a row major `n` by `n` matrix, in place.
+/// \return `false` if a zero pivot is encountered.
+template <typename Work> auto lu_factorize(Work* lu, std::size_t* perm, std::size_t n) -> bool {
+  for (std::size_t k = 0; k < n; ++k) {
+    std::size_t p = k;
+    for (std::size_t i = k + 1; i < n; ++i) {
+      if (abs_of(lu[i * n + k]) > abs_of(lu[p * n + k])) {
+        p = i;
+      }
+    }
+    if (not(abs_of(lu[p * n + k]) > 0)) {
+      return false;
+    }
+    perm[k] = p;
+    if (p != k) {
+      for (std::size_t j = 0; j < n; ++j) {
+        Work tmp = lu[k * n + j];
+        lu[k * n + j] = lu[p * n + j];
+        lu[p * n + j] = tmp;
+      }
+    }
+    for (std::size_t i = k + 1; i < n; ++i) {
+      Work l = lu[i * n + k] / lu[k * n + k];
+      lu[i * n + k] = l;
+      for (std::size_t j = k + 1; j < n; ++j) {
+        lu[i * n + j] -= l * lu[k * n + j];
+      }
+    }
+  }
+  return true;
+}
+
+/// Solves `lu * x = rhs` in place, where `lu` and `perm` come from `lu_factorize`.
+template <typename Work>
+void lu_substitute(Work const* lu, std::size_t const* perm, Work* rhs, std::size_t n) {
+  for (std::size_t k = 0; k < n; ++k) {
+    if (perm[k] != k) {
+      Work tmp = rhs[k];
+      rhs[k] = rhs[perm[k]];
+      rhs[perm[k]] = tmp;
+    }
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < i; ++j) {
+      rhs[i] -= lu[i * n + j] * rhs[j];
+    }
+  }
+  for (std::size_t i = n; i-- > 0;) {
+    for (std::size_t j = i + 1; j < n; ++j) {
+      rhs[i] -= lu[i * n + j] * rhs[j];
+    }
+    rhs[i] /= lu[i * n + i];
+  }
+}
+
+/// Cholesky factorization `l * l^T` of a row major `n` by `n` matrix, reading and writing its
+/// lower triangle in place.
+/// \return `false` if the matrix is not numerically positive definite.
+template <typename Work> auto cholesky_factorize(Work* l, std::size_t n) -> bool {
+  for (std::size_t j = 0; j < n; ++j) {
+    Work d = l[j * n + j];
+    for (std::size_t k = 0; k < j; ++k) {
+      d -= l[j * n + k] * l[j * n + k];
+    }
+    if (not(d > 0)) {
+      return false;
+    }
+    d = sqrt_of(d);
+    l[j * n + j] = d;
+    for (std::size_t i = j + 1; i < n; ++i) {
+      Work s = l[i * n + j];
+      for (std::size_t k = 0; k < j; ++k) {
+        s -= l[i * n + k] * l[j * n + k];
+      }
+      l[i * n + j] = s / d;
+    }
+  }
+  return true;
+}
+
+/// Solves `l * l^T * x = rhs` in place, where `l` comes from `cholesky_factorize`.
+template <typename Work> void cholesky_substitute(Work const* l, Work* rhs, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < i; ++j) {
+      rhs[i] -= l[i * n + j] * rhs[j];
+    }
+    rhs[i] /= l[i * n + i];
+  }
+  for (std::size_t i = n; i-- > 0;) {
+    for (std::size_t j = i + 1; j < n; ++j) {
+      rhs[i] -= l[j * n + i] * rhs[j];
+    }
+    rhs[i] /= l[i * n + i];
+  }
+}
+
+template <precision_t P> auto max_abs(span<mp_float_t<P> const> xs) noexcept -> mp_float_t<P> {
+  mp_float_t<P> out = 0;
+  for (auto const& x : xs) {
+    if (mpfr::fabs(x) > out) {
+      out = mpfr::fabs(x);
+    }
+  }
+  return out;
+}
+
+/// Writes `b - a * x` to `r`, with each entry correctly rounded.
+template <precision_t P>
+void residual(
+    span<mp_float_t<P>> r,
+    matrix_view<mp_float_t<P> const> a,
+    span<mp_float_t<P> const> x,
+    span<mp_float_t<P> const> b,
+    std::size_t n_threads) {
+  using T = mp_float_t<P>;
+  std::size_t const n = x.size();
+  constexpr std::size_t rows_per_task = 16;
+
+  // the residual of a row is the dot product of [a_i, b_i] and [-x, 1]
+  T const one = 1;
+  std::vector<T> neg_x(n);
+  std::vector<mpfr_cref_t> y_refs(n + 1);
+  std::vector<mpfr_ptr> y_ptrs(n + 1);
+  for (std::size_t j = 0; j < n; ++j) {
+    neg_x[j] = -x[j];
+    y_refs[j] = impl_access::mpfr_cref(neg_x[j]);
+    y_ptrs[j] = &y_refs[j].m;
+  }
+  y_refs[n] = impl_access::mpfr_cref(one);
+  y_ptrs[n] = &y_refs[n].m;
+
+  auto task = [&](std::size_t t) {
+    std::vector<mpfr_cref_t> x_refs(n + 1);
+    std::vector<mpfr_ptr> x_ptrs(n + 1);
+    std::size_t const end = min(n, (t + 1) * rows_per_task);
+    for (std::size_t i = t * rows_per_task; i < end; ++i) {
+      for (std::size_t j = 0; j < n; ++j) {
+        x_refs[j] = impl_access::mpfr_cref(a(i, j));
+        x_ptrs[j] = &x_refs[j].m;
+      }
+      x_refs[n] = impl_access::mpfr_cref(b[i]);
+      x_ptrs[n] = &x_refs[n].m;
+      mpfr_raii_setter_t&& g = impl_access::mpfr_setter(r[i]);
+      _::dot_refs(g, x_ptrs.data(), y_ptrs.data(), n + 1);
+    }
+  };
+  thread_pool::global().for_each_index((n + rows_per_task - 1) / rows_per_task, n_threads, task);
+}
+
+/// Iterative refinement of the solution of `a * x = b`, starting from zero, where
+/// `solve_work(rhs)` solves the system in place in the working precision.\n
+/// Residuals are scaled by a power of two before being rounded to the working precision, so that
+/// they stay within its exponent range.
+template <typename Work, precision_t P, typename Solve_Work>
+auto refine(
+    span<mp_float_t<P>> x,
+    matrix_view<mp_float_t<P> const> a,
+    span<mp_float_t<P> const> b,
+    Solve_Work& solve_work,
+    std::size_t n_threads) -> solve_result_t {
+  using T = mp_float_t<P>;
+  std::size_t const n = x.size();
+  T const eps_target = mpfr::ldexp(T{1}, 1 - static_cast<long>(static_cast<mpfr_prec_t>(P)));
+
+  std::vector<T> r(n);
+  std::vector<Work> w(n);
+  T d_prev_max;
+  for (std::size_t j = 0; j < n; ++j) {
+    x[j] = 0;
+  }
+
+  for (std::size_t iter = 0;; ++iter) {
+    _::residual<P>(r, a, x, b, n_threads);
+    T r_max = _::max_abs<P>(r);
+    if (r_max == 0) {
+      return {true, iter};
+    }
+
+    mpfr_prec_t scale = 0;
+    (void)mpfr::frexp(r_max, &scale);
+    for (std::size_t i = 0; i < n; ++i) {
+      w[i] = work_traits<Work>::from(mpfr::ldexp(r[i], -scale));
+    }
+    solve_work(w.data());
+
+    for (std::size_t i = 0; i < n; ++i) {
+      r[i] = mpfr::ldexp(T{w[i]}, scale);
+    }
+    T d_max = _::max_abs<P>(r);
+    if (not mpfr::isfinite(d_max)) {
+      return {false, iter};
+    }
+
+    T x_max = _::max_abs<P>(x);
+    // once the corrections stop shrinking, we are at the accuracy floor of the residual. the
+    // solve only succeeded if that floor is below the target precision
+    if (iter > 0 and d_max > d_prev_max / 2) {
+      return {d_max <= eps_target * x_max, iter};
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+      x[i] += r[i];
+    }
+    x_max = _::max_abs<P>(x);
+    if (d_max <= eps_target * x_max) {
+      return {true, iter + 1};
+    }
+    d_prev_max = d_max;
+  }
+}
+
+template <precision_t P>
+void check_solve_dims(
+    span<mp_float_t<P>> x, matrix_view<mp_float_t<P> const> a, span<mp_float_t<P> const> b) {
+  if (a.rows() != a.cols() or x.size() != a.rows() or b.size() != a.rows()) {
+    ::mpfr::_::crash_with_message("solve: incompatible matrix dimensions");
+  }
+}
+
+} // namespace _
+
+/// Solves `a * x = b` using an LU factorization with partial pivoting computed in the working
+/// precision `Work` (`double` or a lower precision `mp_float_t`), followed by iterative
+/// refinement. The residuals are computed in the target precision with correctly rounded dot
+/// products, and the corrections are applied until they are below the target precision.\n
+/// This converges if the condition number of `a` is well below the inverse of the machine
+/// epsilon of `Work`.
+///
+/// \return Whether the refinement converged, and the number of corrections. On failure, `x`
+/// holds the last iterate.
+///
+/// @param[out] x         Solution, with as many elements as `a` has rows.
+/// @param[in] a          Square matrix.
+/// @param[in] b          Right hand side, with as many elements as `a` has rows.
+/// @param[in] n_threads  Maximum number of threads used for the residuals, including the caller.
+/// Zero means all the threads of the pool.
+template <typename Work = double, precision_t P>
+auto lu_solve(
+    span<mp_float_t<P>> x,
+    matrix_view<mp_float_t<P> const> a,
+    span<mp_float_t<P> const> b,
+    std::size_t n_threads = 0) -> solve_result_t {
+  _::check_solve_dims(x, a, b);
+  std::size_t const n = a.rows();
+
+  std::vector<Work> lu(n * n);
+  std::vector<std::size_t> perm(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      lu[i * n + j] = _::work_traits<Work>::from(a(i, j));
+    }
+  }
+  if (not _::lu_factorize(lu.data(), perm.data(), n)) {
+    return {false, 0};
+  }
+  auto solve_work = [&](Work* rhs) { _::lu_substitute(lu.data(), perm.data(), rhs, n); };
+  return _::refine<Work>(x, a, b, solve_work, n_threads);
+}
+
+/// Solves `a * x = b` for a symmetric positive definite `a`, using a Cholesky factorization
+/// computed in the working precision `Work`, followed by iterative refinement as in `lu_solve`.
+/// Only the lower triangle of `a` is read by the factorization.
+///
+/// \return Whether the refinement converged, and the number of corrections. The solve fails if
+/// `a` is not numerically positive definite in the working precision.
+///
+/// @param[out] x         Solution, with as many elements as `a` has rows.
+/// @param[in] a          Symmetric positive definite matrix.
+/// @param[in] b          Right hand side, with as many elements as `a` has rows.
+/// @param[in] n_threads  Maximum number of threads used for the residuals, including the caller.
+/// Zero means all the threads of the pool.
+template <typename Work = double, precision_t P>
+auto cholesky_solve(
+    span<mp_float_t<P>> x,
+    matrix_view<mp_float_t<P> const> a,
+    span<mp_float_t<P> const> b,
+    std::size_t n_threads = 0) -> solve_result_t {
+  _::check_solve_dims(x, a, b);
+  std::size_t const n = a.rows();
+
+  std::vector<Work> l(n * n);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j <= i; ++j) {
+      l[i * n + j] = _::work_traits<Work>::from(a(i, j));
+    }
+  }
+  if (not _::cholesky_factorize(l.data(), n)) {
+    return {false, 0};
+  }
+  auto solve_work = [&](Work* rhs) { _::cholesky_substitute(l.data(), rhs, n); };
+  return _::refine<Work>(x, a, b, solve_work, n_threads);
+}
+
+} // namespace linalg
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard LINALG_HPP_M6YV2CTE */
@@ -0,0 +1,271 @@
+#ifndef MAPPED_ARRAY_HPP_J5NC2TRE
+#define MAPPED_ARRAY_HPP_J5NC2TRE
+
+#include "mpfr/mp_float.hpp"
+#include "mpfr/span.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <system_error>
+
+#ifndef MPFR_CXX_HAS_MMAP
+#if defined(__unix__) or defined(__APPLE__)
+#define MPFR_CXX_HAS_MMAP 1
+#else
+#define MPFR_CXX_HAS_MMAP 0
+#endif
+#endif
+
+#if MPFR_CXX_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mpfr {
+namespace _ {
+
+// an array file is a header, padded to `array_file_header_size` bytes, followed by the records,
+// which are copies of the `mp_float_t<P>` objects. the header records everything the layout of
+// the records depends on, and files written on a machine with a different layout are rejected.
+
+constexpr char array_file_magic[8] = {'M', 'P', 'F', 'R', 'C', 'X', 'X', 'A'};
+constexpr std::uint32_t array_file_version = 1;
+constexpr std::uint64_t array_file_byte_order = 0x0102030405060708U;
+constexpr std::size_t array_file_header_size = 64;
+
+struct array_file_header_t {
+  char magic[8];
+  std::uint64_t byte_order;
+  std::uint32_t version;
+  std::uint32_t limb_size;
+  std::uint64_t precision;
+  std::uint64_t record_size;
+  std::uint64_t count;
+};
+static_assert(sizeof(array_file_header_t) <= array_file_header_size, "");
+
+template <precision_t P> auto make_array_file_header(std::uint64_t count) -> array_file_header_t {
+  array_file_header_t h{};
+  std::memcpy(h.magic, array_file_magic, sizeof(h.magic));
+  h.byte_order = array_file_byte_order;
+  h.version = array_file_version;
+  h.limb_size = sizeof(mp_limb_t);
+  h.precision = static_cast<std::uint64_t>(P);
+  h.record_size = sizeof(mp_float_t<P>);
+  h.count = count;
+  return h;
+}
+
+/// \return The number of records of the file whose first `size` bytes are at `data`, or
+/// `std::errc::invalid_argument` if it is not an array file of numbers of precision `P` with the
+/// layout of this machine.
+template <precision_t P>
+auto check_array_file(void const* data, std::size_t size, std::uint64_t& count) -> std::errc {
+  if (size < array_file_header_size) {
+    return std::errc::invalid_argument;
+  }
+  array_file_header_t h;
+  std::memcpy(&h, data, sizeof(h));
+  array_file_header_t const expected = _::make_array_file_header<P>(h.count);
+  if (std::memcmp(&h, &expected, sizeof(h)) != 0 or
+      h.count > (size - array_file_header_size) / sizeof(mp_float_t<P>)) {
+    return std::errc::invalid_argument;
+  }
+  count = h.count;
+  return std::errc{};
+}
+
+/// \return Whether `x` is a valid representation of an `mp_float_t<P>`, such that MPFR never
+/// reads outside of its mantissa: a zero, an infinity or a NaN, or a normalized mantissa whose
+/// recorded precision is its actual one, with an exponent in the range supported by MPFR.
+template <precision_t P> auto is_valid_array_record(mp_float_t<P> const& x) -> bool {
+  constexpr mpfr_prec_t bits_limb = sizeof(mp_limb_t) * CHAR_BIT;
+  constexpr auto prec = static_cast<mpfr_prec_t>(P);
+  auto const& mantissa = impl_access::mantissa_const(x);
+  mpfr_exp_t const exp = impl_access::exp_const(x);
+  mpfr_prec_t const actual_prec = prec_abs(impl_access::actual_prec_sign_const(x));
+  typename remove_pointer<mpfr_ptr>::type const view{
+      prec,
+      1,
+      exp,
+      const_cast<mp_limb_t*>(mantissa), // NOLINT(cppcoreguidelines-pro-type-const-cast)
+  };
+  if (actual_prec == 0) {
+    return exp == 0 or mpfr_inf_p(&view) or mpfr_nan_p(&view);
+  }
+  constexpr std::size_t n_limbs = sizeof(mantissa) / sizeof(mp_limb_t);
+  return actual_prec <= prec and exp >= mpfr_get_emin_min() and
+         exp <= mpfr_get_emax_max() and (mantissa[n_limbs - 1] >> (bits_limb - 1)) == 1 and
+         _::compute_actual_prec(&view) == actual_prec;
+}
+
+inline auto last_errc() -> std::errc { return static_cast<std::errc>(errno); }
+
+} // namespace _
+
+/// Read-only view of an array file written by `write_array_file`.\n
+/// Since the records of the file are copies of the in-memory objects, the view refers to the
+/// contents of the file directly. Where available, the file is mapped to memory with `mmap`, so
+/// that opening it takes the same time regardless of its size, and its pages are only read
+/// when they are first accessed. Otherwise, the file is read to memory when it is opened.\n
+/// The records are used as they are, so a corrupted file can make the functions reading them
+/// access memory out of bounds, unless it is opened with `validate` set.
+template <precision_t P> struct mapped_array {
+  mapped_array() noexcept = default;
+  mapped_array(mapped_array const&) = delete;
+  auto operator=(mapped_array const&) -> mapped_array& = delete;
+  mapped_array(mapped_array&& other) noexcept
+      : m_data{other.m_data}, m_size{other.m_size}, m_count{other.m_count} {
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_count = 0;
+  }
+  auto operator=(mapped_array&& other) noexcept -> mapped_array& {
+    if (this != &other) {
+      close();
+      m_data = other.m_data;
+      m_size = other.m_size;
+      m_count = other.m_count;
+      other.m_data = nullptr;
+      other.m_size = 0;
+      other.m_count = 0;
+    }
+    return *this;
+  }
+  ~mapped_array() { close(); }
+
+  /// Opens the array file at `path`, after closing the current one.
+  ///
+  /// \return `std::errc{}` on success, the error of the system if the file could not be read, or
+  /// `std::errc::invalid_argument` if it is not an array file of numbers of precision `P` written
+  /// on a machine with the same layout, in which case the array is left empty.
+  ///
+  /// @param[in] path     File to open.
+  /// @param[in] validate Whether to check every record, which reads the whole file, so that files
+  /// that are not trusted are rejected with `std::errc::invalid_argument` if they are corrupted.
+  auto open(char const* path, bool validate = false) noexcept -> std::errc {
+    close();
+#if MPFR_CXX_HAS_MMAP
+    int fd = ::open(path, O_RDONLY); // NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (fd < 0) {
+      return _::last_errc();
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      std::errc ec = _::last_errc();
+      ::close(fd);
+      return ec;
+    }
+    auto const size = static_cast<std::size_t>(st.st_size);
+    void* data = size == 0 ? MAP_FAILED : ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    std::errc ec = size == 0 ? std::errc::invalid_argument : _::last_errc();
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      return ec;
+    }
+#else
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+      return _::last_errc();
+    }
+    std::size_t size = 0;
+    void* data = nullptr;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+      long end = std::ftell(file);
+      size = end > 0 ? static_cast<std::size_t>(end) : 0;
+      data = size == 0 ? nullptr : std::malloc(size);
+    }
+    bool const ok = data != nullptr and std::fseek(file, 0, SEEK_SET) == 0 and
+                    std::fread(data, 1, size, file) == size;
+    std::fclose(file);
+    if (not ok) {
+      std::free(data);
+      return std::errc::io_error;
+    }
+#endif
+    m_data = data;
+    m_size = size;
+    std::errc check = _::check_array_file<P>(m_data, m_size, m_count);
+    if (check == std::errc{} and validate) {
+      for (mp_float_t<P> const& x : view()) {
+        if (not _::is_valid_array_record(x)) {
+          check = std::errc::invalid_argument;
+          break;
+        }
+      }
+    }
+    if (check != std::errc{}) {
+      close();
+    }
+    return check;
+  }
+
+  /// Releases the file. The array is then empty.
+  void close() noexcept {
+    if (m_data != nullptr) {
+#if MPFR_CXX_HAS_MMAP
+      ::munmap(m_data, m_size);
+#else
+      std::free(m_data);
+#endif
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_count = 0;
+  }
+
+  /// \return Whether a file is open.
+  [[MPFR_CXX_NODISCARD]] auto is_open() const noexcept -> bool { return m_data != nullptr; }
+  /// \return The number of elements.
+  [[MPFR_CXX_NODISCARD]] auto size() const noexcept -> std::size_t {
+    return static_cast<std::size_t>(m_count);
+  }
+  /// \return A view of the elements, valid until the file is closed.
+  [[MPFR_CXX_NODISCARD]] auto view() const noexcept -> span<mp_float_t<P> const> {
+    if (m_data == nullptr) {
+      return {};
+    }
+    void const* records = static_cast<unsigned char const*>(m_data) + _::array_file_header_size;
+    return {static_cast<mp_float_t<P> const*>(records), static_cast<std::size_t>(m_count)};
+  }
+
+private:
+  void* m_data = nullptr;
+  std::size_t m_size = 0;
+  std::uint64_t m_count = 0;
+};
+
+/// Writes the elements of `xs` to an array file at `path`, that can be opened with
+/// `mapped_array<P>` on machines with the same layout of `mp_float_t<P>`.
+///
+/// \return `std::errc{}` on success, or the error of the system otherwise.
+///
+/// @param[in] path File to write. Its previous contents are discarded.
+/// @param[in] xs   Values to write.
+template <precision_t P>
+auto write_array_file(char const* path, span<mp_float_t<P> const> xs) noexcept -> std::errc {
+  std::FILE* file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    return _::last_errc();
+  }
+  unsigned char header[_::array_file_header_size] = {};
+  _::array_file_header_t const h = _::make_array_file_header<P>(xs.size());
+  std::memcpy(header, &h, sizeof(h));
+
+  bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header) and
+            std::fwrite(xs.data(), sizeof(mp_float_t<P>), xs.size(), file) == xs.size();
+  ok = (std::fclose(file) == 0) and ok;
+  return ok ? std::errc{} : std::errc::io_error;
+}
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard MAPPED_ARRAY_HPP_J5NC2TRE */
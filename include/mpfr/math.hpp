@@ -272,6 +272,48 @@ sfinae_common_return_type pow(U const& base, V const& exponent) noexcept {
   return _::apply_binary_op(base, exponent, mpfr_pow);
 }
 
+/// \return The base to the power of the integral exponent.\n
+/// Powers of two are raised by scaling their exponent, without calling into MPFR.
+template <precision_t P, typename I>
+auto pow(mp_float_t<P> const& base, I exponent) noexcept -> _::enable_if_t<
+    std::numeric_limits<I>::is_integer and _::is_arithmetic<I>::value and
+        sizeof(I) <= sizeof(long),
+    mp_float_t<P>> {
+  bool const neg = std::numeric_limits<I>::is_signed and exponent < 0;
+  auto const n_abs = neg ? 0UL - static_cast<unsigned long>(exponent)
+                         : static_cast<unsigned long>(exponent);
+
+  if (_::prec_abs(_::impl_access::actual_prec_sign_const(base)) == 1) {
+    // |base| = 2^e, with e bounded by the exponent range, so the product only overflows when
+    // the result does
+    long const e = static_cast<long>(_::impl_access::exp_const(base)) - 1;
+    long const e_abs = e < 0 ? -e : e;
+    long const limit = static_cast<long>(_::get_emax() - _::get_emin()) + 1;
+    if (e_abs == 0 or n_abs <= static_cast<unsigned long>(limit / e_abs)) {
+      long const out_exp = ((e < 0) != neg ? -1 : 1) * e_abs * static_cast<long>(n_abs) + 1;
+      if (out_exp >= _::get_emin() and out_exp <= _::get_emax()) {
+        mp_float_t<P> out = base;
+        _::impl_access::exp_mut(out) = out_exp;
+        _::impl_access::actual_prec_sign_mut(out) = _::prec_negate_if(
+            1, _::impl_access::actual_prec_sign_const(base) < 0 and (n_abs % 2) == 1);
+        return out;
+      }
+    }
+  }
+
+  mp_float_t<P> out;
+  {
+    _::mpfr_cref_t x = _::impl_access::mpfr_cref(base);
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
+    if (std::numeric_limits<I>::is_signed) {
+      mpfr_pow_si(&g.m, &x.m, static_cast<long>(exponent), _::get_rnd());
+    } else {
+      mpfr_pow_ui(&g.m, &x.m, static_cast<unsigned long>(exponent), _::get_rnd());
+    }
+  }
+  return out;
+}
+
 /// Pair of the sine and cosine.
 template <precision_t P> struct sin_cos_result_t {
   mp_float_t<P> sin;
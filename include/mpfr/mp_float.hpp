@@ -2,6 +2,7 @@
 #define MP_FLOAT_HPP_KC35IAEF
 
 #include "mpfr/math.hpp"
+#include "mpfr/detail/charconv.hpp"
 #include "mpfr/detail/prologue.hpp"
 
 namespace mpfr {
@@ -51,6 +52,14 @@ template <precision_t Precision> struct mp_float_t {
     _::mpfr_cref_t m = _::impl_access::mpfr_cref(*this);
     return mpfr_get_uj(&m.m, _::get_rnd());
   }
+#if MPFR_CXX_USE_FLOAT128 == 1
+  /// Exact when the number is representable in binary128, otherwise rounded with the current
+  /// rounding mode, including overflow and gradual underflow.
+  [[MPFR_CXX_NODISCARD]] explicit operator __float128() const noexcept {
+    _::mpfr_cref_t m = _::impl_access::mpfr_cref(*this);
+    return _::float128::from_mpfr(&m.m, _::get_rnd());
+  }
+#endif
   /** @name Arithmetic operators
    */
   ///@{
@@ -128,6 +137,15 @@ sfinae_common_return_type operator*(U const& a, V const& b) noexcept {
   typename _::into_mp_float_lossless<U>::type const& a_{a};
   typename _::into_mp_float_lossless<V>::type const& b_{b};
 
+#if MPFR_CXX_USE_FLOAT128 == 1
+  {
+    typename _::common_type<U, V>::type out;
+    if (_::float128::try_binary_op(out, a_, b_, _::float128::op_e::mul)) {
+      return out;
+    }
+  }
+#endif
+
   if ((a == 0 and mpfr::isfinite(b_)) or (b == 0 and mpfr::isfinite(a_))) {
     return 0;
   }
@@ -0,0 +1,555 @@
+#ifndef MULTI_DOUBLE_HPP_Q8ZR4MWD
+#define MULTI_DOUBLE_HPP_Q8ZR4MWD
+
+#include "mpfr/mp_float.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <cmath>
+
+namespace mpfr {
+namespace _ {
+
+// Error free transformations. They rely on the rounding to nearest of IEEE doubles, and break
+// with value changing optimizations such as -ffast-math.
+
+/// \return `a + b` rounded, and stores its rounding error in `err`.
+inline auto two_sum(double a, double b, double& err) noexcept -> double {
+  double const s = a + b;
+  double const bb = s - a;
+  err = (a - (s - bb)) + (b - bb);
+  return s;
+}
+
+/// Same as `two_sum`, when `|a| >= |b|` or `a` is zero.
+inline auto quick_two_sum(double a, double b, double& err) noexcept -> double {
+  double const s = a + b;
+  err = b - (s - a);
+  return s;
+}
+
+/// \return `a * b` rounded, and stores its rounding error in `err`.
+inline auto two_prod(double a, double b, double& err) noexcept -> double {
+  double const p = a * b;
+  err = std::fma(a, b, -p);
+  return p;
+}
+
+/// Replaces `a`, `b`, `c` by their sum and the errors of the partial sums.
+inline void three_sum(double& a, double& b, double& c) noexcept {
+  double t2;
+  double t3;
+  double const t1 = _::two_sum(a, b, t2);
+  a = _::two_sum(c, t1, t3);
+  b = _::two_sum(t2, t3, c);
+}
+
+/// Same as `three_sum`, when only the sum and the first error are needed.
+inline void three_sum2(double& a, double& b, double c) noexcept {
+  double t2;
+  double t3;
+  double const t1 = _::two_sum(a, b, t2);
+  a = _::two_sum(c, t1, t3);
+  b = t2 + t3;
+}
+
+/// Normalizes `c0 + c1 + c2 + c3 + c4` into four non overlapping components, stored in `c0`,
+/// ..., `c3`.
+inline void renorm(double& c0, double& c1, double& c2, double& c3, double c4) noexcept {
+  if (std::isinf(c0)) {
+    return;
+  }
+  double s0 = _::quick_two_sum(c3, c4, c4);
+  s0 = _::quick_two_sum(c2, s0, c3);
+  s0 = _::quick_two_sum(c1, s0, c2);
+  c0 = _::quick_two_sum(c0, s0, c1);
+
+  // the components that become zero are skipped, so that the next ones move up
+  s0 = c0;
+  double s1 = c1;
+  double s2 = 0.0;
+  double s3 = 0.0;
+  if (s1 != 0.0) {
+    s1 = _::quick_two_sum(s1, c2, s2);
+    if (s2 != 0.0) {
+      s2 = _::quick_two_sum(s2, c3, s3);
+      if (s3 != 0.0) {
+        s3 += c4;
+      } else {
+        s2 = _::quick_two_sum(s2, c4, s3);
+      }
+    } else {
+      s1 = _::quick_two_sum(s1, c3, s2);
+      if (s2 != 0.0) {
+        s2 = _::quick_two_sum(s2, c4, s3);
+      } else {
+        s1 = _::quick_two_sum(s1, c4, s2);
+      }
+    }
+  } else {
+    s0 = _::quick_two_sum(s0, c2, s1);
+    if (s1 != 0.0) {
+      s1 = _::quick_two_sum(s1, c3, s2);
+      if (s2 != 0.0) {
+        s2 = _::quick_two_sum(s2, c4, s3);
+      } else {
+        s1 = _::quick_two_sum(s1, c4, s2);
+      }
+    } else {
+      s0 = _::quick_two_sum(s0, c3, s1);
+      if (s1 != 0.0) {
+        s1 = _::quick_two_sum(s1, c4, s2);
+      } else {
+        s0 = _::quick_two_sum(s0, c4, s1);
+      }
+    }
+  }
+  c0 = s0;
+  c1 = s1;
+  c2 = s2;
+  c3 = s3;
+}
+
+/// \return Sum of `b`, `c`, added to the accumulator `(a, b)`. If the sum does not spill out of
+/// the accumulator, returns zero and keeps the sum in the accumulator.
+inline auto quick_three_accum(double& a, double& b, double c) noexcept -> double {
+  double s = _::two_sum(b, c, b);
+  s = _::two_sum(a, s, a);
+  if (a != 0.0 and b != 0.0) {
+    return s;
+  }
+  if (b == 0.0) {
+    b = a;
+  }
+  a = s;
+  return 0.0;
+}
+
+/// Sum of two quad-doubles, where the components of the same rank are added together. The error
+/// is relative to `|a| + |b|` rather than `|a + b|`, which is enough for the remainders of a
+/// division, where the cancellation is expected.
+inline void qd_sloppy_add(double* s, double const* a, double const* b) noexcept {
+  double t[4];
+  for (std::size_t i = 0; i < 4; ++i) {
+    s[i] = _::two_sum(a[i], b[i], t[i]);
+  }
+  s[1] = _::two_sum(s[1], t[0], t[0]);
+  _::three_sum(s[2], t[0], t[1]);
+  _::three_sum2(s[3], t[0], t[2]);
+  _::renorm(s[0], s[1], s[2], s[3], t[0] + t[1] + t[3]);
+}
+
+/// Sets `out` to the sum of the `n` components `c`, correctly rounded in the current rounding
+/// mode.
+inline void multi_double_to_mpfr(mpfr_ptr out, double const* c, std::size_t n) {
+  mp_float_t<digits2{53}> components[4];
+  mpfr_cref_t refs[4];
+  mpfr_ptr ptrs[4];
+  for (std::size_t i = 0; i < n; ++i) {
+    components[i] = c[i];
+    refs[i] = impl_access::mpfr_cref(components[i]);
+    ptrs[i] = &refs[i].m;
+  }
+  mpfr_sum(out, ptrs, n, _::get_rnd());
+}
+
+/// Splits `x` into `n` components, each the nearest double to what remains of `x`.
+template <precision_t P> void multi_double_from_mpfr(double* c, std::size_t n, mp_float_t<P> x) {
+  for (std::size_t i = 0; i < n; ++i) {
+    _::mpfr_cref_t const m = _::impl_access::mpfr_cref(x);
+    c[i] = mpfr_get_d(&m.m, MPFR_RNDN);
+    // exact, since c[i] is a multiple of the last bit of x, and at most half an ulp away from it
+    x -= mp_float_t<P>{c[i]};
+  }
+}
+
+} // namespace _
+
+/// Double-double number: the unevaluated sum of two non overlapping doubles, which gives a
+/// precision of 106 bits with the exponent range of `double`.\n
+/// The operations use error free transformations on doubles instead of MPFR, and are several
+/// times faster than `mp_float_t` at the same precision. They are branch free, so that loops
+/// over arrays of `dd_t` can be vectorized by the compiler, and the products are fastest when
+/// `std::fma` is a hardware instruction.\n
+/// The results are not correctly rounded. With `u = 2^-53`, the relative error of additions and
+/// subtractions is at most `3u^2`, and that of multiplications `5u^2` (Joldes, Muller and
+/// Popescu, 2017). Divisions and square roots are accurate to a few `u^2`.\n
+/// Only finite values whose magnitude is between `2^-968` and `2^1023` are supported. The
+/// functions rely on the rounding to nearest of IEEE doubles, and must not be compiled with
+/// `-ffast-math`.
+struct dd_t {
+  /// Leading component.
+  double hi;
+  /// Trailing component, at most half an ulp of `hi`.
+  double lo;
+
+  /// Zero.
+  dd_t() noexcept : hi{0.0}, lo{0.0} {}
+  /// \n
+  dd_t(double x) noexcept : hi{x}, lo{0.0} {} // NOLINT
+  /// Sum of `hi` and `lo`, which must be normalized, with `lo` at most half an ulp of `hi`.
+  dd_t(double hi_, double lo_) noexcept : hi{hi_}, lo{lo_} {}
+
+  /// Nearest double-double to `x`, with each component rounded to nearest.
+  template <precision_t P> explicit dd_t(mp_float_t<P> const& x) noexcept {
+    double c[2];
+    _::multi_double_from_mpfr(c, 2, x);
+    hi = c[0];
+    lo = c[1];
+  }
+
+  /// \return The value, rounded in the current rounding mode.
+  template <precision_t P> explicit operator mp_float_t<P>() const noexcept {
+    mp_float_t<P> out;
+    {
+      double const c[] = {hi, lo};
+      _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
+      _::multi_double_to_mpfr(&g.m, c, 2);
+    }
+    return out;
+  }
+
+  /// \n
+  explicit operator double() const noexcept { return hi + lo; }
+
+  /** @name Arithmetic operators
+   */
+  ///@{
+  /// \n
+  [[MPFR_CXX_NODISCARD]] auto operator+() const noexcept -> dd_t { return *this; }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] auto operator-() const noexcept -> dd_t { return {-hi, -lo}; }
+
+  /// \n
+  auto operator+=(dd_t const& b) noexcept -> dd_t& { return *this = *this + b; }
+  /// \n
+  auto operator-=(dd_t const& b) noexcept -> dd_t& { return *this = *this - b; }
+  /// \n
+  auto operator*=(dd_t const& b) noexcept -> dd_t& { return *this = *this * b; }
+  /// \n
+  auto operator/=(dd_t const& b) noexcept -> dd_t& { return *this = *this / b; }
+
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator+(dd_t const& a, dd_t const& b) noexcept -> dd_t {
+    double s_err;
+    double t_err;
+    double s = _::two_sum(a.hi, b.hi, s_err);
+    double const t = _::two_sum(a.lo, b.lo, t_err);
+    s_err += t;
+    s = _::quick_two_sum(s, s_err, s_err);
+    s_err += t_err;
+    s = _::quick_two_sum(s, s_err, s_err);
+    return {s, s_err};
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator-(dd_t const& a, dd_t const& b) noexcept -> dd_t {
+    return a + -b;
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator*(dd_t const& a, dd_t const& b) noexcept -> dd_t {
+    double p_err;
+    double const p = _::two_prod(a.hi, b.hi, p_err);
+    double const t = std::fma(a.lo, b.hi, std::fma(a.hi, b.lo, a.lo * b.lo));
+    p_err += t;
+    double err;
+    double const s = _::quick_two_sum(p, p_err, err);
+    return {s, err};
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator/(dd_t const& a, dd_t const& b) noexcept -> dd_t {
+    double const q1 = a.hi / b.hi;
+    dd_t r = a - b * q1;
+    double const q2 = r.hi / b.hi;
+    r -= b * q2;
+    double const q3 = r.hi / b.hi;
+    double err;
+    double const q = _::quick_two_sum(q1, q2, err);
+    return dd_t{q, err} + q3;
+  }
+  ///@}
+
+  /** @name Comparison operators
+   */
+  ///@{
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator==(dd_t const& a, dd_t const& b) noexcept -> bool {
+    return a.hi == b.hi and a.lo == b.lo;
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator!=(dd_t const& a, dd_t const& b) noexcept -> bool {
+    return not(a == b);
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator<(dd_t const& a, dd_t const& b) noexcept -> bool {
+    return a.hi < b.hi or (a.hi == b.hi and a.lo < b.lo);
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator>(dd_t const& a, dd_t const& b) noexcept -> bool {
+    return b < a;
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator<=(dd_t const& a, dd_t const& b) noexcept -> bool {
+    return a < b or a == b;
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator>=(dd_t const& a, dd_t const& b) noexcept -> bool {
+    return b <= a;
+  }
+  ///@}
+};
+
+/// \return Absolute value of the argument.
+inline auto abs(dd_t const& x) noexcept -> dd_t { return x.hi < 0.0 ? -x : x; }
+
+/// \return Square root of the argument, which must be non negative.
+inline auto sqrt(dd_t const& x) noexcept -> dd_t {
+  if (x.hi <= 0.0) {
+    return dd_t{std::sqrt(x.hi)};
+  }
+  // one Newton step from the double approximation, as proposed by Karp and Markstein
+  double const inv = 1.0 / std::sqrt(x.hi);
+  double const root = x.hi * inv;
+  double sqr_err;
+  double const sqr = _::two_prod(root, root, sqr_err);
+  double const correction = ((x - dd_t{sqr, sqr_err}).hi) * (inv * 0.5);
+  double err;
+  double const s = _::two_sum(root, correction, err);
+  return {s, err};
+}
+
+/// Quad-double number: the unevaluated sum of four non overlapping doubles, which gives a
+/// precision of 212 bits with the exponent range of `double`.\n
+/// The operations use error free transformations on doubles instead of MPFR, following the QD
+/// library of Hida, Li and Bailey. Unlike those of `dd_t`, they branch on the cancellations
+/// that happen while renormalizing. Additions and multiplications are faster than with
+/// `mp_float_t` at the same precision, but divisions, which take four multiplications by a
+/// double and four additions, are not.\n
+/// The results are not correctly rounded. With `u = 2^-53`, the relative error of the
+/// operations is a few `u^4`.\n
+/// Only finite values whose magnitude is between `2^-862` and `2^1023` are supported. The
+/// functions rely on the rounding to nearest of IEEE doubles, and must not be compiled with
+/// `-ffast-math`.
+struct qd_t {
+  /// Components, in decreasing order of magnitude. Each one is at most half an ulp of the
+  /// previous one.
+  double c[4];
+
+  /// Zero.
+  qd_t() noexcept : c{0.0, 0.0, 0.0, 0.0} {}
+  /// \n
+  qd_t(double x) noexcept : c{x, 0.0, 0.0, 0.0} {} // NOLINT
+  /// \n
+  qd_t(dd_t const& x) noexcept : c{x.hi, x.lo, 0.0, 0.0} {} // NOLINT
+  /// Sum of the components, which must be normalized.
+  qd_t(double c0, double c1, double c2, double c3) noexcept : c{c0, c1, c2, c3} {}
+
+  /// Nearest quad-double to `x`, with each component rounded to nearest.
+  template <precision_t P> explicit qd_t(mp_float_t<P> const& x) noexcept {
+    _::multi_double_from_mpfr(c, 4, x);
+  }
+
+  /// \return The value, rounded in the current rounding mode.
+  template <precision_t P> explicit operator mp_float_t<P>() const noexcept {
+    mp_float_t<P> out;
+    {
+      _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
+      _::multi_double_to_mpfr(&g.m, c, 4);
+    }
+    return out;
+  }
+
+  /// \n
+  explicit operator double() const noexcept { return c[0] + (c[1] + (c[2] + c[3])); }
+
+  /** @name Arithmetic operators
+   */
+  ///@{
+  /// \n
+  [[MPFR_CXX_NODISCARD]] auto operator+() const noexcept -> qd_t { return *this; }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] auto operator-() const noexcept -> qd_t {
+    return {-c[0], -c[1], -c[2], -c[3]};
+  }
+
+  /// \n
+  auto operator+=(qd_t const& b) noexcept -> qd_t& { return *this = *this + b; }
+  /// \n
+  auto operator-=(qd_t const& b) noexcept -> qd_t& { return *this = *this - b; }
+  /// \n
+  auto operator*=(qd_t const& b) noexcept -> qd_t& { return *this = *this * b; }
+  /// \n
+  auto operator/=(qd_t const& b) noexcept -> qd_t& { return *this = *this / b; }
+
+  /// Merges the components of `a` and `b` by decreasing magnitude into an accumulator, which
+  /// keeps the result accurate when they cancel.
+  [[MPFR_CXX_NODISCARD]] friend auto operator+(qd_t const& a, qd_t const& b) noexcept -> qd_t {
+    std::size_t i = 0;
+    std::size_t j = 0;
+    auto next = [&]() -> double {
+      if (i == 4) {
+        return b.c[j++];
+      }
+      if (j == 4 or std::fabs(a.c[i]) > std::fabs(b.c[j])) {
+        return a.c[i++];
+      }
+      return b.c[j++];
+    };
+
+    double x[4] = {0.0, 0.0, 0.0, 0.0};
+    double u = next();
+    double v = next();
+    u = _::quick_two_sum(u, v, v);
+
+    std::size_t k = 0;
+    while (k < 4) {
+      if (i == 4 and j == 4) {
+        x[k] = u;
+        if (k < 3) {
+          x[k + 1] = v;
+        }
+        break;
+      }
+      double const s = _::quick_three_accum(u, v, next());
+      if (s != 0.0) {
+        x[k++] = s;
+      }
+    }
+    for (; i < 4; ++i) {
+      x[3] += a.c[i];
+    }
+    for (; j < 4; ++j) {
+      x[3] += b.c[j];
+    }
+    _::renorm(x[0], x[1], x[2], x[3], 0.0);
+    return {x[0], x[1], x[2], x[3]};
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator-(qd_t const& a, qd_t const& b) noexcept -> qd_t {
+    return a + -b;
+  }
+  /// Computes the products of the components up to the order `u^3` with error free
+  /// transformations, and the terms of order `u^3` with a single rounding.
+  [[MPFR_CXX_NODISCARD]] friend auto operator*(qd_t const& a, qd_t const& b) noexcept -> qd_t {
+    double q0;
+    double q1;
+    double q2;
+    double q3;
+    double q4;
+    double q5;
+    double p0 = _::two_prod(a.c[0], b.c[0], q0);
+    double p1 = _::two_prod(a.c[0], b.c[1], q1);
+    double p2 = _::two_prod(a.c[1], b.c[0], q2);
+    double p3 = _::two_prod(a.c[0], b.c[2], q3);
+    double p4 = _::two_prod(a.c[1], b.c[1], q4);
+    double p5 = _::two_prod(a.c[2], b.c[0], q5);
+
+    _::three_sum(p1, p2, q0);
+    // sum of the terms of order u^2: (p2, q1, q2) + (p3, p4, p5)
+    _::three_sum(p2, q1, q2);
+    _::three_sum(p3, p4, p5);
+    double t0;
+    double t1;
+    double s0 = _::two_sum(p2, p3, t0);
+    double s1 = _::two_sum(q1, p4, t1);
+    double s2 = q2 + p5;
+    s1 = _::two_sum(s1, t0, t0);
+    s2 += t0 + t1;
+
+    s1 += a.c[0] * b.c[3] + a.c[1] * b.c[2] + a.c[2] * b.c[1] + a.c[3] * b.c[0] + q0 + q3 + q4 +
+          q5;
+    _::renorm(p0, p1, s0, s1, s2);
+    return {p0, p1, s0, s1};
+  }
+  /// Product by a double, which needs fewer terms than the product of two quad-doubles.
+  [[MPFR_CXX_NODISCARD]] friend auto operator*(qd_t const& a, double b) noexcept -> qd_t {
+    double q0;
+    double q1;
+    double q2;
+    double p0 = _::two_prod(a.c[0], b, q0);
+    double p1 = _::two_prod(a.c[1], b, q1);
+    double p2 = _::two_prod(a.c[2], b, q2);
+    double const p3 = a.c[3] * b;
+
+    double s2;
+    double s1 = _::two_sum(q0, p1, s2);
+    _::three_sum(s2, q1, p2);
+    _::three_sum2(q1, q2, p3);
+    _::renorm(p0, s1, s2, q1, q2 + p2);
+    return {p0, s1, s2, q1};
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator*(double a, qd_t const& b) noexcept -> qd_t {
+    return b * a;
+  }
+  /// Long division, with one more quotient digit than the number of components.
+  [[MPFR_CXX_NODISCARD]] friend auto operator/(qd_t const& a, qd_t const& b) noexcept -> qd_t {
+    double q[5];
+    qd_t r = a;
+    for (std::size_t i = 0; i < 5; ++i) {
+      q[i] = r.c[0] / b.c[0];
+      if (i < 4) {
+        qd_t const bq = -(b * q[i]);
+        _::qd_sloppy_add(r.c, r.c, bq.c);
+      }
+    }
+    _::renorm(q[0], q[1], q[2], q[3], q[4]);
+    return {q[0], q[1], q[2], q[3]};
+  }
+  ///@}
+
+  /** @name Comparison operators
+   */
+  ///@{
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator==(qd_t const& a, qd_t const& b) noexcept -> bool {
+    return a.c[0] == b.c[0] and a.c[1] == b.c[1] and a.c[2] == b.c[2] and a.c[3] == b.c[3];
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator!=(qd_t const& a, qd_t const& b) noexcept -> bool {
+    return not(a == b);
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator<(qd_t const& a, qd_t const& b) noexcept -> bool {
+    for (std::size_t i = 0; i < 4; ++i) {
+      if (a.c[i] != b.c[i]) {
+        return a.c[i] < b.c[i];
+      }
+    }
+    return false;
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator>(qd_t const& a, qd_t const& b) noexcept -> bool {
+    return b < a;
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator<=(qd_t const& a, qd_t const& b) noexcept -> bool {
+    return a < b or a == b;
+  }
+  /// \n
+  [[MPFR_CXX_NODISCARD]] friend auto operator>=(qd_t const& a, qd_t const& b) noexcept -> bool {
+    return b <= a;
+  }
+  ///@}
+};
+
+/// \return Absolute value of the argument.
+inline auto abs(qd_t const& x) noexcept -> qd_t { return x.c[0] < 0.0 ? -x : x; }
+
+/// \return Square root of the argument, which must be non negative.
+inline auto sqrt(qd_t const& x) noexcept -> qd_t {
+  if (x.c[0] <= 0.0) {
+    return qd_t{std::sqrt(x.c[0])};
+  }
+  // Newton iteration on 1/sqrt(x), which doubles the number of correct bits each step
+  qd_t r = 1.0 / std::sqrt(x.c[0]);
+  qd_t const half_x = x * 0.5;
+  for (int i = 0; i < 3; ++i) {
+    r += (qd_t{0.5} - half_x * (r * r)) * r;
+  }
+  return x * r;
+}
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard MULTI_DOUBLE_HPP_Q8ZR4MWD */
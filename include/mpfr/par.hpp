@@ -0,0 +1,249 @@
+#ifndef PAR_HPP_W4LT8ZQE
+#define PAR_HPP_W4LT8ZQE
+
+#include "mpfr/span.hpp"
+#include "mpfr/detail/thread_pool.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace mpfr {
+namespace _ {
+
+/// Number of elements of the blocks of `par::inclusive_scan`, which only depend on the size of
+/// the range, so that the result is the same for any number of threads.
+constexpr std::size_t scan_block_size = 256;
+
+/// Number of elements that a task of `par::sort` sorts or merges.
+constexpr std::size_t sort_block_size = 4096;
+
+/// \return The number of elements of `a` among the first `d` elements of the stable merge of `a`
+/// and `b`.
+template <typename T, typename Compare>
+auto merge_corank(span<T const> a, span<T const> b, std::size_t d, Compare& comp)
+    -> std::size_t {
+  std::size_t lo = d > b.size() ? d - b.size() : 0;
+  std::size_t hi = d < a.size() ? d : a.size();
+  while (lo < hi) {
+    std::size_t const i = lo + (hi - lo) / 2;
+    std::size_t const j = d - i;
+    if (i < a.size() and j > 0 and not comp(b[j - 1], a[i])) {
+      lo = i + 1;
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+/// Merges the consecutive sorted runs of length `run` of `src` pairwise into `dst`. Each task
+/// writes a block of `sort_block_size` elements of the output, which lies within the output of a
+/// single pair since `run` is a multiple of `sort_block_size`.
+template <typename T, typename Compare>
+void merge_level(
+    T const* src, T* dst, std::size_t n, std::size_t run, Compare& comp, std::size_t n_threads) {
+  auto merge_blocks = [&](std::size_t first_block, std::size_t last_block) {
+    for (std::size_t blk = first_block; blk < last_block; ++blk) {
+      std::size_t const out_begin = blk * sort_block_size;
+      std::size_t const out_end =
+          (n - out_begin) < sort_block_size ? n : out_begin + sort_block_size;
+      std::size_t const pair_begin = out_begin / (2 * run) * (2 * run);
+      std::size_t const mid = (n - pair_begin) < run ? n : pair_begin + run;
+      std::size_t const pair_end = (n - mid) < run ? n : mid + run;
+
+      span<T const> const a{src + pair_begin, mid - pair_begin};
+      span<T const> const b{src + mid, pair_end - mid};
+      std::size_t const d = out_begin - pair_begin;
+      std::size_t const d_end = out_end - pair_begin;
+      std::size_t const i = _::merge_corank(a, b, d, comp);
+      std::size_t const i_end = _::merge_corank(a, b, d_end, comp);
+      std::merge(
+          a.data() + i,
+          a.data() + i_end,
+          b.data() + (d - i),
+          b.data() + (d_end - i_end),
+          dst + out_begin,
+          comp);
+    }
+  };
+  _::steal_work((n + sort_block_size - 1) / sort_block_size, n_threads, merge_blocks);
+}
+
+} // namespace _
+
+/// Parallel algorithms on contiguous ranges, that run on the thread pool of the library. Each
+/// thread starts with an equal share of the range, and takes chunks from it whose size adapts to
+/// the measured cost of the operation, so that cheap operations such as additions are called on
+/// large chunks, and expensive ones such as special functions on single elements. Threads that
+/// run out of work steal half of the largest remaining share.\n
+/// As with the other parallel algorithms, the workers use the exponent range and rounding mode of
+/// the caller, and the MPFR flags they raise are raised in the caller. Calls made from within the
+/// operations run sequentially.\n
+/// If an operation throws, the first exception is rethrown on the caller once all the threads
+/// are done, and the elements that were not reached yet may be left unprocessed.
+namespace par {
+
+/// Calls `fn(x)` for every element `x` of `xs`, concurrently from multiple threads.
+///
+/// @param[in] xs         Elements.
+/// @param[in] fn         Function, called concurrently from multiple threads.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <typename T, typename Fn> void for_each(span<T> xs, Fn fn, std::size_t n_threads = 0) {
+  auto chunk = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      fn(xs[i]);
+    }
+  };
+  _::steal_work(xs.size(), n_threads, chunk);
+}
+
+/// Writes `fn(xs[i])` to `out[i]` for every index `i` of `xs`.
+///
+/// @param[in] xs         Inputs.
+/// @param[out] out       Outputs. Must have the same size as `xs`.
+/// @param[in] fn         Function, called concurrently from multiple threads.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <typename T, typename U, typename Fn>
+void transform(span<T const> xs, span<U> out, Fn fn, std::size_t n_threads = 0) {
+  if (xs.size() != out.size()) {
+    _::crash_with_message("par::transform: ranges have different sizes");
+  }
+  auto chunk = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      out[i] = fn(xs[i]);
+    }
+  };
+  _::steal_work(xs.size(), n_threads, chunk);
+}
+
+/// Writes `fn(xs[i], ys[i])` to `out[i]` for every index `i` of `xs`.
+///
+/// @param[in] xs         First inputs.
+/// @param[in] ys         Second inputs. Must have the same size as `xs`.
+/// @param[out] out       Outputs. Must have the same size as `xs`.
+/// @param[in] fn         Function, called concurrently from multiple threads.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <typename T1, typename T2, typename U, typename Fn>
+void transform(
+    span<T1 const> xs, span<T2 const> ys, span<U> out, Fn fn, std::size_t n_threads = 0) {
+  if (xs.size() != ys.size() or xs.size() != out.size()) {
+    _::crash_with_message("par::transform: ranges have different sizes");
+  }
+  auto chunk = [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      out[i] = fn(xs[i], ys[i]);
+    }
+  };
+  _::steal_work(xs.size(), n_threads, chunk);
+}
+
+/// Writes to `out[i]` the reduction of `xs[0]`, ..., `xs[i]` with the binary operation `op`, which
+/// is assumed to be associative.\n
+/// The range is split into blocks of fixed size. The blocks are scanned in parallel, then the
+/// totals of the blocks are scanned sequentially, and finally combined with the elements of the
+/// following blocks in parallel. The result is thus the same for any number of threads, but may
+/// differ from a sequential scan in the last bits when `op` rounds.
+///
+/// @param[in] xs         Inputs.
+/// @param[out] out       Outputs. Must have the same size as `xs`, and may be the same range.
+/// @param[in] op         Binary operation, called concurrently from multiple threads.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <typename T, typename Op>
+void inclusive_scan(span<T const> xs, span<T> out, Op op, std::size_t n_threads = 0) {
+  if (xs.size() != out.size()) {
+    _::crash_with_message("par::inclusive_scan: ranges have different sizes");
+  }
+  std::size_t const n = xs.size();
+  std::size_t const n_blocks = (n + _::scan_block_size - 1) / _::scan_block_size;
+  auto block_end = [&](std::size_t blk) {
+    return (n - blk * _::scan_block_size) < _::scan_block_size ? n
+                                                               : (blk + 1) * _::scan_block_size;
+  };
+
+  auto scan_blocks = [&](std::size_t first_block, std::size_t last_block) {
+    for (std::size_t blk = first_block; blk < last_block; ++blk) {
+      std::size_t const begin = blk * _::scan_block_size;
+      std::size_t const end = block_end(blk);
+      out[begin] = xs[begin];
+      for (std::size_t i = begin + 1; i < end; ++i) {
+        out[i] = op(out[i - 1], xs[i]);
+      }
+    }
+  };
+  _::steal_work(n_blocks, n_threads, scan_blocks);
+  if (n_blocks <= 1) {
+    return;
+  }
+
+  // prefixes[b] is the reduction of the blocks before block b + 1
+  std::vector<T> prefixes;
+  prefixes.reserve(n_blocks - 1);
+  prefixes.push_back(out[block_end(0) - 1]);
+  for (std::size_t blk = 1; blk + 1 < n_blocks; ++blk) {
+    prefixes.push_back(op(prefixes.back(), out[block_end(blk) - 1]));
+  }
+
+  auto add_prefixes = [&](std::size_t first_block, std::size_t last_block) {
+    for (std::size_t blk = first_block; blk < last_block; ++blk) {
+      T const& prefix = prefixes[blk];
+      for (std::size_t i = (blk + 1) * _::scan_block_size; i < block_end(blk + 1); ++i) {
+        out[i] = op(prefix, out[i]);
+      }
+    }
+  };
+  _::steal_work(n_blocks - 1, n_threads, add_prefixes);
+}
+
+/// Sorts `xs` in the order given by `comp`, which must be a strict weak ordering on its elements,
+/// so that NaNs must not be compared with `operator<`.\n
+/// Blocks of fixed size are sorted in parallel, then merged pairwise. Every merge is split into
+/// blocks of the output, that are located in the inputs with a binary search and merged in
+/// parallel. The order of equal elements is unspecified.
+///
+/// @param[in,out] xs     Elements to sort.
+/// @param[in] comp       Comparison, called concurrently from multiple threads.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <typename T, typename Compare = std::less<T>>
+void sort(span<T> xs, Compare comp = Compare{}, std::size_t n_threads = 0) {
+  std::size_t const n = xs.size();
+  std::size_t const n_blocks = (n + _::sort_block_size - 1) / _::sort_block_size;
+  auto sort_blocks = [&](std::size_t first_block, std::size_t last_block) {
+    for (std::size_t blk = first_block; blk < last_block; ++blk) {
+      std::size_t const begin = blk * _::sort_block_size;
+      std::size_t const end = (n - begin) < _::sort_block_size ? n : begin + _::sort_block_size;
+      std::sort(xs.data() + begin, xs.data() + end, comp);
+    }
+  };
+  _::steal_work(n_blocks, n_threads, sort_blocks);
+  if (n_blocks <= 1) {
+    return;
+  }
+
+  std::vector<T> buffer(n);
+  T* src = xs.data();
+  T* dst = buffer.data();
+  for (std::size_t run = _::sort_block_size; run < n; run *= 2) {
+    _::merge_level(src, dst, n, run, comp, n_threads);
+    std::swap(src, dst);
+  }
+  if (src != xs.data()) {
+    auto copy_back = [&](std::size_t begin, std::size_t end) {
+      std::copy(src + begin, src + end, xs.data() + begin);
+    };
+    _::steal_work(n, n_threads, copy_back);
+  }
+}
+
+} // namespace par
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard PAR_HPP_W4LT8ZQE */
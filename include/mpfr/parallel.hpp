@@ -0,0 +1,184 @@
+#ifndef PARALLEL_HPP_QF3N8T0B
+#define PARALLEL_HPP_QF3N8T0B
+
+#include "mpfr/span.hpp"
+#include "mpfr/detail/thread_pool.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+namespace mpfr {
+namespace _ {
+
+/// Number of elements that are reduced sequentially.\n
+/// The partition of a range into blocks only depends on its size, which is what makes the
+/// parallel reductions independent of the number of threads.
+constexpr std::size_t reduction_block_size = 256;
+
+constexpr auto n_reduction_blocks(std::size_t n) -> std::size_t {
+  return (n + reduction_block_size - 1) / reduction_block_size;
+}
+
+template <precision_t P>
+void sum_block(mp_float_t<P>& out, mp_float_t<P> const* xs, std::size_t n) {
+  mpfr_cref_t refs[reduction_block_size];
+  mpfr_ptr ptrs[reduction_block_size];
+  for (std::size_t i = 0; i < n; ++i) {
+    refs[i] = impl_access::mpfr_cref(xs[i]);
+    ptrs[i] = &refs[i].m;
+  }
+  mpfr_raii_setter_t&& g = impl_access::mpfr_setter(out);
+  mpfr_sum(&g.m, ptrs, n, _::get_rnd());
+}
+
+template <precision_t P>
+void dot_block(
+    mp_float_t<P>& out, mp_float_t<P> const* xs, mp_float_t<P> const* ys, std::size_t n) {
+#if MPFR_VERSION_MAJOR > 4 or (MPFR_VERSION_MAJOR == 4 and MPFR_VERSION_MINOR >= 1)
+  mpfr_cref_t xrefs[reduction_block_size];
+  mpfr_cref_t yrefs[reduction_block_size];
+  mpfr_ptr xptrs[reduction_block_size];
+  mpfr_ptr yptrs[reduction_block_size];
+  for (std::size_t i = 0; i < n; ++i) {
+    xrefs[i] = impl_access::mpfr_cref(xs[i]);
+    yrefs[i] = impl_access::mpfr_cref(ys[i]);
+    xptrs[i] = &xrefs[i].m;
+    yptrs[i] = &yrefs[i].m;
+  }
+  mpfr_raii_setter_t&& g = impl_access::mpfr_setter(out);
+  mpfr_dot(&g.m, xptrs, yptrs, n, _::get_rnd());
+#else
+  // no mpfr_dot before MPFR 4.1, fall back to an fma chain
+  out = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    out = mpfr::fma(xs[i], ys[i], out);
+  }
+#endif
+}
+
+/// Writes to `dst[i]` the reduction of the `i`-th block of the `n` values starting at `src`, as
+/// computed by `reduce_block(out, first, count)`.
+template <typename T, typename Reduce_Block>
+void reduce_level(
+    T* dst, T const* src, std::size_t n, Reduce_Block& reduce_block, std::size_t n_threads) {
+  auto task = [&](std::size_t i) {
+    std::size_t begin = i * reduction_block_size;
+    std::size_t len = (n - begin) < reduction_block_size ? (n - begin) : reduction_block_size;
+    reduce_block(dst[i], src + begin, len);
+  };
+  thread_pool::global().for_each_index(n_reduction_blocks(n), n_threads, task);
+}
+
+/// Reduces `n` values with a fixed tree: the first level is computed by `first_level`, and the
+/// following ones by `upper_levels`, until a single value remains.
+template <typename T, typename First_Level, typename Upper_Levels>
+auto reduce_tree(
+    std::size_t n,
+    First_Level& first_level,
+    Upper_Levels& upper_levels,
+    std::size_t n_threads) -> T {
+  std::vector<T> buf_a(n_reduction_blocks(n));
+  std::vector<T> buf_b(n_reduction_blocks(buf_a.size()));
+
+  auto first_task = [&](std::size_t i) {
+    std::size_t begin = i * reduction_block_size;
+    std::size_t len = (n - begin) < reduction_block_size ? (n - begin) : reduction_block_size;
+    first_level(buf_a[i], begin, len);
+  };
+  thread_pool::global().for_each_index(buf_a.size(), n_threads, first_task);
+
+  T* src = buf_a.data();
+  T* dst = buf_b.data();
+  std::size_t count = buf_a.size();
+  while (count > 1) {
+    _::reduce_level(dst, src, count, upper_levels, n_threads);
+    count = n_reduction_blocks(count);
+    T* tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  return *src;
+}
+
+} // namespace _
+
+/// Reduces the range with the binary operation `op`, which is assumed to be associative.\n
+/// The range is split into blocks of fixed size that are folded from left to right, and the
+/// block results are then combined with a tree whose shape only depends on the size of the
+/// range. The result is thus the same for any number of threads.
+///
+/// \return `op(init, r)` where `r` is the reduction of `xs`, or `init` if `xs` is empty.
+///
+/// @param[in] xs         Values to reduce.
+/// @param[in] init       Initial value.
+/// @param[in] op         Binary operation, called concurrently from multiple threads.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <typename T, typename Op>
+auto parallel_reduce(span<T const> xs, T const& init, Op op, std::size_t n_threads = 0) -> T {
+  if (xs.empty()) {
+    return init;
+  }
+  auto fold = [&](T& out, T const* first, std::size_t len) {
+    out = first[0];
+    for (std::size_t i = 1; i < len; ++i) {
+      out = op(out, first[i]);
+    }
+  };
+  auto first_level = [&](T& out, std::size_t begin, std::size_t len) {
+    fold(out, xs.data() + begin, len);
+  };
+  return op(init, _::reduce_tree<T>(xs.size(), first_level, fold, n_threads));
+}
+
+/// \return The sum of the elements of `xs`.\n
+/// Each block of the reduction tree is summed with a single rounding, so the result is the same
+/// for any number of threads.
+///
+/// @param[in] xs         Values to sum.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <precision_t P>
+auto parallel_sum(span<mp_float_t<P> const> xs, std::size_t n_threads = 0) -> mp_float_t<P> {
+  if (xs.empty()) {
+    return {};
+  }
+  auto sum = [](mp_float_t<P>& out, mp_float_t<P> const* first, std::size_t len) {
+    _::sum_block(out, first, len);
+  };
+  auto first_level = [&](mp_float_t<P>& out, std::size_t begin, std::size_t len) {
+    _::sum_block(out, xs.data() + begin, len);
+  };
+  return _::reduce_tree<mp_float_t<P>>(xs.size(), first_level, sum, n_threads);
+}
+
+/// \return The dot product of `xs` and `ys`.\n
+/// Each block of the reduction tree is computed with a single rounding, so the result is the same
+/// for any number of threads.
+///
+/// @param[in] xs         First operand.
+/// @param[in] ys         Second operand. Must have the same size as `xs`.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <precision_t P>
+auto parallel_dot(
+    span<mp_float_t<P> const> xs, span<mp_float_t<P> const> ys, std::size_t n_threads = 0)
+    -> mp_float_t<P> {
+  if (xs.size() != ys.size()) {
+    _::crash_with_message("parallel_dot: operands have different sizes");
+  }
+  if (xs.empty()) {
+    return {};
+  }
+  auto sum = [](mp_float_t<P>& out, mp_float_t<P> const* first, std::size_t len) {
+    _::sum_block(out, first, len);
+  };
+  auto first_level = [&](mp_float_t<P>& out, std::size_t begin, std::size_t len) {
+    _::dot_block(out, xs.data() + begin, ys.data() + begin, len);
+  };
+  return _::reduce_tree<mp_float_t<P>>(xs.size(), first_level, sum, n_threads);
+}
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard PARALLEL_HPP_QF3N8T0B */
@@ -0,0 +1,180 @@
+#ifndef POLY_HPP_8RZK4WQN
+#define POLY_HPP_8RZK4WQN
+
+#include "mpfr/span.hpp"
+#include "mpfr/detail/thread_pool.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+namespace mpfr {
+
+/// Evaluation scheme of a polynomial.
+enum struct poly_scheme_e {
+  /// Horner's scheme, one fused multiply-add per coefficient.
+  horner,
+  /// Estrin's scheme, pairs of terms are combined in a tree of fused multiply-adds with
+  /// successive squares of the argument.
+  estrin,
+};
+
+namespace _ {
+
+/// `out = c[0] + c[1] * x + ... + c[n - 1] * x^(n - 1)`, with one rounding per coefficient.
+/// `out` must not alias `x`.
+template <precision_t P>
+void horner(mp_float_t<P>& out, mpfr_cref_t const* c, std::size_t n, mp_float_t<P> const& x) {
+  mpfr_cref_t x_ = impl_access::mpfr_cref(x);
+  mpfr_raii_setter_t&& g = impl_access::mpfr_setter(out);
+  mpfr_rnd_t rnd = _::get_rnd();
+  if (n == 0) {
+    mpfr_set_zero(&g.m, 1);
+    return;
+  }
+  mpfr_set(&g.m, &c[n - 1].m, rnd);
+  for (std::size_t i = n - 1; i-- > 0;) {
+    mpfr_fma(&g.m, &g.m, &x_.m, &c[i].m, rnd);
+  }
+}
+
+/// Same as `horner`, with Estrin's scheme. `scratch` must hold at least `(n + 1) / 2` values.
+template <precision_t P>
+void estrin(
+    mp_float_t<P>& out,
+    mpfr_cref_t const* c,
+    std::size_t n,
+    mp_float_t<P> const& x,
+    mp_float_t<P>* scratch) {
+  if (n <= 2) {
+    _::horner(out, c, n, x);
+    return;
+  }
+  mpfr_rnd_t rnd = _::get_rnd();
+  mp_float_t<P> power = x;
+
+  // first level, reading from the coefficients
+  std::size_t len = (n + 1) / 2;
+  {
+    mpfr_cref_t x_ = impl_access::mpfr_cref(x);
+    for (std::size_t i = 0; i < n / 2; ++i) {
+      mpfr_raii_setter_t&& g = impl_access::mpfr_setter(scratch[i]);
+      mpfr_fma(&g.m, &c[2 * i + 1].m, &x_.m, &c[2 * i].m, rnd);
+    }
+    if (n % 2 == 1) {
+      mpfr_raii_setter_t&& g = impl_access::mpfr_setter(scratch[len - 1]);
+      mpfr_set(&g.m, &c[n - 1].m, rnd);
+    }
+  }
+
+  // following levels, in place. the i-th output only overwrites inputs that were already
+  // consumed, except for the first one which goes through a temporary
+  mp_float_t<P> tmp;
+  while (len > 1) {
+    {
+      mpfr_cref_t p_ = impl_access::mpfr_cref(power);
+      mpfr_raii_setter_t&& g = impl_access::mpfr_setter(tmp);
+      mpfr_sqr(&g.m, &p_.m, rnd);
+    }
+    power = tmp;
+    mpfr_cref_t p_ = impl_access::mpfr_cref(power);
+    for (std::size_t i = 0; i < len / 2; ++i) {
+      mpfr_cref_t lo = impl_access::mpfr_cref(scratch[2 * i]);
+      mpfr_cref_t hi = impl_access::mpfr_cref(scratch[2 * i + 1]);
+      {
+        mpfr_raii_setter_t&& g = impl_access::mpfr_setter(i == 0 ? tmp : scratch[i]);
+        mpfr_fma(&g.m, &hi.m, &p_.m, &lo.m, rnd);
+      }
+      if (i == 0) {
+        scratch[0] = tmp;
+      }
+    }
+    if (len % 2 == 1) {
+      scratch[len / 2] = scratch[len - 1];
+    }
+    len = (len + 1) / 2;
+  }
+  out = scratch[0];
+}
+
+template <precision_t P>
+void bind_coeffs(std::vector<mpfr_cref_t>& refs, span<mp_float_t<P> const> coeffs) {
+  refs.resize(coeffs.size());
+  for (std::size_t i = 0; i < coeffs.size(); ++i) {
+    refs[i] = impl_access::mpfr_cref(coeffs[i]);
+  }
+}
+
+} // namespace _
+
+/// \return The value at `x` of the polynomial whose coefficients are given in ascending order of
+/// degree.\n
+/// Each step of the evaluation is a single fused multiply-add, rounded once.
+///
+/// @param[in] coeffs Coefficients, starting from the constant term.
+/// @param[in] x      Evaluation point.
+/// @param[in] scheme Evaluation scheme.
+template <precision_t P>
+auto poly_eval(
+    span<mp_float_t<P> const> coeffs,
+    mp_float_t<P> const& x,
+    poly_scheme_e scheme = poly_scheme_e::horner) -> mp_float_t<P> {
+  std::vector<_::mpfr_cref_t> refs;
+  _::bind_coeffs(refs, coeffs);
+  mp_float_t<P> out;
+  if (scheme == poly_scheme_e::estrin) {
+    std::vector<mp_float_t<P>> scratch((coeffs.size() + 1) / 2);
+    _::estrin(out, refs.data(), refs.size(), x, scratch.data());
+  } else {
+    _::horner(out, refs.data(), refs.size(), x);
+  }
+  return out;
+}
+
+/// Evaluates the polynomial at each element of `xs`, and writes the results to `out`.\n
+/// The points are distributed over the thread pool, and each result is identical to the one
+/// computed by the scalar overload. `out` may be the same range as `xs`.
+///
+/// @param[in] coeffs     Coefficients, starting from the constant term.
+/// @param[in] xs         Evaluation points.
+/// @param[out] out       Results. Must have the same size as `xs`.
+/// @param[in] scheme     Evaluation scheme.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <precision_t P>
+void poly_eval(
+    span<mp_float_t<P> const> coeffs,
+    span<mp_float_t<P> const> xs,
+    span<mp_float_t<P>> out,
+    poly_scheme_e scheme = poly_scheme_e::horner,
+    std::size_t n_threads = 0) {
+  if (xs.size() != out.size()) {
+    _::crash_with_message("poly_eval: input and output have different sizes");
+  }
+  constexpr std::size_t points_per_task = 64;
+
+  std::vector<_::mpfr_cref_t> refs;
+  _::bind_coeffs(refs, coeffs);
+
+  auto task = [&](std::size_t t) {
+    std::vector<mp_float_t<P>> scratch(
+        scheme == poly_scheme_e::estrin ? (coeffs.size() + 1) / 2 : 0);
+    std::size_t const begin = t * points_per_task;
+    std::size_t const end =
+        (xs.size() - begin) < points_per_task ? xs.size() : begin + points_per_task;
+    for (std::size_t i = begin; i < end; ++i) {
+      // copied since `out` may alias `xs`
+      mp_float_t<P> const x = xs[i];
+      if (scheme == poly_scheme_e::estrin) {
+        _::estrin(out[i], refs.data(), refs.size(), x, scratch.data());
+      } else {
+        _::horner(out[i], refs.data(), refs.size(), x);
+      }
+    }
+  };
+  _::thread_pool::global().for_each_index(
+      (xs.size() + points_per_task - 1) / points_per_task, n_threads, task);
+}
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard POLY_HPP_8RZK4WQN */
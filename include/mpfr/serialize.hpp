@@ -0,0 +1,370 @@
+#ifndef SERIALIZE_HPP_Q7WM3ZDV
+#define SERIALIZE_HPP_Q7WM3ZDV
+
+#include "mpfr/mp_float.hpp"
+#include "mpfr/span.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <system_error>
+#include <vector>
+
+namespace mpfr {
+
+/// Result of `serialize`, with the same meaning as `std::to_chars_result`.
+struct serialize_result {
+  unsigned char* ptr;
+  std::errc ec;
+};
+
+/// Result of `deserialize`, with the same meaning as `std::from_chars_result`.
+struct deserialize_result {
+  unsigned char const* ptr;
+  std::errc ec;
+};
+
+namespace _ {
+
+// the encoding of a number is
+//  - a varint header, `8 * prec + 4 * sign + kind`, where `prec` is the actual precision of a
+//    regular number and zero otherwise, and `kind` is one of `serial_kind_e`,
+//  - for regular numbers, the exponent as a zigzag varint, followed by the `ceil(prec / 8)` most
+//    significant bytes of the significand, in decreasing order of significance.
+// varints are little endian base 128, so that the format does not depend on the byte order or
+// the limb size of the machine.
+
+enum struct serial_kind_e : unsigned char {
+  zero = 0,
+  regular = 1,
+  inf = 2,
+  nan = 3,
+};
+
+/// Maximum number of bytes of a varint.
+constexpr std::size_t varint_max_size = (64 + 6) / 7;
+
+constexpr auto varint_size(std::uint64_t v) -> std::size_t {
+  return v < 128 ? 1 : 1 + varint_size(v >> 7U);
+}
+
+constexpr auto zigzag_encode(std::int64_t v) -> std::uint64_t {
+  return (static_cast<std::uint64_t>(v) << 1U) ^ (v < 0 ? ~std::uint64_t{0} : std::uint64_t{0});
+}
+
+constexpr auto zigzag_decode(std::uint64_t v) -> std::int64_t {
+  return static_cast<std::int64_t>((v >> 1U) ^ (~(v & 1U) + 1U));
+}
+
+inline auto write_varint(unsigned char* out, std::uint64_t v) noexcept -> unsigned char* {
+  while (v >= 128) {
+    *out++ = static_cast<unsigned char>(v | 128U);
+    v >>= 7U;
+  }
+  *out++ = static_cast<unsigned char>(v);
+  return out;
+}
+
+/// \return The end of the varint read to `v`, or `nullptr` if `[first, last)` does not start
+/// with a varint that fits in 64 bits.
+inline auto read_varint(unsigned char const* first, unsigned char const* last, std::uint64_t& v)
+    -> unsigned char const* {
+  std::uint64_t out = 0;
+  for (unsigned shift = 0; first != last and shift < 64; shift += 7) {
+    std::uint64_t const byte = *first++;
+    if (shift == 63 and byte > 1) {
+      return nullptr;
+    }
+    out |= (byte & 127U) << shift;
+    if (byte < 128) {
+      v = out;
+      return first;
+    }
+  }
+  return nullptr;
+}
+
+constexpr auto serial_header(mpfr_prec_t prec, bool sign, serial_kind_e kind) -> std::uint64_t {
+  return 8 * static_cast<std::uint64_t>(prec) + (sign ? 4U : 0U) + static_cast<unsigned>(kind);
+}
+
+constexpr auto significand_bytes(mpfr_prec_t prec) -> std::size_t {
+  return static_cast<std::size_t>((prec + CHAR_BIT - 1) / CHAR_BIT);
+}
+
+constexpr std::size_t limb_bytes = sizeof(mp_limb_t);
+
+/// Writes the `n_bytes` most significant bytes of the `n_limbs` limbs at `d`.
+inline auto write_significand(
+    unsigned char* out, mp_limb_t const* d, std::size_t n_limbs, std::size_t n_bytes) noexcept
+    -> unsigned char* {
+  std::size_t i = n_limbs;
+  // whole limbs, with a fixed trip count that compilers turn into a byte swap
+  for (; n_bytes >= limb_bytes; n_bytes -= limb_bytes, out += limb_bytes) {
+    mp_limb_t const limb = d[--i];
+    for (std::size_t j = 0; j < limb_bytes; ++j) {
+      out[j] = static_cast<unsigned char>(limb >> (CHAR_BIT * (limb_bytes - 1 - j)));
+    }
+  }
+  if (n_bytes > 0) {
+    mp_limb_t const limb = d[--i];
+    for (std::size_t j = 0; j < n_bytes; ++j) {
+      *out++ = static_cast<unsigned char>(limb >> (CHAR_BIT * (limb_bytes - 1 - j)));
+    }
+  }
+  return out;
+}
+
+/// Reads `n_bytes` bytes to the most significant end of the `n_limbs` limbs at `d`, and zeroes
+/// the rest.
+inline void read_significand(
+    mp_limb_t* d, std::size_t n_limbs, unsigned char const* in, std::size_t n_bytes) noexcept {
+  std::size_t i = n_limbs;
+  for (; n_bytes >= limb_bytes; n_bytes -= limb_bytes, in += limb_bytes) {
+    mp_limb_t limb = 0;
+    for (std::size_t j = 0; j < limb_bytes; ++j) {
+      limb |= mp_limb_t{in[j]} << (CHAR_BIT * (limb_bytes - 1 - j));
+    }
+    d[--i] = limb;
+  }
+  if (n_bytes > 0) {
+    mp_limb_t limb = 0;
+    for (std::size_t j = 0; j < n_bytes; ++j) {
+      limb |= mp_limb_t{in[j]} << (CHAR_BIT * (limb_bytes - 1 - j));
+    }
+    d[--i] = limb;
+  }
+  std::memset(d, 0, i * sizeof(mp_limb_t));
+}
+
+/// Checks that the significand is normalized and has no bits past the precision.
+inline auto valid_significand(unsigned char const* in, mpfr_prec_t prec) -> bool {
+  std::size_t const n = significand_bytes(prec);
+  auto const unused = static_cast<unsigned>(n * CHAR_BIT - static_cast<std::size_t>(prec));
+  return (in[0] & 128U) != 0 and (in[n - 1] & ((1U << unused) - 1U)) == 0;
+}
+
+template <precision_t P>
+auto serialize_impl(unsigned char* first, unsigned char* last, mp_float_t<P> const& x) noexcept
+    -> serialize_result {
+  mpfr_cref_t x_ = impl_access::mpfr_cref(x);
+  bool const sign = mpfr_signbit(&x_.m);
+  unsigned char buf[2 * varint_max_size];
+
+  if (not mpfr_regular_p(&x_.m)) {
+    serial_kind_e const kind = mpfr_zero_p(&x_.m)  ? serial_kind_e::zero
+                               : mpfr_inf_p(&x_.m) ? serial_kind_e::inf
+                                                   : serial_kind_e::nan;
+    unsigned char* end = _::write_varint(buf, _::serial_header(0, sign, kind));
+    auto const n = static_cast<std::size_t>(end - buf);
+    if (static_cast<std::size_t>(last - first) < n) {
+      return {last, std::errc::value_too_large};
+    }
+    std::memcpy(first, buf, n);
+    return {first + n, std::errc{}};
+  }
+
+  mpfr_prec_t const prec = mpfr_get_prec(&x_.m);
+  unsigned char* end = _::write_varint(buf, _::serial_header(prec, sign, serial_kind_e::regular));
+  end = _::write_varint(end, _::zigzag_encode(mpfr_get_exp(&x_.m)));
+  auto const n_header = static_cast<std::size_t>(end - buf);
+  std::size_t const n_bytes = _::significand_bytes(prec);
+  if (static_cast<std::size_t>(last - first) < n_header + n_bytes) {
+    return {last, std::errc::value_too_large};
+  }
+  std::memcpy(first, buf, n_header);
+  return {
+      _::write_significand(
+          first + n_header,
+          static_cast<mp_limb_t const*>(mpfr_custom_get_significand(&x_.m)),
+          prec_to_nlimb(prec),
+          n_bytes),
+      std::errc{},
+  };
+}
+
+template <precision_t P>
+auto deserialize_impl(
+    unsigned char const* first, unsigned char const* last, mp_float_t<P>& value) noexcept
+    -> deserialize_result {
+  std::uint64_t header = 0;
+  unsigned char const* it = _::read_varint(first, last, header);
+  if (it == nullptr) {
+    return {first, std::errc::invalid_argument};
+  }
+  auto const kind = static_cast<serial_kind_e>(header % 4);
+  bool const sign = ((header / 4) % 2) != 0;
+  std::uint64_t const prec = header / 8;
+
+  if (kind != serial_kind_e::regular) {
+    if (prec != 0) {
+      return {first, std::errc::invalid_argument};
+    }
+    mpfr_raii_setter_t&& g = impl_access::mpfr_setter(value);
+    if (kind == serial_kind_e::zero) {
+      mpfr_set_zero(&g.m, sign ? -1 : 1);
+    } else if (kind == serial_kind_e::inf) {
+      mpfr_set_inf(&g.m, sign ? -1 : 1);
+    } else {
+      mpfr_set_nan(&g.m);
+      mpfr_setsign(&g.m, &g.m, sign ? 1 : 0, MPFR_RNDN);
+    }
+    return {it, std::errc{}};
+  }
+
+  std::uint64_t zz_exp = 0;
+  it = _::read_varint(it, last, zz_exp);
+  if (it == nullptr or prec == 0 or prec > static_cast<std::uint64_t>(MPFR_PREC_MAX)) {
+    return {first, std::errc::invalid_argument};
+  }
+  auto const actual_prec = static_cast<mpfr_prec_t>(prec);
+  std::size_t const n_bytes = _::significand_bytes(actual_prec);
+  std::int64_t const exp = _::zigzag_decode(zz_exp);
+  if (static_cast<std::size_t>(last - it) < n_bytes or
+      not _::valid_significand(it, actual_prec) or exp < mpfr_get_emin_min() or
+      exp > mpfr_get_emax_max()) {
+    return {first, std::errc::invalid_argument};
+  }
+  unsigned char const* const end = it + n_bytes;
+  if (exp < mpfr_get_emin() or exp > mpfr_get_emax()) {
+    return {end, std::errc::result_out_of_range};
+  }
+
+  constexpr mpfr_prec_t full_prec = static_cast<mpfr_prec_t>(P);
+  if (actual_prec <= full_prec) {
+    // exact, the bytes are copied to the significand
+    constexpr std::size_t full_n_limb = prec_to_nlimb(full_prec);
+    mp_limb_t* d = impl_access::mantissa_mut(value);
+    _::read_significand(d, full_n_limb, it, n_bytes);
+    impl_access::exp_mut(value) = static_cast<mpfr_exp_t>(exp);
+    impl_access::actual_prec_sign_mut(value) = prec_negate_if(actual_prec, sign);
+    return {end, std::errc{}};
+  }
+
+  // rounded to the precision of `value`
+  std::vector<mp_limb_t> limbs(prec_to_nlimb(actual_prec));
+  _::read_significand(limbs.data(), limbs.size(), it, n_bytes);
+  typename remove_pointer<mpfr_ptr>::type src{};
+  mpfr_custom_init_set(
+      &src,
+      (sign ? -1 : 1) * MPFR_REGULAR_KIND,
+      static_cast<mpfr_exp_t>(exp),
+      actual_prec,
+      limbs.data());
+
+  mp_float_t<P> tmp;
+  mpfr_flags_t const saved = mpfr_flags_save();
+  mpfr_clear_flags();
+  {
+    mpfr_raii_setter_t&& g = impl_access::mpfr_setter(tmp);
+    mpfr_set(&g.m, &src, _::get_rnd());
+  }
+  bool const out_of_range = mpfr_overflow_p();
+  mpfr_flags_t const raised = mpfr_flags_save();
+  mpfr_flags_restore(saved | (out_of_range ? 0 : raised), MPFR_FLAGS_ALL);
+  if (out_of_range) {
+    return {end, std::errc::result_out_of_range};
+  }
+  value = tmp;
+  return {end, std::errc{}};
+}
+
+} // namespace _
+
+/// \return An upper bound on the number of bytes written by `serialize` for numbers of
+/// precision `P`.
+template <precision_t P> constexpr auto max_serialized_size() noexcept -> std::size_t {
+  constexpr auto prec = static_cast<mpfr_prec_t>(P);
+  return _::varint_size(_::serial_header(prec, true, _::serial_kind_e::nan)) +
+         _::varint_max_size + _::significand_bytes(prec);
+}
+
+/// \return The number of bytes written by `serialize` for `x`.
+template <precision_t P> auto serialized_size(mp_float_t<P> const& x) noexcept -> std::size_t {
+  _::mpfr_cref_t x_ = _::impl_access::mpfr_cref(x);
+  if (not mpfr_regular_p(&x_.m)) {
+    return 1;
+  }
+  mpfr_prec_t const prec = mpfr_get_prec(&x_.m);
+  return _::varint_size(_::serial_header(prec, false, _::serial_kind_e::regular)) +
+         _::varint_size(_::zigzag_encode(mpfr_get_exp(&x_.m))) + _::significand_bytes(prec);
+}
+
+/// Writes `x` to `[first, last)` in a compact binary format that only holds the significant
+/// bits of `x`, so that numbers with few significant bits, such as small integers, take a few
+/// bytes regardless of `P`.\n
+/// The format does not depend on the byte order or the limb size of the machine, and can be
+/// read back with `deserialize` at any precision.
+///
+/// \return `{end, std::errc{}}` on success, or `{last, std::errc::value_too_large}` if the output
+/// does not fit.
+///
+/// @param[out] first Start of the output.
+/// @param[out] last  End of the output.
+/// @param[in] x      Value to write.
+template <precision_t P>
+auto serialize(unsigned char* first, unsigned char* last, mp_float_t<P> const& x) noexcept
+    -> serialize_result {
+  return _::serialize_impl(first, last, x);
+}
+
+/// Reads a number written by `serialize` from `[first, last)`. The value is exact if its
+/// precision is at most `P`, and is rounded with the current rounding mode otherwise.
+///
+/// \return `{end, std::errc{}}` on success, where `end` points past the read bytes.
+/// `{first, std::errc::invalid_argument}` if the input is truncated or is not a valid encoding.
+/// `{end, std::errc::result_out_of_range}` if the value is outside the current exponent range,
+/// in which case `value` is not modified.
+///
+/// @param[in] first  Start of the input.
+/// @param[in] last   End of the input.
+/// @param[out] value Read value.
+template <precision_t P>
+auto deserialize(
+    unsigned char const* first, unsigned char const* last, mp_float_t<P>& value) noexcept
+    -> deserialize_result {
+  return _::deserialize_impl(first, last, value);
+}
+
+/// Appends the encodings of the elements of `xs` to `out`, one after the other, as `serialize`
+/// writes them.
+///
+/// @param[in] xs   Values to write.
+/// @param[out] out Output, to which the bytes are appended.
+template <precision_t P>
+void serialize(span<mp_float_t<P> const> xs, std::vector<unsigned char>& out) {
+  std::size_t const old_size = out.size();
+  out.resize(old_size + xs.size() * max_serialized_size<P>());
+  unsigned char* ptr = out.data() + old_size;
+  unsigned char* last = out.data() + out.size();
+  for (auto const& x : xs) {
+    ptr = _::serialize_impl(ptr, last, x).ptr;
+  }
+  out.resize(static_cast<std::size_t>(ptr - out.data()));
+}
+
+/// Reads `out.size()` numbers written one after the other by `serialize` from `[first, last)`.
+///
+/// \return `{end, std::errc{}}` on success, where `end` points past the read bytes. Otherwise,
+/// the error of the first number that could not be read, the numbers before which have been
+/// read.
+///
+/// @param[in] first  Start of the input.
+/// @param[in] last   End of the input.
+/// @param[out] out   Read values.
+template <precision_t P>
+auto deserialize(unsigned char const* first, unsigned char const* last, span<mp_float_t<P>> out)
+    -> deserialize_result {
+  for (auto& x : out) {
+    deserialize_result res = _::deserialize_impl(first, last, x);
+    if (res.ec != std::errc{}) {
+      return res;
+    }
+    first = res.ptr;
+  }
+  return {first, std::errc{}};
+}
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard SERIALIZE_HPP_Q7WM3ZDV */
@@ -0,0 +1,194 @@
+#ifndef SERIES_HPP_M7CQ2YXH
+#define SERIES_HPP_M7CQ2YXH
+
+#include "mpfr/mp_float.hpp"
+#include "mpfr/detail/thread_pool.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <memory>
+
+namespace mpfr {
+namespace series {
+
+/// Integers `P`, `Q` and `T` of a range of terms of a series, as computed by `binary_split`.
+struct split_result_t /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+  split_result_t() noexcept {
+    mpz_init(p);
+    mpz_init(q);
+    mpz_init(t);
+  }
+  split_result_t(split_result_t const&) = delete;
+  split_result_t(split_result_t&& other) noexcept : split_result_t{} { swap(other); }
+  auto operator=(split_result_t const&) -> split_result_t& = delete;
+  auto operator=(split_result_t&& other) noexcept -> split_result_t& {
+    swap(other);
+    return *this;
+  }
+  ~split_result_t() {
+    mpz_clear(p);
+    mpz_clear(q);
+    mpz_clear(t);
+  }
+
+  void swap(split_result_t& other) noexcept {
+    mpz_swap(p, other.p);
+    mpz_swap(q, other.q);
+    mpz_swap(t, other.t);
+  }
+
+  /// Product of the `p(k)`.
+  mpz_t p;
+  /// Product of the `q(k)`.
+  mpz_t q;
+  /// Numerator of the partial sum, whose denominator is `q`.
+  mpz_t t;
+};
+
+} // namespace series
+
+namespace _ {
+
+/// Number of terms below which a range is split sequentially, by a single task.
+constexpr std::size_t split_leaf_terms = 64;
+
+/// Combines `left` with the range that follows it, `right`, into `left`. `P` is left unchanged
+/// unless `need_p` is set.
+inline void
+split_combine(series::split_result_t& left, series::split_result_t& right, bool need_p) {
+  // T = T_left Q_right + P_left T_right
+  mpz_mul(left.t, left.t, right.q);
+  mpz_mul(right.t, right.t, left.p);
+  mpz_add(left.t, left.t, right.t);
+  mpz_mul(left.q, left.q, right.q);
+  if (need_p) {
+    mpz_mul(left.p, left.p, right.p);
+  }
+}
+
+template <typename P_Fn, typename Q_Fn, typename A_Fn>
+void split_range(
+    std::size_t begin,
+    std::size_t end,
+    series::split_result_t& out,
+    P_Fn& p,
+    Q_Fn& q,
+    A_Fn& a,
+    bool need_p) {
+  if (end - begin == 1) {
+    p(out.p, begin);
+    q(out.q, begin);
+    a(out.t, begin);
+    mpz_mul(out.t, out.t, out.p);
+    return;
+  }
+  std::size_t const mid = begin + (end - begin) / 2;
+  series::split_result_t right;
+  _::split_range(begin, mid, out, p, q, a, true);
+  _::split_range(mid, end, right, p, q, a, need_p);
+  _::split_combine(out, right, need_p);
+}
+
+} // namespace _
+
+namespace series {
+
+/// Computes the sum `S = a(0) r(0) + a(1) r(0) r(1) + ... + a(n-1) r(0) ... r(n-1)` with
+/// `r(k) = p(k) / q(k)`, as the fraction `T / Q` of two integers. This is the form of the
+/// hypergeometric series used for constants such as pi with the Chudnovsky formula.\n
+/// The terms are combined pairwise in a balanced tree, so that the integers that are multiplied
+/// have similar sizes, which the subquadratic multiplications of GMP are fastest with. The tree
+/// is built from the bottom up: ranges of a few terms are computed sequentially by the tasks of
+/// the thread pool, then each level of the tree is combined in parallel.
+///
+/// \return The integers `P = p(0) ... p(n-1)`, `Q = q(0) ... q(n-1)`, and `T` such that
+/// `S = T / Q`. `P` is only computed if `need_p` is set, since it is not needed for the sum.
+///
+/// @param[in] p          Callable as `p(mpz_ptr out, std::size_t k)`, which sets `out` to `p(k)`.
+/// @param[in] q          Same as `p`, for `q(k)`.
+/// @param[in] a          Same as `p`, for `a(k)`.
+/// @param[in] n_terms    Number of terms of the sum. Must be positive.
+/// @param[in] need_p     Whether `P` is needed, for example to extend the sum later.
+/// @param[in] n_threads  Maximum number of threads to use, including the caller.
+/// Zero means all the threads of the pool.
+template <typename P_Fn, typename Q_Fn, typename A_Fn>
+auto binary_split(
+    P_Fn p, Q_Fn q, A_Fn a, std::size_t n_terms, bool need_p = false, std::size_t n_threads = 0)
+    -> split_result_t {
+  if (n_terms == 0) {
+    _::crash_with_message("series::binary_split: no terms");
+  }
+  std::size_t const leaf_terms = _::split_leaf_terms;
+  std::size_t count = (n_terms + leaf_terms - 1) / leaf_terms;
+  std::unique_ptr<split_result_t[]> nodes{new split_result_t[count]};
+
+  auto leaf = [&](std::size_t i) {
+    std::size_t const begin = i * leaf_terms;
+    std::size_t const end = (n_terms - begin) < leaf_terms ? n_terms : begin + leaf_terms;
+    _::split_range(begin, end, nodes[i], p, q, a, need_p or count > 1);
+  };
+  _::thread_pool::global().for_each_index(count, n_threads, leaf);
+
+  while (count > 1) {
+    std::size_t const n_pairs = count / 2;
+    bool const last = count <= 2;
+    auto combine = [&](std::size_t i) {
+      _::split_combine(nodes[2 * i], nodes[2 * i + 1], need_p or not last);
+    };
+    _::thread_pool::global().for_each_index(n_pairs, n_threads, combine);
+    for (std::size_t i = 0; i < n_pairs; ++i) {
+      nodes[i].swap(nodes[2 * i]);
+    }
+    if (count % 2 == 1) {
+      nodes[n_pairs].swap(nodes[count - 1]);
+    }
+    count = n_pairs + count % 2;
+  }
+  return std::move(nodes[0]);
+}
+
+/// Sets `out` to `T / Q` with a single rounding, in the current rounding mode. `out` can be of
+/// any precision, which allows the result to be stored on the heap when it is too large for
+/// `mp_float_t`.
+///
+/// \return The ternary value of MPFR.
+inline auto sum(split_result_t const& split, mpfr_ptr out) -> int {
+  auto exact_prec = [](mpz_srcptr z) {
+    auto const bits = static_cast<mpfr_prec_t>(mpz_sizeinbase(z, 2));
+    return bits < MPFR_PREC_MIN ? MPFR_PREC_MIN : bits;
+  };
+  // T and Q can be outside the exponent range of the caller even when their quotient is not
+  mpfr_exp_t const emin = mpfr_get_emin();
+  mpfr_exp_t const emax = mpfr_get_emax();
+  mpfr_set_emin(mpfr_get_emin_min());
+  mpfr_set_emax(mpfr_get_emax_max());
+  mpfr_rnd_t const rnd = _::get_rnd();
+  mpfr_t num;
+  mpfr_t den;
+  mpfr_init2(num, exact_prec(split.t));
+  mpfr_init2(den, exact_prec(split.q));
+  mpfr_set_z(num, split.t, MPFR_RNDN);
+  mpfr_set_z(den, split.q, MPFR_RNDN);
+  int const ternary = mpfr_div(out, num, den, rnd);
+  mpfr_clear(num);
+  mpfr_clear(den);
+  mpfr_set_emin(emin);
+  mpfr_set_emax(emax);
+  return mpfr_check_range(out, ternary, rnd);
+}
+
+/// \return `T / Q`, with a single rounding in the current rounding mode.
+template <precision_t P> auto sum(split_result_t const& split) -> mp_float_t<P> {
+  mp_float_t<P> out;
+  {
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
+    series::sum(split, &g.m);
+  }
+  return out;
+}
+
+} // namespace series
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard SERIES_HPP_M7CQ2YXH */
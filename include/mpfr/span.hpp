@@ -0,0 +1,75 @@
+#ifndef SPAN_HPP_W1Q8ZK3D
+#define SPAN_HPP_W1Q8ZK3D
+
+#include "mpfr/mp_float.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+namespace mpfr {
+
+template <typename T> struct span;
+
+namespace _ {
+template <typename T> auto declval() noexcept -> T&&;
+
+template <typename T, typename U> struct is_same { static constexpr bool value = false; };
+template <typename T> struct is_same<T, T> { static constexpr bool value = true; };
+
+template <typename T> struct remove_cvref { using type = T; };
+template <typename T> struct remove_cvref<T const> { using type = T; };
+template <typename T> struct remove_cvref<T&> : remove_cvref<T> {};
+template <typename T> struct remove_cvref<T&&> : remove_cvref<T> {};
+
+template <typename T> struct is_span { static constexpr bool value = false; };
+template <typename T> struct is_span<span<T>> { static constexpr bool value = true; };
+} // namespace _
+
+/// Non owning view over a contiguous sequence of objects.
+template <typename T> struct span {
+private:
+  T* m_data = nullptr;
+  std::size_t m_size = 0;
+
+  template <typename Container>
+  using enable_if_container_t = _::enable_if_t<
+      not _::is_span<typename _::remove_cvref<Container>::type>::value,
+      decltype(static_cast<T*>(_::declval<Container>().data()))>;
+
+public:
+  /// Constructs an empty span.
+  constexpr span() noexcept = default;
+  /// Constructs a span over the `size` objects starting at `data`.
+  constexpr span(T* data, std::size_t size) noexcept : m_data{data}, m_size{size} {}
+  /// Constructs a span over the elements of an array.
+  template <std::size_t N>
+  constexpr span(T (&arr)[N]) noexcept // NOLINT(hicpp-explicit-conversions)
+      : m_data{arr}, m_size{N} {}
+  /// Constructs a span over the elements of a contiguous container.
+  template <typename Container, typename = enable_if_container_t<Container>>
+  constexpr span(Container&& c) noexcept // NOLINT(hicpp-explicit-conversions)
+      : m_data{c.data()}, m_size{static_cast<std::size_t>(c.size())} {}
+  /// Conversion from a span of mutable objects to a span of immutable objects.
+  template <typename U, typename = _::enable_if_t<_::is_same<U const, T>::value>>
+  constexpr span(span<U> s) noexcept // NOLINT(hicpp-explicit-conversions)
+      : m_data{s.data()}, m_size{s.size()} {}
+
+  [[MPFR_CXX_NODISCARD]] constexpr auto data() const noexcept -> T* { return m_data; }
+  [[MPFR_CXX_NODISCARD]] constexpr auto size() const noexcept -> std::size_t { return m_size; }
+  [[MPFR_CXX_NODISCARD]] constexpr auto empty() const noexcept -> bool { return m_size == 0; }
+  [[MPFR_CXX_NODISCARD]] constexpr auto begin() const noexcept -> T* { return m_data; }
+  [[MPFR_CXX_NODISCARD]] constexpr auto end() const noexcept -> T* { return m_data + m_size; }
+  [[MPFR_CXX_NODISCARD]] constexpr auto operator[](std::size_t i) const noexcept -> T& {
+    return m_data[i];
+  }
+
+  /// \return The span over the `count` objects starting at index `offset`.
+  [[MPFR_CXX_NODISCARD]] constexpr auto subspan(std::size_t offset, std::size_t count) const noexcept
+      -> span {
+    return {m_data + offset, count};
+  }
+};
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard SPAN_HPP_W1Q8ZK3D */
@@ -0,0 +1,479 @@
+#ifndef STREAM_HPP_W2HF8KQC
+#define STREAM_HPP_W2HF8KQC
+
+#include "mpfr/charconv.hpp"
+#include "mpfr/serialize.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mpfr {
+
+/// Encoding of the numbers of a stream.
+enum struct stream_mode_e {
+  /// The compact encoding of `serialize`, one number after the other.
+  binary,
+  /// The shortest decimal representations of `to_chars`, one per line.
+  text,
+};
+
+namespace _ {
+
+/// Default number of bytes of the chunks of a stream.
+constexpr std::size_t stream_chunk_size = std::size_t{1} << 20U;
+
+/// File whose reads and writes run on a background thread, one at a time, so that the caller
+/// can prepare the next chunk meanwhile.
+struct async_file_t /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+private:
+  std::FILE* m_file = nullptr;
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  unsigned char* m_buf = nullptr;
+  std::size_t m_size = 0;
+  std::size_t m_transferred = 0;
+  std::errc m_error{};
+  bool m_read = false;
+  bool m_pending = false;
+  bool m_stop = false;
+
+  void loop() {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    for (;;) {
+      m_cv.wait(lock, [&] { return m_stop or m_pending; });
+      if (not m_pending) {
+        return;
+      }
+      unsigned char* buf = m_buf;
+      std::size_t const size = m_size;
+      bool const read = m_read;
+      lock.unlock();
+
+      std::size_t const n =
+          read ? std::fread(buf, 1, size, m_file) : std::fwrite(buf, 1, size, m_file);
+      bool const failed = read ? std::ferror(m_file) != 0 : n != size;
+
+      lock.lock();
+      m_transferred = n;
+      if (failed and m_error == std::errc{}) {
+        m_error = std::errc::io_error;
+      }
+      m_pending = false;
+      m_cv.notify_all();
+    }
+  }
+
+  void submit(unsigned char* buf, std::size_t size, bool read) {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_buf = buf;
+      m_size = size;
+      m_read = read;
+      m_pending = true;
+    }
+    m_cv.notify_all();
+  }
+
+public:
+  async_file_t() = default;
+  ~async_file_t() { close(); }
+
+  auto open(char const* path, char const* mode) -> std::errc {
+    close();
+    m_file = std::fopen(path, mode);
+    if (m_file == nullptr) {
+      return static_cast<std::errc>(errno);
+    }
+    // the chunks are already large, and are written as they are
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+    m_error = std::errc{};
+    m_stop = false;
+    m_thread = std::thread{[this] { loop(); }};
+    return std::errc{};
+  }
+
+  [[MPFR_CXX_NODISCARD]] auto is_open() const noexcept -> bool { return m_file != nullptr; }
+
+  /// Starts reading up to `size` bytes to `buf`. The previous operation must be finished.
+  void submit_read(unsigned char* buf, std::size_t size) { submit(buf, size, true); }
+  /// Starts writing `size` bytes from `buf`, which must stay valid until the operation is
+  /// finished. The previous operation must be finished.
+  void submit_write(unsigned char const* buf, std::size_t size) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    submit(const_cast<unsigned char*>(buf), size, false);
+  }
+
+  /// Waits for the current operation to finish.
+  ///
+  /// \return The number of bytes it transferred.
+  auto wait() -> std::size_t {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_cv.wait(lock, [&] { return not m_pending; });
+    return m_transferred;
+  }
+
+  /// \return The first error of the operations so far.
+  auto error() -> std::errc {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_error;
+  }
+
+  /// Waits for the current operation to finish, and closes the file.
+  ///
+  /// \return The first error of the operations on the file.
+  auto close() -> std::errc {
+    if (m_file == nullptr) {
+      return std::errc{};
+    }
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    if (std::fclose(m_file) != 0 and m_error == std::errc{}) {
+      m_error = std::errc::io_error;
+    }
+    m_file = nullptr;
+    return m_error;
+  }
+};
+
+} // namespace _
+
+/// Writes a sequence of numbers to a file in chunks of bounded size. Each chunk is written on a
+/// background thread while the next one is encoded, so that the computation producing the
+/// numbers overlaps with the output. At most two chunks are in memory at any time.
+///
+/// Errors are reported by `close`, which must be called to make sure that all the numbers are
+/// written, and is otherwise called by the destructor.
+template <precision_t P>
+struct stream_writer /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+  stream_writer() = default;
+  stream_writer(stream_writer const&) = delete;
+  auto operator=(stream_writer const&) -> stream_writer& = delete;
+  ~stream_writer() { close(); }
+
+  /// Creates the file at `path`, after closing the current one.
+  ///
+  /// \return `std::errc{}` on success, or the error of the system otherwise.
+  ///
+  /// @param[in] path        File to write. Its previous contents are discarded.
+  /// @param[in] mode        Encoding of the numbers.
+  /// @param[in] chunk_size  Number of bytes written at once. Chunks are enlarged as needed to
+  /// hold at least one number.
+  auto open(
+      char const* path,
+      stream_mode_e mode = stream_mode_e::binary,
+      std::size_t chunk_size = _::stream_chunk_size) -> std::errc {
+    close();
+    std::errc ec = m_file.open(path, "wb");
+    if (ec != std::errc{}) {
+      return ec;
+    }
+    m_mode = mode;
+    m_len = 0;
+    m_current = 0;
+    for (auto& buf : m_buffers) {
+      buf.resize(chunk_size > 0 ? chunk_size : 1);
+    }
+    return std::errc{};
+  }
+
+  /// \return Whether a file is open.
+  [[MPFR_CXX_NODISCARD]] auto is_open() const noexcept -> bool { return m_file.is_open(); }
+
+  /// Appends `x` to the stream, which must be open.
+  void write(mp_float_t<P> const& x) {
+    if (not m_file.is_open()) {
+      _::crash_with_message("stream_writer: the stream is not open");
+    }
+    if (not try_write(x)) {
+      flush();
+      while (not try_write(x)) {
+        m_buffers[m_current].resize(2 * m_buffers[m_current].size());
+      }
+    }
+  }
+
+  /// Appends the elements of `xs` to the stream.
+  void write(span<mp_float_t<P> const> xs) {
+    for (auto const& x : xs) {
+      write(x);
+    }
+  }
+
+  /// Writes the numbers that are still in memory, and closes the file.
+  ///
+  /// \return `std::errc{}` if all the numbers were written, or the first error otherwise.
+  auto close() -> std::errc {
+    if (not m_file.is_open()) {
+      return std::errc{};
+    }
+    flush();
+    m_file.wait();
+    return m_file.close();
+  }
+
+private:
+  auto try_write(mp_float_t<P> const& x) -> bool {
+    std::vector<unsigned char>& buf = m_buffers[m_current];
+    unsigned char* first = buf.data() + m_len;
+    unsigned char* last = buf.data() + buf.size();
+    if (m_mode == stream_mode_e::binary) {
+      serialize_result res = serialize(first, last, x);
+      if (res.ec != std::errc{}) {
+        return false;
+      }
+      m_len = static_cast<std::size_t>(res.ptr - buf.data());
+      return true;
+    }
+    if (first == last) {
+      return false;
+    }
+    auto* const chars = reinterpret_cast<char*>(buf.data());
+    to_chars_result res = to_chars(chars + m_len, chars + buf.size() - 1, x);
+    if (res.ec != std::errc{}) {
+      return false;
+    }
+    *res.ptr = '\n';
+    m_len = static_cast<std::size_t>(res.ptr + 1 - chars);
+    return true;
+  }
+
+  /// Hands the current chunk to the background thread, once it is done with the previous one.
+  void flush() {
+    if (m_len == 0) {
+      return;
+    }
+    m_file.wait();
+    m_file.submit_write(m_buffers[m_current].data(), m_len);
+    m_current = 1 - m_current;
+    m_len = 0;
+  }
+
+  _::async_file_t m_file;
+  std::vector<unsigned char> m_buffers[2];
+  std::size_t m_current = 0;
+  std::size_t m_len = 0;
+  stream_mode_e m_mode = stream_mode_e::binary;
+};
+
+/// Reads a sequence of numbers written by `stream_writer` from a file, in chunks of bounded
+/// size. The next chunk is read on a background thread while the current one is decoded. At most
+/// two chunks are in memory at any time, plus a scratch buffer of at most two chunks for the
+/// numbers longer than the reserved prefix, so that files larger than the memory can be processed.
+///
+/// Numbers are read at precision `P`, regardless of the precision they were written with, and are
+/// rounded with the current rounding mode if needed.
+template <precision_t P>
+struct stream_reader /* NOLINT(cppcoreguidelines-special-member-functions) */ {
+  stream_reader() = default;
+  stream_reader(stream_reader const&) = delete;
+  auto operator=(stream_reader const&) -> stream_reader& = delete;
+  ~stream_reader() { close(); }
+
+  /// Opens the file at `path`, after closing the current one, and starts reading its first
+  /// chunk.
+  ///
+  /// \return `std::errc{}` on success, or the error of the system otherwise.
+  ///
+  /// @param[in] path        File to read.
+  /// @param[in] mode        Encoding of the numbers, which must be the one they were written with.
+  /// @param[in] chunk_size  Number of bytes read at once. A single number must not be longer.
+  auto open(
+      char const* path,
+      stream_mode_e mode = stream_mode_e::binary,
+      std::size_t chunk_size = _::stream_chunk_size) -> std::errc {
+    close();
+    std::errc ec = m_file.open(path, "rb");
+    if (ec != std::errc{}) {
+      return ec;
+    }
+    m_mode = mode;
+    m_chunk_size = chunk_size > 0 ? chunk_size : 1;
+    m_buffers[0].resize(prefix_size + m_chunk_size);
+    m_buffers[1].resize(prefix_size + m_chunk_size);
+    m_buffers[2].clear();
+    m_front = 0;
+    m_back = 1;
+    m_pos = 0;
+    m_end = 0;
+    m_eof = false;
+    m_error = std::errc{};
+    m_file.submit_read(m_buffers[1].data() + prefix_size, m_chunk_size);
+    return std::errc{};
+  }
+
+  /// \return Whether a file is open.
+  [[MPFR_CXX_NODISCARD]] auto is_open() const noexcept -> bool { return m_file.is_open(); }
+
+  /// Reads the next number of the stream to `x`.
+  ///
+  /// \return `true` on success, or `false` at the end of the stream or on error, in which case
+  /// `x` is not modified, and the stream is left at the end.
+  auto read(mp_float_t<P>& x) -> bool {
+    if (not m_file.is_open() or m_error != std::errc{}) {
+      return false;
+    }
+    for (;;) {
+      unsigned char const* const base = m_buffers[m_front].data();
+      unsigned char const* first = base + m_pos;
+      unsigned char const* last = base + m_end;
+      if (m_mode == stream_mode_e::text) {
+        while (first != last and is_space(*first)) {
+          ++first;
+        }
+        m_pos = static_cast<std::size_t>(first - base);
+      }
+      if (first == last and m_eof) {
+        return false;
+      }
+
+      // a number at the end of the chunk may continue in the next one
+      if (m_mode == stream_mode_e::binary) {
+        deserialize_result res = deserialize(first, last, x);
+        if (res.ec == std::errc{}) {
+          m_pos = static_cast<std::size_t>(res.ptr - base);
+          return true;
+        }
+        if (res.ec != std::errc::invalid_argument or m_eof) {
+          return fail(res.ec);
+        }
+      } else {
+        unsigned char const* token_end = first;
+        while (token_end != last and not is_space(*token_end)) {
+          ++token_end;
+        }
+        if (token_end != last or m_eof) {
+          auto const* begin = reinterpret_cast<char const*>(first);
+          auto const* end = reinterpret_cast<char const*>(token_end);
+          from_chars_result res = from_chars(begin, end, x);
+          if (res.ec == std::errc{} and res.ptr != end) {
+            res.ec = std::errc::invalid_argument;
+          }
+          if (res.ec != std::errc{}) {
+            return fail(res.ec);
+          }
+          m_pos = static_cast<std::size_t>(token_end - base);
+          return true;
+        }
+      }
+      if (m_end - m_pos >= m_chunk_size) {
+        return fail(std::errc::invalid_argument);
+      }
+      if (not refill()) {
+        return false;
+      }
+    }
+  }
+
+  /// Reads the next numbers of the stream to `out`, until it is full or the stream ends.
+  ///
+  /// \return The number of numbers read.
+  auto read(span<mp_float_t<P>> out) -> std::size_t {
+    std::size_t n = 0;
+    while (n < out.size() and read(out[n])) {
+      ++n;
+    }
+    return n;
+  }
+
+  /// \return The number of bytes allocated by the buffers of the stream.
+  [[MPFR_CXX_NODISCARD]] auto buffer_capacity() const noexcept -> std::size_t {
+    return m_buffers[0].capacity() + m_buffers[1].capacity() + m_buffers[2].capacity();
+  }
+
+  /// \return `std::errc{}` if the numbers read so far were valid and the file could be read, or
+  /// the error that stopped the stream otherwise.
+  [[MPFR_CXX_NODISCARD]] auto error() const noexcept -> std::errc { return m_error; }
+
+  /// Closes the file.
+  void close() {
+    if (m_file.is_open()) {
+      m_file.wait();
+      m_file.close();
+    }
+  }
+
+private:
+  /// Space kept before the data of each chunk for the end of the previous one, so that a number
+  /// split between two chunks can be made contiguous without moving the next chunk.
+  static constexpr std::size_t prefix_size =
+      _::digits2_to_10(static_cast<std::size_t>(P)) + 64;
+
+  static auto is_space(unsigned char c) -> bool {
+    return c == ' ' or c == '\n' or c == '\t' or c == '\r' or c == '\v' or c == '\f';
+  }
+
+  auto fail(std::errc ec) -> bool {
+    m_error = ec;
+    m_pos = m_end;
+    m_eof = true;
+    return false;
+  }
+
+  /// Makes the chunk read in the background current, with the unread end of the current one
+  /// before it, and starts reading the following one.\n
+  /// An unread end longer than the prefix, written at a higher precision than `P`, is joined with
+  /// the chunk in the scratch buffer instead, so that the chunk buffers keep their size.
+  auto refill() -> bool {
+    std::size_t const n = m_file.wait();
+    if (m_file.error() != std::errc{}) {
+      return fail(m_file.error());
+    }
+    std::vector<unsigned char>& next = m_buffers[m_back];
+    std::vector<unsigned char>& scratch = m_buffers[2];
+    std::size_t const tail_len = m_end - m_pos;
+    if (tail_len <= prefix_size) {
+      unsigned char const* tail = m_buffers[m_front].data() + m_pos;
+      std::memcpy(next.data() + prefix_size - tail_len, tail, tail_len);
+      m_pos = prefix_size - tail_len;
+      m_end = prefix_size + n;
+      m_front = m_back;
+      m_back = 1 - m_back;
+    } else {
+      if (m_front == 2) {
+        scratch.erase(scratch.begin(), scratch.begin() + static_cast<std::ptrdiff_t>(m_pos));
+      } else {
+        unsigned char const* tail = m_buffers[m_front].data() + m_pos;
+        scratch.assign(tail, tail + tail_len);
+      }
+      scratch.insert(scratch.end(), next.data() + prefix_size, next.data() + prefix_size + n);
+      m_pos = 0;
+      m_end = scratch.size();
+      // both chunk buffers are free
+      m_front = 2;
+    }
+    m_eof = n < m_chunk_size;
+    if (not m_eof) {
+      m_file.submit_read(m_buffers[m_back].data() + prefix_size, m_chunk_size);
+    }
+    return true;
+  }
+
+  _::async_file_t m_file;
+  // two chunk buffers, and the scratch buffer
+  std::vector<unsigned char> m_buffers[3];
+  std::size_t m_front = 0;
+  std::size_t m_back = 1;
+  std::size_t m_pos = 0;
+  std::size_t m_end = 0;
+  std::size_t m_chunk_size = 0;
+  bool m_eof = false;
+  std::errc m_error{};
+  stream_mode_e m_mode = stream_mode_e::binary;
+};
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard STREAM_HPP_W2HF8KQC */
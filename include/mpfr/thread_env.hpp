@@ -0,0 +1,90 @@
+#ifndef THREAD_ENV_HPP_D2KP7WNC
+#define THREAD_ENV_HPP_D2KP7WNC
+
+#include "mpfr/detail/mpfr.hpp"
+#include "mpfr/detail/prologue.hpp"
+
+#include <cfenv>
+
+namespace mpfr {
+
+/// Thread local state that the operations on `mp_float_t` depend on.
+struct thread_env_settings_t {
+  /// Smallest exponent, as given to `mpfr_set_emin`.
+  mpfr_exp_t emin;
+  /// Largest exponent, as given to `mpfr_set_emax`.
+  mpfr_exp_t emax;
+  /// Rounding mode of the floating point environment, such as `FE_TONEAREST`, which is also the
+  /// rounding mode of the operations on `mp_float_t`.
+  int fe_round;
+  /// MPFR flags.
+  mpfr_flags_t flags;
+
+  /// \return The settings of the calling thread.
+  static auto current() noexcept -> thread_env_settings_t {
+    return {mpfr_get_emin(), mpfr_get_emax(), std::fegetround(), mpfr_flags_save()};
+  }
+};
+
+/// Sets up the MPFR environment of the calling thread for the lifetime of the object, which is
+/// meant for the threads of pools other than the one of the library, whose workers already run
+/// every job with the settings of its caller.\n
+/// While the object lives, the exponent range is cached in thread local storage, so that the
+/// operations by powers of two do not call into MPFR. It must then be changed with
+/// `set_exp_range` rather than with `mpfr_set_emin` and `mpfr_set_emax`, whose changes the
+/// cached operations do not see. The same holds for the jobs run by the workers of the pool of
+/// the library.\n
+/// The caches that MPFR keeps for the thread are freed when the thread exits.
+///
+/// Objects must be destroyed on the thread that created them, in the reverse order of their
+/// creation.
+class thread_env {
+public:
+  /// Keeps the settings of the calling thread.
+  thread_env() noexcept : thread_env{thread_env_settings_t::current()} {}
+
+  /// Applies `settings` to the calling thread.
+  explicit thread_env(thread_env_settings_t const& settings) noexcept
+      : m_previous{thread_env_settings_t::current()},
+        m_was_cached{_::exp_range_cache().enabled} {
+    _::set_exp_range(settings.emin, settings.emax);
+    std::fesetround(settings.fe_round);
+    mpfr_flags_restore(settings.flags, MPFR_FLAGS_ALL);
+    _::exp_range_cache().enabled = true;
+    _::free_cache_at_thread_exit();
+  }
+
+  thread_env(thread_env const&) = delete;
+  thread_env(thread_env&&) = delete;
+  auto operator=(thread_env const&) -> thread_env& = delete;
+  auto operator=(thread_env&&) -> thread_env& = delete;
+
+  /// Restores the exponent range and rounding mode that the thread had before. The flags raised
+  /// in the meantime stay raised.
+  ~thread_env() {
+    mpfr_flags_t const raised = mpfr_flags_save();
+    _::set_exp_range(m_previous.emin, m_previous.emax);
+    std::fesetround(m_previous.fe_round);
+    mpfr_flags_restore(m_previous.flags | raised, MPFR_FLAGS_ALL);
+    _::exp_range_cache().enabled = m_was_cached;
+  }
+
+  /// Sets the exponent range of the calling thread.
+  ///
+  /// \return `false` if the range is not supported by MPFR, in which case the bounds outside of
+  /// the supported range are left unchanged.
+  static auto set_exp_range(mpfr_exp_t emin, mpfr_exp_t emax) noexcept -> bool {
+    _::set_exp_range(emin, emax);
+    return mpfr_get_emin() == emin and mpfr_get_emax() == emax;
+  }
+
+private:
+  thread_env_settings_t m_previous;
+  bool m_was_cached;
+};
+
+} // namespace mpfr
+
+#include "mpfr/detail/epilogue.hpp"
+
+#endif /* end of include guard THREAD_ENV_HPP_D2KP7WNC */
@@ -0,0 +1,99 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/adaptive.hpp"
+#include "mpfr/math.hpp"
+#include <cfenv>
+#include <cmath>
+
+using namespace mpfr;
+using target_t = mp_float_t<digits2{53}>;
+using reference_t = mp_float_t<digits2{1024}>;
+
+// sin(x) - x, which cancels for small x. sin(x) is within half an ulp, at most 2^(e(x) - P), and
+// the subtraction adds half an ulp of the result, so the error is at most 2^(e(x) - P + 1).
+struct sin_minus_id_t {
+  template <precision_t P> auto operator()(mp_float_t<P> const& x) const -> adaptive_approx_t<P> {
+    mp_float_t<P> const d = sin(x) - x;
+    auto const correct_bits =
+        static_cast<mpfr_exp_t>(P) - 1 - (mpfr::ilogb(x) - mpfr::ilogb(d));
+    return adaptive_approx(d, correct_bits);
+  }
+};
+
+DOCTEST_TEST_CASE("adaptive error bound") {
+  adaptive_stats_t stats;
+  auto eval = [&](target_t const& x) {
+    auto res = adaptive_eval<digits2{53}, digits2{64}, digits2{128}, digits2{256}>(
+        sin_minus_id_t{}, x);
+    stats.record(res);
+    reference_t const ref = x;
+    target_t const expected = sin(ref) - ref;
+    DOCTEST_CHECK(res.proven);
+    DOCTEST_CHECK(res.value == expected);
+    return res.rung;
+  };
+
+  DOCTEST_CHECK(eval(1.5) == 0);
+  DOCTEST_CHECK(eval(-0.75) == 0);
+  DOCTEST_CHECK(eval(std::ldexp(1.0, -20)) == 1);
+  DOCTEST_CHECK(eval(std::ldexp(3.0, -50)) == 2);
+
+  DOCTEST_CHECK(stats.count(0) == 2);
+  DOCTEST_CHECK(stats.count(1) == 1);
+  DOCTEST_CHECK(stats.count(2) == 1);
+  DOCTEST_CHECK(stats.n_unproven() == 0);
+  DOCTEST_CHECK(stats.total() == 4);
+  stats.reset();
+  DOCTEST_CHECK(stats.total() == 0);
+}
+
+DOCTEST_TEST_CASE("adaptive rounding mode and flags") {
+  target_t const x = 0.25;
+  reference_t const ref = x;
+
+  std::fesetround(FE_UPWARD);
+  mpfr_clear_flags();
+  auto res = adaptive_eval<digits2{53}, digits2{64}, digits2{128}>(sin_minus_id_t{}, x);
+  target_t const expected = sin(ref) - ref;
+  std::fesetround(FE_TONEAREST);
+
+  DOCTEST_CHECK(res.proven);
+  DOCTEST_CHECK(res.value == expected);
+  DOCTEST_CHECK(mpfr_inexflag_p());
+  DOCTEST_CHECK(not mpfr_underflow_p());
+}
+
+DOCTEST_TEST_CASE("adaptive exact kernel") {
+  // the product of two 53 bit numbers is exact with 106 bits
+  auto mul = [](auto const& a, auto const& b) { return a * b; };
+  target_t const a = 1.0 / 3;
+  target_t const b = 1.0 / 7;
+
+  mpfr_clear_flags();
+  auto res = adaptive_eval<digits2{53}, digits2{64}, digits2{128}>(mul, a, b);
+  reference_t const ref = reference_t{a} * reference_t{b};
+  DOCTEST_CHECK(res.rung == 1);
+  DOCTEST_CHECK(res.proven);
+  DOCTEST_CHECK(res.value == target_t{ref});
+  DOCTEST_CHECK(mpfr_inexflag_p());
+
+  mpfr_clear_flags();
+  auto exact = adaptive_eval<digits2{53}, digits2{64}, digits2{128}>(mul, target_t{3}, target_t{5});
+  DOCTEST_CHECK(exact.rung == 0);
+  DOCTEST_CHECK(exact.value == 15);
+  DOCTEST_CHECK(not mpfr_inexflag_p());
+}
+
+DOCTEST_TEST_CASE("adaptive unproven") {
+  auto no_bound = [](auto const& x) { return adaptive_approx(sqrt(x), 0); };
+  adaptive_stats_t stats;
+  auto res = adaptive_eval<digits2{53}, digits2{64}, digits2{128}>(no_bound, target_t{2});
+  stats.record(res);
+  DOCTEST_CHECK(res.rung == 1);
+  DOCTEST_CHECK(not res.proven);
+  DOCTEST_CHECK(res.value == sqrt(target_t{2}));
+  DOCTEST_CHECK(stats.count(1) == 1);
+  DOCTEST_CHECK(stats.n_unproven() == 1);
+}
@@ -0,0 +1,193 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/batch.hpp"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{256}>;
+
+static auto make_args(std::size_t n) -> std::vector<scalar_t> {
+  std::vector<scalar_t> v(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    v[i] = sqrt(scalar_t{static_cast<long>(i + 1)}) * ((i % 2 == 0) ? 3 : 1) / 5;
+  }
+  // large arguments, which need a precise reduction
+  v[0] = scalar_t{1e22};
+  v[1] = -scalar_t{1e15};
+  return v;
+}
+
+template <typename Batch, typename Scalar>
+void check_unary(std::vector<scalar_t> const& xs, Batch batch_fn, Scalar scalar_fn) {
+  std::vector<scalar_t> out(xs.size());
+  batch_fn(span<scalar_t const>{xs}, span<scalar_t>{out}, 0);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    auto ref = scalar_fn(xs[i]);
+    DOCTEST_CHECK(std::memcmp(&out[i], &ref, sizeof(ref)) == 0);
+  }
+
+  std::vector<scalar_t> in_place = xs;
+  batch_fn(span<scalar_t const>{in_place}, span<scalar_t>{in_place}, 3);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    // the mantissa of singular values is left untouched, so only their values are compared
+    DOCTEST_CHECK(
+        (isnan(out[i]) ? isnan(in_place[i])
+                       : (in_place[i] == out[i] and signbit(in_place[i]) == signbit(out[i]))));
+  }
+}
+
+DOCTEST_TEST_CASE("batched functions match the scalar ones") {
+  auto xs = make_args(1000);
+  check_unary(
+      xs,
+      [](span<scalar_t const> x, span<scalar_t> o, std::size_t t) { batch::exp(x, o, t); },
+      [](scalar_t const& x) { return exp(x); });
+  check_unary(
+      xs,
+      [](span<scalar_t const> x, span<scalar_t> o, std::size_t t) { batch::log(x, o, t); },
+      [](scalar_t const& x) { return log(x); });
+  check_unary(
+      xs,
+      [](span<scalar_t const> x, span<scalar_t> o, std::size_t t) { batch::sin(x, o, t); },
+      [](scalar_t const& x) { return sin(x); });
+  check_unary(
+      xs,
+      [](span<scalar_t const> x, span<scalar_t> o, std::size_t t) { batch::cos(x, o, t); },
+      [](scalar_t const& x) { return cos(x); });
+
+  std::vector<scalar_t> s(xs.size());
+  std::vector<scalar_t> c(xs.size());
+  batch::sin_cos(span<scalar_t const>{xs}, span<scalar_t>{s}, span<scalar_t>{c});
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    auto ref = sin_cos(xs[i]);
+    DOCTEST_CHECK(std::memcmp(&s[i], &ref.sin, sizeof(scalar_t)) == 0);
+    DOCTEST_CHECK(std::memcmp(&c[i], &ref.cos, sizeof(scalar_t)) == 0);
+  }
+}
+
+DOCTEST_TEST_CASE("batched functions follow the rounding mode") {
+  auto xs = make_args(300);
+  std::vector<scalar_t> up(xs.size());
+  std::vector<scalar_t> down(xs.size());
+  std::fesetround(FE_UPWARD);
+  batch::exp(span<scalar_t const>{xs}, span<scalar_t>{up});
+  std::fesetround(FE_DOWNWARD);
+  batch::exp(span<scalar_t const>{xs}, span<scalar_t>{down});
+  std::fesetround(FE_TONEAREST);
+  // exp(1e22) overflows, to infinity upward and to the largest finite value downward, so only
+  // the other results are compared
+  DOCTEST_CHECK(isinf(up[0]));
+  DOCTEST_CHECK(isfinite(down[0]));
+  for (std::size_t i = 1; i < xs.size(); ++i) {
+    DOCTEST_CHECK(down[i] < up[i]);
+  }
+}
+
+namespace {
+
+struct rng_t {
+  std::uint64_t state;
+  auto next() -> std::uint64_t {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state;
+  }
+};
+
+// random mantissas with random trailing zeros, exponents in [-max_exp, max_exp], cancellations,
+// and a few special values
+template <precision_t P> auto random_args(rng_t& rng, std::size_t n, int max_exp) {
+  using T = mp_float_t<P>;
+  std::vector<T> v(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    std::uint64_t const hi = rng.next() | (std::uint64_t{1} << 63U);
+    std::uint64_t const lo = rng.next();
+    std::uint64_t const bits = rng.next();
+    int const zeros = static_cast<int>(bits % 128);
+    int const e = static_cast<int>((bits >> 8U) % static_cast<std::uint64_t>(2 * max_exp + 1));
+    T const m = trunc(ldexp(ldexp(T{hi}, 64) + T{lo}, -zeros));
+    v[i] = ldexp(m, zeros - 128 + e - max_exp) * (((bits >> 7U) & 1U) != 0 ? -1 : 1);
+  }
+  for (std::size_t i = 0; i + 5 < n; i += 5) {
+    v[i + 1] = -v[i] * (1 + ldexp(T{1}, -static_cast<int>(rng.next() % 140)));
+  }
+  v[3] = 0;
+  v[4] = -T{0};
+  v[5] = std::numeric_limits<T>::infinity();
+  v[6] = std::numeric_limits<T>::quiet_NaN();
+  return v;
+}
+
+template <precision_t P> auto same(mp_float_t<P> const& a, mp_float_t<P> const& b) -> bool {
+  if (isnan(a) or isnan(b)) {
+    return isnan(a) and isnan(b);
+  }
+  if (iszero(a) or isinf(a)) {
+    return a == b and signbit(a) == signbit(b);
+  }
+  return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+template <precision_t P> void check_arith(rng_t& rng, int max_exp) {
+  using T = mp_float_t<P>;
+  auto const xs = random_args<P>(rng, 2000, max_exp);
+  auto ys = random_args<P>(rng, 2000, max_exp);
+  auto const zs = random_args<P>(rng, 2000, max_exp);
+  // cancellation between the product and the addend
+  for (std::size_t i = 10; i < ys.size(); i += 7) {
+    ys[i] = -zs[i] / xs[i];
+  }
+  std::vector<T> out(xs.size());
+  span<T const> x{xs};
+  span<T const> y{ys};
+  span<T const> z{zs};
+
+  batch::add(x, y, span<T>{out});
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    DOCTEST_CHECK(same(out[i], T{xs[i] + ys[i]}));
+  }
+  batch::mul(x, y, span<T>{out});
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    DOCTEST_CHECK(same(out[i], T{xs[i] * ys[i]}));
+  }
+  batch::fma(x, y, z, span<T>{out});
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    DOCTEST_CHECK(same(out[i], fma(xs[i], ys[i], zs[i])));
+  }
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("batched arithmetic matches the scalar operators") {
+  rng_t rng{3};
+  for (int rnd : {FE_TONEAREST, FE_UPWARD, FE_DOWNWARD, FE_TOWARDZERO}) {
+    std::fesetround(rnd);
+    check_arith<digits2{128}>(rng, 3);
+    check_arith<digits2{128}>(rng, 300);
+    check_arith<digits2{100}>(rng, 100);
+    check_arith<digits2{65}>(rng, 100);
+    check_arith<digits2{53}>(rng, 100);
+    check_arith<digits2{200}>(rng, 100);
+  }
+  std::fesetround(FE_TONEAREST);
+
+  // results outside the exponent range
+  using T = mp_float_t<digits2{128}>;
+  std::vector<T> big{ldexp(T{1.5}, static_cast<long>(mpfr_get_emax()) - 1), T{3}};
+  std::vector<T> out(2);
+  batch::mul(span<T const>{big}, span<T const>{big}, span<T>{out});
+  DOCTEST_CHECK(isinf(out[0]));
+  DOCTEST_CHECK(out[1] == 9);
+
+  // in place, and the inexact flag
+  std::vector<T> v{T{1}, T{3}};
+  std::vector<T> w{T{1} / 3, T{0.5}};
+  mpfr_clear_flags();
+  batch::add(span<T const>{v}, span<T const>{w}, span<T>{v}, 1);
+  DOCTEST_CHECK(mpfr_inexflag_p());
+  DOCTEST_CHECK(v[0] == 1 + T{1} / 3);
+  DOCTEST_CHECK(v[1] == 3.5);
+}
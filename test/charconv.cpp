@@ -0,0 +1,487 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <fmt/format.h>
+#include "mpfr/charconv.hpp"
+#include "mpfr/external/fmt.hpp"
+#include "mpfr/external/std_format.hpp"
+#include <algorithm>
+#include <cfenv>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{128}>;
+
+static auto reference(scalar_t const& x, char conv, int precision) -> std::string {
+  char format[32];
+  std::snprintf(format, sizeof(format), "%%.%dR%c", precision, conv);
+  char buf[4096];
+  handle_as_mpfr_t([&](mpfr_srcptr x_) { mpfr_snprintf(buf, sizeof(buf), format, x_); }, x);
+  return buf;
+}
+
+static auto make_values() -> std::vector<scalar_t> {
+  std::vector<scalar_t> v{0, 1, 0.5, 0.125, 0.375, 2.5, 9.5, 99.5, 999.999, 1e-5, 1.5e-5, 123456.5,
+                          9.9999999, 0.00095, 1e20};
+  v.push_back(scalar_t{1} / 3);
+  v.push_back(scalar_t{2} / 3);
+  v.push_back(sqrt(scalar_t{2}) * 1e30);
+  v.push_back(sqrt(scalar_t{2}) * 1e-30);
+  v.push_back(exp(scalar_t{1000}));
+  v.push_back(exp(scalar_t{-1000}));
+  std::size_t n = v.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    v.push_back(-v[i]);
+  }
+  return v;
+}
+
+DOCTEST_TEST_CASE("to_chars matches printf") {
+  char buf[4096];
+  for (auto const& x : make_values()) {
+    for (int precision : {0, 1, 2, 3, 6, 17, 40}) {
+      struct {
+        chars_format fmt;
+        char conv;
+      } const cases[] = {
+          {chars_format::scientific, 'e'},
+          {chars_format::fixed, 'f'},
+          {chars_format::general, 'g'},
+      };
+      for (auto c : cases) {
+        auto res = to_chars(buf, buf + sizeof(buf), x, c.fmt, precision);
+        DOCTEST_REQUIRE(res.ec == std::errc{});
+        DOCTEST_CHECK(std::string(buf, res.ptr) == reference(x, c.conv, precision));
+      }
+    }
+  }
+}
+
+DOCTEST_TEST_CASE("to_chars special values and errors") {
+  char buf[64];
+  auto to_string = [&](scalar_t const& x, chars_format fmt, int precision) {
+    auto res = to_chars(buf, buf + sizeof(buf), x, fmt, precision);
+    return std::string(buf, res.ptr);
+  };
+  scalar_t const inf = std::numeric_limits<scalar_t>::infinity();
+  scalar_t const nan = std::numeric_limits<scalar_t>::quiet_NaN();
+  DOCTEST_CHECK(to_string(inf, chars_format::fixed, 2) == "inf");
+  DOCTEST_CHECK(to_string(-inf, chars_format::general, 2) == "-inf");
+  DOCTEST_CHECK(to_string(nan, chars_format::fixed, 2) == "nan");
+  DOCTEST_CHECK(to_string(scalar_t{-0.0}, chars_format::fixed, 2) == "-0.00");
+  DOCTEST_CHECK(to_string(scalar_t{1.5}, chars_format::hex, 2) == "1.80p+0");
+  DOCTEST_CHECK(to_string(scalar_t{0.125}, chars_format::fixed, 2) == "0.12");
+  DOCTEST_CHECK(to_string(scalar_t{0.375}, chars_format::fixed, 2) == "0.38");
+  DOCTEST_CHECK(to_string(scalar_t{999.96}, chars_format::fixed, 1) == "1000.0");
+
+  auto res = to_chars(buf, buf + 4, scalar_t{1234.5}, chars_format::fixed, 1);
+  DOCTEST_CHECK(res.ec == std::errc::value_too_large);
+  DOCTEST_CHECK(res.ptr == buf + 4);
+  res = to_chars(buf, buf + 6, scalar_t{1234.5}, chars_format::fixed, 1);
+  DOCTEST_CHECK(res.ec == std::errc{});
+  DOCTEST_CHECK(std::string(buf, res.ptr) == "1234.5");
+}
+
+template <int N> void check_round_trip(mp_float_t<digits2{N}> const& x) {
+  using T = mp_float_t<digits2{N}>;
+  char buf[1024];
+  auto res = to_chars(buf, buf + sizeof(buf), x);
+  DOCTEST_REQUIRE(res.ec == std::errc{});
+  T y;
+  from_chars(buf, res.ptr, y);
+  DOCTEST_CHECK(y == x);
+
+  // one less significant digit does not read back
+  auto exp_res = to_chars(buf, buf + sizeof(buf), x, chars_format::scientific);
+  char const* const first = buf;
+  char const* e = std::find(first, static_cast<char const*>(exp_res.ptr), 'e');
+  long const n_digits =
+      (e - buf) - (buf[0] == '-' ? 1 : 0) - (std::find(first, e, '.') != e ? 1 : 0);
+  if (n_digits > 1) {
+    auto short_res = to_chars(
+        buf, buf + sizeof(buf), x, chars_format::scientific, static_cast<int>(n_digits - 2));
+    from_chars(buf, short_res.ptr, y);
+    DOCTEST_CHECK(y != x);
+  }
+}
+
+DOCTEST_TEST_CASE("shortest round trip") {
+  using d53_t = mp_float_t<digits2{53}>;
+  char buf[256];
+  auto to_string = [&](d53_t const& x, chars_format fmt) {
+    return std::string(buf, to_chars(buf, buf + sizeof(buf), x, fmt).ptr);
+  };
+  auto shortest = [&](d53_t const& x) {
+    return std::string(buf, to_chars(buf, buf + sizeof(buf), x).ptr);
+  };
+  DOCTEST_CHECK(shortest(0.1) == "0.1");
+  DOCTEST_CHECK(shortest(-0.0) == "-0");
+  DOCTEST_CHECK(shortest(1.0 / 3) == "0.3333333333333333");
+  DOCTEST_CHECK(shortest(1e23) == "1e+23");
+  DOCTEST_CHECK(shortest(123456.0) == "123456");
+  DOCTEST_CHECK(shortest(1e-5) == "1e-05");
+  DOCTEST_CHECK(shortest(0.001) == "0.001");
+  DOCTEST_CHECK(shortest(9007199254740993.0) == "9007199254740992");
+  DOCTEST_CHECK(to_string(1e23, chars_format::fixed) == "99999999999999991611392");
+  DOCTEST_CHECK(to_string(1e5, chars_format::general) == "100000");
+  DOCTEST_CHECK(to_string(1234567.0, chars_format::general) == "1.234567e+06");
+  DOCTEST_CHECK(to_string(0.1, chars_format::scientific) == "1e-01");
+  DOCTEST_CHECK(to_string(1.5e-5, chars_format::general) == "1.5e-05");
+  DOCTEST_CHECK(to_string(1.5, chars_format::hex) == "1.8p+0");
+
+  for (auto const& x : make_values()) {
+    check_round_trip<128>(x);
+    check_round_trip<53>(mp_float_t<digits2{53}>{x});
+    check_round_trip<1000>(mp_float_t<digits2{1000}>{x} / 7);
+  }
+  // powers of two have a narrower interval below them
+  for (long e = -200; e <= 200; e += 7) {
+    check_round_trip<53>(mpfr::ldexp(d53_t{1}, e));
+    check_round_trip<64>(mpfr::ldexp(mp_float_t<digits2{64}>{1}, e));
+  }
+}
+
+DOCTEST_TEST_CASE("from_chars") {
+  auto parse = [](char const* s, chars_format fmt = chars_format::general) {
+    scalar_t x = 42;
+    auto res = from_chars(s, s + std::strlen(s), x, fmt);
+    return std::make_pair(x, res);
+  };
+
+  auto r = parse("1.25e2xyz");
+  DOCTEST_CHECK(r.first == 125);
+  DOCTEST_CHECK(r.second.ec == std::errc{});
+  DOCTEST_CHECK(*r.second.ptr == 'x');
+
+  r = parse("-.5e");
+  DOCTEST_CHECK(r.first == -0.5);
+  DOCTEST_CHECK(*r.second.ptr == 'e');
+
+  r = parse("1.25e2", chars_format::fixed);
+  DOCTEST_CHECK(r.first == 1.25);
+  r = parse("1.25", chars_format::scientific);
+  DOCTEST_CHECK(r.second.ec == std::errc::invalid_argument);
+  DOCTEST_CHECK(r.first == 42);
+  r = parse("1.8p3", chars_format::hex);
+  DOCTEST_CHECK(r.first == 12);
+  r = parse("+1");
+  DOCTEST_CHECK(r.second.ec == std::errc::invalid_argument);
+  r = parse("-InFinity");
+  DOCTEST_CHECK(r.first == -std::numeric_limits<scalar_t>::infinity());
+  r = parse("nan(123)x");
+  DOCTEST_CHECK(isnan(r.first));
+  DOCTEST_CHECK(*r.second.ptr == 'x');
+  r = parse("1e999999999999");
+  DOCTEST_CHECK(r.second.ec == std::errc::result_out_of_range);
+  DOCTEST_CHECK(r.first == 42);
+
+  // the input is not read past the end of the range
+  char const s[] = {'0', '.', '3', '3', '3'};
+  scalar_t x;
+  from_chars(s, s + 4, x);
+  DOCTEST_CHECK(x == scalar_t{33} / 100);
+
+  char buf[128];
+  for (auto const& v : make_values()) {
+    auto res = to_chars(buf, buf + sizeof(buf), v, chars_format::scientific, 40);
+    scalar_t y;
+    from_chars(buf, res.ptr, y);
+    DOCTEST_CHECK(y == v);
+  }
+}
+
+DOCTEST_TEST_CASE("hex and binary") {
+  using d53_t = mp_float_t<digits2{53}>;
+  char buf[1024];
+  auto to_string = [&](d53_t const& x, chars_format fmt, int precision) {
+    return std::string(buf, to_chars(buf, buf + sizeof(buf), x, fmt, precision).ptr);
+  };
+  auto parse = [](char const* s, chars_format fmt) {
+    d53_t x = 42;
+    from_chars(s, s + std::strlen(s), x, fmt);
+    return x;
+  };
+
+  DOCTEST_CHECK(to_string(1, chars_format::hex, -1) == "1p+0");
+  DOCTEST_CHECK(to_string(-0.0, chars_format::hex, -1) == "-0p+0");
+  DOCTEST_CHECK(to_string(0, chars_format::hex, 3) == "0.000p+0");
+  DOCTEST_CHECK(to_string(0.1, chars_format::hex, -1) == "1.999999999999ap-4");
+  DOCTEST_CHECK(to_string(0.1, chars_format::hex, 3) == "1.99ap-4");
+  DOCTEST_CHECK(to_string(1.03125, chars_format::hex, 1) == "1.0p+0");
+  DOCTEST_CHECK(to_string(1.09375, chars_format::hex, 1) == "1.2p+0");
+  DOCTEST_CHECK(to_string(1.96875, chars_format::hex, 1) == "2.0p+0");
+  DOCTEST_CHECK(to_string(0x1.fp+1023, chars_format::hex, 0) == "2p+1023");
+  DOCTEST_CHECK(to_string(6, chars_format::binary, -1) == "1.1p+2");
+  DOCTEST_CHECK(to_string(-0.375, chars_format::binary, 3) == "-1.100p-2");
+  DOCTEST_CHECK(to_string(1.75, chars_format::binary, 1) == "1.0p+1");
+
+  DOCTEST_CHECK(parse("1.999999999999ap-4", chars_format::hex) == 0.1);
+  DOCTEST_CHECK(parse("-0.0000", chars_format::hex) == 0);
+  DOCTEST_CHECK(parse("0.0008P+13", chars_format::hex) == 1);
+  DOCTEST_CHECK(parse("FF.8", chars_format::hex) == 255.5);
+  DOCTEST_CHECK(parse("110.01p-1", chars_format::binary) == 3.125);
+  // 2^53 + 1 rounds to even, anything above it rounds up
+  DOCTEST_CHECK(parse("20000000000001", chars_format::hex) == 9007199254740992.0);
+  DOCTEST_CHECK(parse("200000000000010000000001", chars_format::hex) > 9007199254740992.0);
+  DOCTEST_CHECK(parse("20000000000003", chars_format::hex) == 9007199254740996.0);
+  DOCTEST_CHECK(parse("1p-99999999999999999999", chars_format::hex) == 42);
+  DOCTEST_CHECK(parse("1p+99999999999999999999", chars_format::binary) == 42);
+
+  // exact output reads back at any precision
+  for (auto const& x : make_values()) {
+    for (auto fmt : {chars_format::hex, chars_format::binary}) {
+      auto res = to_chars(buf, buf + sizeof(buf), x, fmt);
+      DOCTEST_REQUIRE(res.ec == std::errc{});
+      scalar_t y;
+      from_chars(buf, res.ptr, y, fmt);
+      DOCTEST_CHECK(y == x);
+      DOCTEST_CHECK(*(res.ptr - 1) != '.');
+
+      mp_float_t<digits2{1000}> const z = mp_float_t<digits2{1000}>{x} / 7;
+      res = to_chars(buf, buf + sizeof(buf), z, fmt);
+      if (fmt == chars_format::hex) {
+        mp_float_t<digits2{1000}> w;
+        from_chars(buf, res.ptr, w, fmt);
+        DOCTEST_CHECK(w == z);
+      }
+    }
+  }
+}
+
+static void check_long_decimal_conversions() {
+  using big_t = mp_float_t<digits2{200'000}>;
+  std::vector<big_t> xs(2, sqrt(big_t{2}) / 3);
+  xs[1] = mpfr::ldexp(xs[1], -300'000);
+
+  for (auto const& x : xs) {
+    for (int precision : {20'000, 60'205, 70'000}) {
+      std::vector<char> buf(static_cast<std::size_t>(precision) + 64);
+      std::vector<char> ref(buf.size());
+      auto res = to_chars(
+          buf.data(), buf.data() + buf.size(), x, chars_format::scientific, precision);
+      DOCTEST_REQUIRE(res.ec == std::errc{});
+      handle_as_mpfr_t(
+          [&](mpfr_srcptr x_) { mpfr_snprintf(ref.data(), ref.size(), "%.*Re", precision, x_); },
+          x);
+      DOCTEST_CHECK(std::string(buf.data(), res.ptr) == std::string(ref.data()));
+
+      big_t y;
+      big_t y_ref;
+      from_chars(buf.data(), res.ptr, y);
+      handle_as_mpfr_t(
+          [&](mpfr_ptr y_) { mpfr_strtofr(y_, ref.data(), nullptr, 10, MPFR_RNDN); }, y_ref);
+      DOCTEST_CHECK(y == y_ref);
+    }
+  }
+
+  // 1 + 2^-53 is an exact tie between two neighbours, rounded to even
+  std::string tie = "1.00000000000000011102230246251565404236316680908203125";
+  tie += std::string(30'000, '0');
+  mp_float_t<digits2{53}> z;
+  from_chars(tie.data(), tie.data() + tie.size(), z);
+  DOCTEST_CHECK(z == 1);
+  tie += '1';
+  from_chars(tie.data(), tie.data() + tie.size(), z);
+  DOCTEST_CHECK(z == 1 + std::ldexp(1.0, -52));
+}
+
+DOCTEST_TEST_CASE("long decimal conversions") {
+  check_long_decimal_conversions();
+
+  // the divide and conquer algorithms are otherwise only used with several threads
+  _::radix_dc_forced() = true;
+  check_long_decimal_conversions();
+  for (int rnd : {FE_TONEAREST, FE_UPWARD, FE_DOWNWARD, FE_TOWARDZERO}) {
+    std::fesetround(rnd);
+    for (double d : {1.0 / 3, -2.5e-300, 1e300, 123456789.0}) {
+      scalar_t const x{d};
+      char buf[256];
+      char ref[256];
+      auto res = to_chars(buf, buf + sizeof(buf), x, chars_format::scientific, 40);
+      DOCTEST_REQUIRE(res.ec == std::errc{});
+      handle_as_mpfr_t([&](mpfr_srcptr x_) { mpfr_snprintf(ref, sizeof(ref), "%.40Re", x_); }, x);
+      DOCTEST_CHECK(std::string(buf, res.ptr) == std::string(ref));
+      scalar_t y;
+      from_chars(buf, res.ptr, y);
+      scalar_t y_ref;
+      handle_as_mpfr_t(
+          [&](mpfr_ptr y_) { mpfr_strtofr(y_, ref, nullptr, 10, _::get_rnd()); }, y_ref);
+      DOCTEST_CHECK(y == y_ref);
+    }
+  }
+  std::fesetround(FE_TONEAREST);
+  _::radix_dc_forced() = false;
+}
+
+DOCTEST_TEST_CASE("ostream and fmt output") {
+  scalar_t x = scalar_t{-2} / 3;
+  std::ostringstream ss;
+  ss << x << ' ' << std::setprecision(3) << std::setw(10) << std::left << x << '|';
+  ss << std::showpos << std::fixed << std::setprecision(2) << scalar_t{0.5} << ' ';
+  ss << std::noshowpos << std::scientific << std::uppercase << scalar_t{1234} << ' ';
+  ss << std::defaultfloat << std::showpoint << scalar_t{0.5};
+  DOCTEST_CHECK(ss.str() == "-0.666667 -0.667    |+0.50 1.23E+03 0.50");
+
+  DOCTEST_CHECK(fmt::format("{:g}", x) == "-0.666667");
+  DOCTEST_CHECK(fmt::format("{}", x) == fmt::format("{:r}", x));
+  DOCTEST_CHECK(fmt::format("{:.3}", x) == "-0.667");
+  DOCTEST_CHECK(fmt::format("{:>6}|{:<+6}|", scalar_t{0.5}, scalar_t{1e20}) == "   0.5|+1e+20|");
+  DOCTEST_CHECK(fmt::format("{:>10.3f}|{:<+8.1e}|", x, scalar_t{12}) == "    -0.667|+1.2e+01|");
+  DOCTEST_CHECK(fmt::format("{:*^9.2f}", scalar_t{1}) == "**1.00***");
+  DOCTEST_CHECK(fmt::format("{: .2f}", scalar_t{1}) == " 1.00");
+  // a width of one does not pad
+  DOCTEST_CHECK(fmt::format("{:1}|{:{}}", scalar_t{2}, scalar_t{2}, 1) == "2|2");
+  DOCTEST_CHECK(fmt::format("{:1}", x) == fmt::format("{}", x));
+  DOCTEST_CHECK(fmt::format("{:#.3g}", scalar_t{1}) == "1.00");
+  DOCTEST_CHECK(fmt::format("{:.{}f}", scalar_t{1} / 3, 1000).size() == 1002);
+  DOCTEST_CHECK(
+      fmt::format("{:a}|{:.3A}", scalar_t{1.5}, scalar_t{-0.1}) == "0x1.8p+0|-0X1.99AP-4");
+  DOCTEST_CHECK(fmt::format("{:b}|{:.2b}", scalar_t{6}, scalar_t{6}) == "1.1p+2|1.10p+2");
+
+  // contiguous outputs are written in place, others through a staging buffer
+  std::string str;
+  fmt::format_to(std::back_inserter(str), "{}|{:>5}|", scalar_t{0.5}, scalar_t{1});
+  DOCTEST_CHECK(str == "0.5|    1|");
+  char chars[32] = {};
+  *fmt::format_to(chars, "{:.3f}|{:^7.1f}", x, scalar_t{2}) = '\0';
+  DOCTEST_CHECK(std::string(chars) == "-0.667|  2.0  ");
+  auto res = fmt::format_to_n(chars, 5, "{:.10f}", x);
+  DOCTEST_CHECK(res.size == 13);
+  DOCTEST_CHECK(std::string(chars, 5) == "-0.66");
+  std::vector<char> vec;
+  fmt::format_to(std::back_inserter(vec), "{:e}", scalar_t{-1} / 3);
+  DOCTEST_CHECK(std::string(vec.begin(), vec.end()) == "-3.333333e-01");
+  std::string long_str(3000, 'x');
+  fmt::format_to(std::back_inserter(long_str), "{:.2000f}{:\u00e9<4}", x, scalar_t{1});
+  DOCTEST_CHECK(long_str.size() == 3000 + 2003 + 7);
+  DOCTEST_CHECK(long_str.substr(3000, 7) == "-0.6666");
+  DOCTEST_CHECK(long_str.substr(long_str.size() - 7) == "1\u00e9\u00e9\u00e9");
+
+  std::ostringstream hex_ss;
+  hex_ss << std::hexfloat << scalar_t{-1.5};
+  DOCTEST_CHECK(hex_ss.str() == "-0x1.8p+0");
+}
+
+DOCTEST_TEST_CASE("ostream padding and write_many") {
+  scalar_t x = scalar_t{-2} / 3;
+  std::ostringstream ss;
+  ss << std::setprecision(3) << std::setw(8) << x << '|' << std::setw(8) << std::internal << x
+     << '|' << std::setfill('*') << std::showpos << std::setw(8) << scalar_t{1.5} << '|'
+     << std::left << std::setw(2) << x << '|' << scalar_t{0.25};
+  DOCTEST_CHECK(ss.str() == "  -0.667|-  0.667|+****1.5|-0.667|+0.25");
+
+  // the width is larger than the stack buffer
+  std::ostringstream wide_field;
+  wide_field << std::setw(5000) << std::setfill('.') << x;
+  DOCTEST_CHECK(wide_field.str().size() == 5000);
+  DOCTEST_CHECK(wide_field.str().substr(4990) == ".-0.666667");
+
+  std::wostringstream wss;
+  wss << std::setw(10) << std::internal << std::setprecision(3) << x << L'|' << scalar_t{2};
+  DOCTEST_CHECK(wss.str() == L"-    0.667|2");
+
+  std::vector<scalar_t> xs{1, -0.5, 0.25, 100, -1e30};
+  std::ostringstream table;
+  table << std::setw(7);
+  write_many(table, span<scalar_t const>{xs}, 2);
+  DOCTEST_CHECK(table.str() == "      1    -0.5\n   0.25     100\n -1e+30\n");
+  DOCTEST_CHECK(table.width() == 0);
+
+  std::ostringstream csv;
+  csv << std::fixed << std::setprecision(1);
+  write_many(csv, span<scalar_t const>{xs}, 5, ',');
+  DOCTEST_CHECK(csv.str() == "1.0,-0.5,0.2,100.0,-1000000000000000019884624838656.0\n");
+
+  std::wostringstream wtable;
+  wtable << std::setw(5);
+  write_many(wtable, span<scalar_t const>{xs.data(), 3});
+  DOCTEST_CHECK(wtable.str() == L"    1\n -0.5\n 0.25\n");
+
+  // enough values to span several chunks
+  std::vector<scalar_t> many(20000, scalar_t{1} / 3);
+  std::ostringstream many_ss;
+  many_ss << std::setprecision(30);
+  write_many(many_ss, span<scalar_t const>{many}, 4, ';');
+  std::string const s = many_ss.str();
+  DOCTEST_CHECK(s.size() == 20000 * 33);
+  DOCTEST_CHECK(std::count(s.begin(), s.end(), '\n') == 5000);
+  DOCTEST_CHECK(s.substr(0, 33) == "0.333333333333333333333333333333;");
+}
+
+DOCTEST_TEST_CASE("istream input") {
+  std::istringstream ss{"  1.5 -2e3\t+0x1.8p1 inf -nan(x1) 1e 7"};
+  scalar_t x;
+  ss >> x;
+  DOCTEST_CHECK(x == 1.5);
+  ss >> x;
+  DOCTEST_CHECK(x == -2000);
+  ss >> x;
+  DOCTEST_CHECK(x == 3);
+  ss >> x;
+  DOCTEST_CHECK(isinf(x));
+  ss >> x;
+  DOCTEST_CHECK(isnan(x));
+  DOCTEST_CHECK(signbit(x));
+  DOCTEST_CHECK(ss);
+  x = 4;
+  ss >> x;
+  DOCTEST_CHECK(ss.fail());
+  DOCTEST_CHECK(x == 4);
+
+  // the number ends at the first character that cannot continue it
+  std::istringstream rest{"0.25,12abc .5e-1"};
+  rest >> x;
+  DOCTEST_CHECK(x == 0.25);
+  DOCTEST_CHECK(rest.get() == ',');
+  rest >> x;
+  DOCTEST_CHECK(x == 12);
+  DOCTEST_CHECK(rest.get() == 'a');
+  rest.ignore(3);
+  rest >> x;
+  DOCTEST_CHECK(x == scalar_t{1} / 20);
+  DOCTEST_CHECK(rest.eof());
+  DOCTEST_CHECK(not rest.fail());
+
+  std::istringstream out_of_range{"1e999999999999"};
+  out_of_range >> x;
+  DOCTEST_CHECK(out_of_range.fail());
+  DOCTEST_CHECK(x == scalar_t{1} / 20);
+
+  // longer than the stack buffer
+  std::string digits = "0." + std::string(1000, '3');
+  std::istringstream long_ss{digits};
+  long_ss >> x;
+  DOCTEST_CHECK(x == scalar_t{1} / 3);
+
+  std::wistringstream wss{L" -0.5 x"};
+  wss >> x;
+  DOCTEST_CHECK(x == -0.5);
+  wss >> x;
+  DOCTEST_CHECK(wss.fail());
+
+  // round trip through the stream output
+  std::stringstream io;
+  scalar_t const y = scalar_t{-2} / 3;
+  io << std::setprecision(40) << y;
+  io >> x;
+  DOCTEST_CHECK(x == y);
+}
+
+#if defined(__cpp_lib_format)
+DOCTEST_TEST_CASE("std::format output") {
+  scalar_t x = scalar_t{-2} / 3;
+  DOCTEST_CHECK(std::format("{}", x) == fmt::format("{}", x));
+  DOCTEST_CHECK(std::format("{:>10.3f}|{:<+8.1e}|", x, scalar_t{12}) == "    -0.667|+1.2e+01|");
+  DOCTEST_CHECK(std::format("{:*^9.2f}", scalar_t{1}) == "**1.00***");
+  DOCTEST_CHECK(std::format("{:{}.{}f}", x, 8, 2) == "   -0.67");
+  DOCTEST_CHECK(std::format("{:.3A}", scalar_t{-0.1}) == "-0X1.99AP-4");
+  std::string str;
+  std::format_to(std::back_inserter(str), "{:.2000f}", x);
+  DOCTEST_CHECK(str.size() == 2003);
+}
+#endif
@@ -0,0 +1,101 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/columns.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{128}>;
+
+DOCTEST_TEST_CASE("parse columns") {
+  std::string const text = "1, 2.5,-3\n"
+                           "\n"
+                           "  4e2 ,0x10,6\r\n"
+                           "7,,9\n"
+                           "10,11\n"
+                           "12,13,14,15\n"
+                           "inf, -0 ,1e999999999999\n";
+  std::vector<scalar_t> a(10);
+  std::vector<scalar_t> b(10);
+  std::vector<scalar_t> c(10);
+  auto res = parse_columns<digits2{128}>(text, {}, a, b, c);
+
+  DOCTEST_CHECK(res.n_rows == 6);
+  DOCTEST_CHECK(res.ptr == text.data() + text.size());
+  DOCTEST_CHECK(a[0] == 1);
+  DOCTEST_CHECK(b[0] == 2.5);
+  DOCTEST_CHECK(c[0] == -3);
+  DOCTEST_CHECK(a[1] == 400);
+  DOCTEST_CHECK(isnan(b[1]));
+  DOCTEST_CHECK(c[1] == 6);
+  DOCTEST_CHECK(a[2] == 7);
+  DOCTEST_CHECK(c[2] == 9);
+  DOCTEST_CHECK(b[3] == 11);
+  DOCTEST_CHECK(isnan(c[3]));
+  DOCTEST_CHECK(c[4] == 14);
+  DOCTEST_CHECK(isinf(a[5]));
+  DOCTEST_CHECK(b[5] == 0);
+  DOCTEST_CHECK(signbit(b[5]));
+
+  DOCTEST_REQUIRE(res.errors.size() == 5);
+  std::size_t const expected[][2] = {{1, 1}, {2, 1}, {3, 2}, {4, 3}, {5, 2}};
+  for (std::size_t i = 0; i < 5; ++i) {
+    DOCTEST_CHECK(res.errors[i].row == expected[i][0]);
+    DOCTEST_CHECK(res.errors[i].column == expected[i][1]);
+  }
+  DOCTEST_CHECK(res.errors[0].ec == std::errc::invalid_argument);
+  DOCTEST_CHECK(res.errors[4].ec == std::errc::result_out_of_range);
+}
+
+DOCTEST_TEST_CASE("parse whitespace columns") {
+  std::string const text = " 1\t 2  \n3 4 5\n6\n7 8\n9 10\n";
+  std::vector<scalar_t> a(4);
+  std::vector<scalar_t> b(4);
+  columns_format_t format;
+  format.separator = ' ';
+  auto res = parse_columns<digits2{128}>(text, format, a, span<scalar_t>{b});
+
+  // stops once the columns are full
+  DOCTEST_CHECK(res.n_rows == 4);
+  DOCTEST_CHECK(std::string(res.ptr) == "9 10\n");
+  DOCTEST_CHECK(a[0] == 1);
+  DOCTEST_CHECK(b[0] == 2);
+  DOCTEST_CHECK(a[1] == 3);
+  DOCTEST_CHECK(b[1] == 4);
+  DOCTEST_CHECK(a[2] == 6);
+  DOCTEST_CHECK(isnan(b[2]));
+  DOCTEST_CHECK(a[3] == 7);
+  DOCTEST_CHECK(b[3] == 8);
+  DOCTEST_REQUIRE(res.errors.size() == 2);
+  DOCTEST_CHECK(res.errors[0].row == 1);
+  DOCTEST_CHECK(res.errors[0].column == 2);
+  DOCTEST_CHECK(res.errors[1].row == 2);
+  DOCTEST_CHECK(res.errors[1].column == 1);
+}
+
+DOCTEST_TEST_CASE("parse many columns") {
+  std::size_t const n = 10000;
+  std::vector<scalar_t> xs(n);
+  std::vector<scalar_t> ys(n);
+  std::string text;
+  char buf[128];
+  for (std::size_t i = 0; i < n; ++i) {
+    xs[i] = sqrt(scalar_t{static_cast<long>(i)});
+    ys[i] = -xs[i] / 7;
+    text.append(buf, to_chars(buf, buf + sizeof(buf), xs[i]).ptr);
+    text += ',';
+    text.append(buf, to_chars(buf, buf + sizeof(buf), ys[i]).ptr);
+    text += '\n';
+  }
+
+  std::vector<scalar_t> a(n);
+  std::vector<scalar_t> b(n);
+  auto res = parse_columns<digits2{128}>(text, {}, a, b);
+  DOCTEST_CHECK(res.n_rows == n);
+  DOCTEST_CHECK(res.errors.empty());
+  DOCTEST_CHECK(std::memcmp(a.data(), xs.data(), n * sizeof(scalar_t)) == 0);
+  DOCTEST_CHECK(std::memcmp(b.data(), ys.data(), n * sizeof(scalar_t)) == 0);
+}
@@ -0,0 +1,151 @@
+#define MPFR_CXX_DEBUG 1
+#define MPFR_CXX_USE_FLOAT128 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/mp_float.hpp"
+#include <cfenv>
+#include <cmath>
+#include <cstdint>
+
+using namespace mpfr;
+
+namespace {
+
+struct rng_t {
+  std::uint64_t state;
+  auto next() -> std::uint64_t {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state;
+  }
+  // random significand with random trailing zeros, and an exponent in [-e, e]
+  auto next_value(int e) -> double {
+    std::uint64_t const bits = next();
+    double const m = static_cast<double>((bits >> 11U) >> ((bits >> 3U) % 40)) + 1;
+    int const exp = static_cast<int>(next() % static_cast<std::uint64_t>(2 * e + 1)) - e;
+    return ((bits & 1U) != 0 ? -1 : 1) * std::ldexp(m, exp - 53);
+  }
+};
+
+using mpfr_fn_t = int (*)(mpfr_ptr, mpfr_srcptr, mpfr_srcptr, mpfr_rnd_t);
+
+// result and inexact flag of the operation computed directly by mpfr
+template <precision_t P>
+auto reference(mpfr_fn_t fn, mp_float_t<P> const& a, mp_float_t<P> const& b, bool& inexact)
+    -> mp_float_t<P> {
+  mpfr_t z;
+  mpfr_init2(z, static_cast<mpfr_prec_t>(P));
+  _::mpfr_cref_t const x = _::impl_access::mpfr_cref(a);
+  _::mpfr_cref_t const y = _::impl_access::mpfr_cref(b);
+  mpfr_clear_flags();
+  fn(z, &x.m, &y.m, _::get_rnd());
+  inexact = mpfr_inexflag_p() != 0;
+  mp_float_t<P> out;
+  {
+    _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(out);
+    mpfr_set(&g.m, z, MPFR_RNDN);
+  }
+  mpfr_clear(z);
+  return out;
+}
+
+template <precision_t P> void check_against_mpfr(rng_t& rng, int max_exp) {
+  for (int i = 0; i < 4000; ++i) {
+    mp_float_t<P> const a{rng.next_value(max_exp)};
+    mp_float_t<P> const b = (i % 4 == 0) ? -a * (1 + rng.next_value(1) * 0x1p-40)
+                                         : mp_float_t<P>{rng.next_value(max_exp)};
+    bool ref_inexact = false;
+    mp_float_t<P> const ref_sum = reference(mpfr_add, a, b, ref_inexact);
+    mpfr_clear_flags();
+    mp_float_t<P> const sum = a + b;
+    DOCTEST_CHECK(sum == ref_sum);
+    DOCTEST_CHECK(signbit(sum) == signbit(ref_sum));
+    DOCTEST_CHECK((mpfr_inexflag_p() != 0) == ref_inexact);
+
+    mp_float_t<P> const ref_diff = reference(mpfr_sub, a, b, ref_inexact);
+    mpfr_clear_flags();
+    mp_float_t<P> const diff = a - b;
+    DOCTEST_CHECK(diff == ref_diff);
+    DOCTEST_CHECK(signbit(diff) == signbit(ref_diff));
+    DOCTEST_CHECK((mpfr_inexflag_p() != 0) == ref_inexact);
+
+    mp_float_t<P> const ref_prod = reference(mpfr_mul, a, b, ref_inexact);
+    mpfr_clear_flags();
+    DOCTEST_CHECK(a * b == ref_prod);
+    DOCTEST_CHECK((mpfr_inexflag_p() != 0) == ref_inexact);
+
+    mp_float_t<P> const ref_quot = reference(mpfr_div, a, b, ref_inexact);
+    mpfr_clear_flags();
+    DOCTEST_CHECK(a / b == ref_quot);
+    DOCTEST_CHECK((mpfr_inexflag_p() != 0) == ref_inexact);
+  }
+}
+
+} // namespace
+
+DOCTEST_TEST_CASE("float128 backend matches mpfr") {
+  rng_t rng{1};
+  for (int rnd : {FE_TONEAREST, FE_UPWARD, FE_DOWNWARD, FE_TOWARDZERO}) {
+    std::fesetround(rnd);
+    check_against_mpfr<digits2{53}>(rng, 4);
+    check_against_mpfr<digits2{53}>(rng, 200);
+    check_against_mpfr<digits2{63}>(rng, 70);
+    check_against_mpfr<digits2{24}>(rng, 30);
+    check_against_mpfr<digits2{2}>(rng, 3);
+  }
+  std::fesetround(FE_TONEAREST);
+}
+
+DOCTEST_TEST_CASE("float128 backend special values") {
+  using scalar_t = mp_float_t<digits2{53}>;
+  scalar_t const inf = std::numeric_limits<scalar_t>::infinity();
+  scalar_t const one = 1;
+  DOCTEST_CHECK(isinf(one / scalar_t{0}));
+  DOCTEST_CHECK(isnan(inf - inf));
+  DOCTEST_CHECK(one - one == 0);
+  DOCTEST_CHECK(not signbit(one - one));
+  DOCTEST_CHECK(one + scalar_t{0x1p-53} == one);
+  DOCTEST_CHECK(one + scalar_t{0x1.8p-53} == scalar_t{1 + 0x1p-52});
+
+  // results outside the exponent range are left to mpfr
+  scalar_t const big = ldexp(scalar_t{1.5}, 100000);
+  DOCTEST_CHECK(big * big == ldexp(scalar_t{2.25}, 200000));
+  scalar_t const huge = ldexp(scalar_t{1.5}, static_cast<long>(mpfr_get_emax()) - 10);
+  mpfr_clear_flags();
+  DOCTEST_CHECK(isinf(huge * huge));
+  DOCTEST_CHECK(mpfr_overflow_p());
+  DOCTEST_CHECK(one / huge * (one / huge) == 0);
+  DOCTEST_CHECK(mpfr_underflow_p());
+
+  // mixed precisions
+  mp_float_t<digits2{24}> const third_24 = one / 3;
+  scalar_t const sum = third_24 + one / 3;
+  double const third_24_d = static_cast<double>(static_cast<long double>(third_24));
+  DOCTEST_CHECK(sum == scalar_t{third_24_d + 1.0 / 3});
+}
+
+DOCTEST_TEST_CASE("float128 conversions") {
+  using q113_t = mp_float_t<digits2{113}>;
+  using scalar_t = mp_float_t<digits2{53}>;
+  __float128 const third = __float128{1} / 3;
+  DOCTEST_CHECK(static_cast<__float128>(q113_t{third}) == third);
+  DOCTEST_CHECK(static_cast<__float128>(q113_t{1} / 3) == third);
+  DOCTEST_CHECK(static_cast<__float128>(scalar_t{third}) == __float128{1.0 / 3});
+  DOCTEST_CHECK(q113_t{third} + 1 == q113_t{third + 1});
+
+  // subnormals and overflow
+  __float128 tiny = 1;
+  for (int i = 0; i < 16490; ++i) {
+    tiny /= 2;
+  }
+  DOCTEST_CHECK(q113_t{tiny} == ldexp(q113_t{1}, -16490));
+  DOCTEST_CHECK(static_cast<__float128>(ldexp(q113_t{1}, -16490)) == tiny);
+  DOCTEST_CHECK(static_cast<__float128>(ldexp(q113_t{3}, -16496)) == tiny / 16);
+  DOCTEST_CHECK(static_cast<__float128>(ldexp(q113_t{1}, -16496)) == 0);
+  __float128 const inf = static_cast<__float128>(ldexp(q113_t{1}, 20000));
+  DOCTEST_CHECK(inf > 0);
+  DOCTEST_CHECK(inf - inf != inf - inf);
+  DOCTEST_CHECK(isinf(q113_t{inf}));
+  DOCTEST_CHECK(isnan(q113_t{inf - inf}));
+  DOCTEST_CHECK(signbit(q113_t{-__float128{0}}));
+}
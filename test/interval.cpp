@@ -0,0 +1,95 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/interval.hpp"
+#include <cfenv>
+#include <limits>
+
+using namespace mpfr;
+using interval = interval_t<digits2{128}>;
+using scalar_t = mp_float_t<digits2{128}>;
+using reference_t = mp_float_t<digits2{1024}>;
+
+template <typename T> auto encloses(interval const& x, T const& ref) -> bool {
+  return x.lo() <= ref and ref <= x.hi();
+}
+
+DOCTEST_TEST_CASE("interval arithmetic") {
+  interval sum;
+  reference_t ref_sum;
+  for (long k = 1; k <= 1000; ++k) {
+    sum += interval{1} / interval{k};
+    ref_sum += reference_t{1} / reference_t{k};
+  }
+  DOCTEST_CHECK(encloses(sum, ref_sum));
+  DOCTEST_CHECK(sum.lo() < sum.hi());
+  DOCTEST_CHECK(sum.width() < mpfr::ldexp(scalar_t{1}, -110));
+
+  interval const a{scalar_t{-2}, scalar_t{3}};
+  interval const b{scalar_t{-5}, scalar_t{4}};
+  interval const p = a * b;
+  DOCTEST_CHECK(p.lo() == -15);
+  DOCTEST_CHECK(p.hi() == 12);
+  interval const d = a - b;
+  DOCTEST_CHECK(d.lo() == -6);
+  DOCTEST_CHECK(d.hi() == 8);
+  DOCTEST_CHECK(isinf((a / b).lo()));
+  DOCTEST_CHECK(isinf((a / b).hi()));
+  DOCTEST_CHECK(sqr(a).lo() == 0);
+  DOCTEST_CHECK(sqr(a).hi() == 9);
+
+  scalar_t const inf = std::numeric_limits<scalar_t>::infinity();
+  interval const unbounded = interval{scalar_t{0}, scalar_t{1}} * interval{scalar_t{1}, inf};
+  DOCTEST_CHECK(unbounded.lo() == 0);
+  DOCTEST_CHECK(isinf(unbounded.hi()));
+  interval const q = interval{scalar_t{1}, inf} / interval{scalar_t{1}, inf};
+  DOCTEST_CHECK(q.lo() == 0);
+  DOCTEST_CHECK(isinf(q.hi()));
+
+  // enclosures of numbers that are not representable
+  interval const third{reference_t{1} / 3};
+  DOCTEST_CHECK(third.lo() < third.hi());
+  DOCTEST_CHECK(encloses(third, reference_t{1} / 3));
+}
+
+DOCTEST_TEST_CASE("interval functions") {
+  interval const x{scalar_t{1} / 3, scalar_t{1} / 2};
+  reference_t const ref = reference_t{5} / 12;
+
+  DOCTEST_CHECK(encloses(exp(x), exp(ref)));
+  DOCTEST_CHECK(encloses(log(x), log(ref)));
+  DOCTEST_CHECK(encloses(sqrt(x), sqrt(ref)));
+  DOCTEST_CHECK(encloses(acos(x), acos(ref)));
+  DOCTEST_CHECK(encloses(erfc(x), erfc(ref)));
+  DOCTEST_CHECK(encloses(cosh(-x), cosh(ref)));
+  DOCTEST_CHECK(encloses(sin(x), sin(ref)));
+  DOCTEST_CHECK(encloses(cos(x), cos(ref)));
+  DOCTEST_CHECK(sin(x).hi() < 1);
+
+  auto const range = [](double lo, double hi) { return interval{scalar_t{lo}, scalar_t{hi}}; };
+  DOCTEST_CHECK(cos(range(-1, 1)).hi() == 1);
+  DOCTEST_CHECK(cos(range(-1, 1)).lo() > 0.5);
+  DOCTEST_CHECK(cos(range(3, 3.5)).lo() == -1);
+  DOCTEST_CHECK(cos(range(3, 3.5)).hi() < -0.9);
+  DOCTEST_CHECK(sin(range(1, 2)).hi() == 1);
+  DOCTEST_CHECK(sin(range(4, 5)).lo() == -1);
+  DOCTEST_CHECK(sin(range(4, 5)).hi() < -0.7);
+  DOCTEST_CHECK(sin(range(-5, -4)).hi() == 1);
+  DOCTEST_CHECK(cos(range(0, 7)).lo() == -1);
+  DOCTEST_CHECK(cos(range(0, 7)).hi() == 1);
+  DOCTEST_CHECK(sin(range(-1, 1e30)).lo() == -1);
+}
+
+DOCTEST_TEST_CASE("interval rounding mode") {
+  interval const x{scalar_t{2}, scalar_t{3}};
+  interval const y = exp(x) / (x + interval{7});
+
+  std::fesetround(FE_DOWNWARD);
+  interval const y_down = exp(x) / (x + interval{7});
+  DOCTEST_CHECK(std::fegetround() == FE_DOWNWARD);
+  std::fesetround(FE_TONEAREST);
+
+  DOCTEST_CHECK(y.lo() == y_down.lo());
+  DOCTEST_CHECK(y.hi() == y_down.hi());
+}
@@ -0,0 +1,223 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/linalg.hpp"
+#include <vector>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{256}>;
+using linalg::matrix_view;
+
+static auto make_matrix(std::size_t rows, std::size_t cols, long seed) -> std::vector<scalar_t> {
+  std::vector<scalar_t> m(rows * cols);
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    bool const negative = (i + static_cast<std::size_t>(seed)) % 3 == 0;
+    m[i] = sqrt(scalar_t{static_cast<long>(i) + seed}) * (negative ? -1 : 1) / 7;
+  }
+  return m;
+}
+
+static void naive_gemm(
+    matrix_view<scalar_t> c, matrix_view<scalar_t const> a, matrix_view<scalar_t const> b) {
+  for (std::size_t i = 0; i < c.rows(); ++i) {
+    for (std::size_t j = 0; j < c.cols(); ++j) {
+      scalar_t acc = 0;
+      for (std::size_t k = 0; k < a.cols(); ++k) {
+        acc = fma(a(i, k), b(k, j), acc);
+      }
+      c(i, j) = acc;
+    }
+  }
+}
+
+DOCTEST_TEST_CASE("gemm matches the naive product") {
+  // dimensions that are not multiples of the block sizes, with an inner dimension spanning several
+  // blocks
+  std::size_t const m = 37;
+  std::size_t const n = 29;
+  std::size_t const k = linalg::_::gemm_blocking<scalar_t>::kc * 2 + 3;
+
+  auto a = make_matrix(m, k, 1);
+  auto b = make_matrix(k, n, 2);
+  std::vector<scalar_t> c(m * n);
+  std::vector<scalar_t> ref(m * n);
+
+  linalg::gemm<scalar_t::precision>({c.data(), m, n}, {a.data(), m, k}, {b.data(), k, n});
+  naive_gemm({ref.data(), m, n}, {a.data(), m, k}, {b.data(), k, n});
+
+  for (std::size_t i = 0; i < c.size(); ++i) {
+    DOCTEST_CHECK(fabs(c[i] - ref[i]) < 1e-60);
+  }
+
+  for (std::size_t n_threads : {2U, 3U, 16U, 0U}) {
+    std::vector<scalar_t> c2(m * n);
+    linalg::gemm<scalar_t::precision>(
+        {c2.data(), m, n}, {a.data(), m, k}, {b.data(), k, n}, false, n_threads);
+    DOCTEST_CHECK(std::memcmp(c.data(), c2.data(), c.size() * sizeof(scalar_t)) == 0);
+  }
+}
+
+DOCTEST_TEST_CASE("gemm on strided blocks with accumulation") {
+  std::size_t const m = 5;
+  std::size_t const n = 4;
+  std::size_t const k = 6;
+
+  auto a_storage = make_matrix(m + 2, k + 3, 3);
+  auto b_storage = make_matrix(k + 1, n + 5, 4);
+  auto a = matrix_view<scalar_t const>{a_storage.data(), m + 2, k + 3}.block(1, 2, m, k);
+  auto b = matrix_view<scalar_t const>{b_storage.data(), k + 1, n + 5}.block(1, 3, k, n);
+
+  std::vector<scalar_t> c_storage(m * (n + 1), scalar_t{1});
+  matrix_view<scalar_t> c{c_storage.data(), m, n, n + 1};
+  std::vector<scalar_t> ref(m * n);
+  naive_gemm({ref.data(), m, n}, a, b);
+
+  linalg::gemm(c, a, b, true);
+  for (std::size_t i = 0; i < m; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      DOCTEST_CHECK(fabs(c(i, j) - (ref[i * n + j] + 1)) < 1e-60);
+    }
+    // padding is untouched
+    DOCTEST_CHECK(c_storage[i * (n + 1) + n] == 1);
+  }
+
+  linalg::gemm(c, a, matrix_view<scalar_t const>{b.data(), k, n, b.stride()});
+  DOCTEST_CHECK(fabs(c(2, 3) - ref[2 * n + 3]) < 1e-60);
+}
+
+DOCTEST_TEST_CASE("gemm with an empty inner dimension") {
+  std::vector<scalar_t> c(6, scalar_t{3});
+  linalg::gemm<scalar_t::precision>({c.data(), 2, 3}, {nullptr, 2, 0}, {nullptr, 0, 3});
+  for (auto const& x : c) {
+    DOCTEST_CHECK(x == 0);
+  }
+}
+
+static auto make_system(std::size_t n, bool symmetric) -> std::vector<scalar_t> {
+  auto m = make_matrix(n, n, 5);
+  std::vector<scalar_t> a(n * n);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      a[i * n + j] = symmetric ? (m[i * n + j] + m[j * n + i]) : m[i * n + j];
+    }
+    // diagonally dominant, hence well conditioned and positive definite when symmetric
+    a[i * n + i] += 20 * static_cast<long>(n);
+  }
+  return a;
+}
+
+static auto residual_norm(
+    std::vector<scalar_t> const& a, std::vector<scalar_t> const& x, std::vector<scalar_t> const& b)
+    -> scalar_t {
+  std::size_t n = x.size();
+  scalar_t out = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    scalar_t r = b[i];
+    for (std::size_t j = 0; j < n; ++j) {
+      r -= a[i * n + j] * x[j];
+    }
+    out = fabs(r) > out ? fabs(r) : out;
+  }
+  return out;
+}
+
+DOCTEST_TEST_CASE("lu and cholesky solves with iterative refinement") {
+  std::size_t const n = 40;
+  auto b = make_matrix(n, 1, 6);
+  std::vector<scalar_t> x(n);
+
+  auto a = make_system(n, false);
+  matrix_view<scalar_t const> av{a.data(), n, n};
+  auto res = linalg::lu_solve(span<scalar_t>{x}, av, span<scalar_t const>{b});
+  DOCTEST_CHECK(res.success);
+  DOCTEST_CHECK(res.iterations > 1);
+  DOCTEST_CHECK(residual_norm(a, x, b) < 1e-70);
+
+  // a working precision closer to the target needs fewer corrections
+  std::vector<scalar_t> x2(n);
+  auto res2 = linalg::lu_solve<mp_float_t<digits2{160}>>(
+      span<scalar_t>{x2}, av, span<scalar_t const>{b});
+  DOCTEST_CHECK(res2.success);
+  DOCTEST_CHECK(res2.iterations < res.iterations);
+  DOCTEST_CHECK(residual_norm(a, x2, b) < 1e-70);
+
+  auto s = make_system(n, true);
+  matrix_view<scalar_t const> sv{s.data(), n, n};
+  res = linalg::cholesky_solve(span<scalar_t>{x}, sv, span<scalar_t const>{b});
+  DOCTEST_CHECK(res.success);
+  DOCTEST_CHECK(residual_norm(s, x, b) < 1e-70);
+}
+
+DOCTEST_TEST_CASE("solves fail on singular and indefinite matrices") {
+  std::size_t const n = 3;
+  std::vector<scalar_t> b{1, 2, 3};
+  std::vector<scalar_t> x(n);
+
+  std::vector<scalar_t> singular{1, 2, 3, 2, 4, 6, 0, 1, 1};
+  DOCTEST_CHECK(not linalg::lu_solve(
+                        span<scalar_t>{x}, matrix_view<scalar_t const>{singular.data(), n, n},
+                        span<scalar_t const>{b})
+                        .success);
+
+  std::vector<scalar_t> indefinite{1, 0, 0, 0, -1, 0, 0, 0, 1};
+  DOCTEST_CHECK(not linalg::cholesky_solve(
+                        span<scalar_t>{x}, matrix_view<scalar_t const>{indefinite.data(), n, n},
+                        span<scalar_t const>{b})
+                        .success);
+  DOCTEST_CHECK(linalg::lu_solve(
+                    span<scalar_t>{x}, matrix_view<scalar_t const>{indefinite.data(), n, n},
+                    span<scalar_t const>{b})
+                    .success);
+  DOCTEST_CHECK(x[1] == -2);
+}
+
+DOCTEST_TEST_CASE("refinement needs a working precision matching the conditioning") {
+  // hilbert matrices have a condition number that grows like e^(3.5 n)
+  auto hilbert = [](std::size_t n) {
+    std::vector<scalar_t> h(n * n);
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t j = 0; j < n; ++j) {
+        h[i * n + j] = scalar_t{1} / static_cast<long>(i + j + 1);
+      }
+    }
+    return h;
+  };
+
+  for (std::size_t n : {8U, 14U}) {
+    auto h = hilbert(n);
+    std::vector<scalar_t> b(n, scalar_t{1});
+    std::vector<scalar_t> x(n);
+    matrix_view<scalar_t const> hv{h.data(), n, n};
+
+    auto res = linalg::cholesky_solve(span<scalar_t>{x}, hv, span<scalar_t const>{b});
+    DOCTEST_CHECK(res.success == (n == 8));
+    res = linalg::lu_solve<mp_float_t<digits2{128}>>(
+        span<scalar_t>{x}, hv, span<scalar_t const>{b});
+    DOCTEST_CHECK(res.success);
+    DOCTEST_CHECK(residual_norm(h, x, b) < 1e-60);
+  }
+}
+
+DOCTEST_TEST_CASE("refinement that stagnates above the target precision fails") {
+  // a solver whose corrections overshoot by a factor two after the first one, so that the error
+  // of the initial solve, rounded to double, oscillates instead of vanishing
+  std::size_t const n = 2;
+  std::vector<scalar_t> id{1, 0, 0, 1};
+  std::vector<scalar_t> b{scalar_t{1} / 3, scalar_t{1} / 3};
+  std::vector<scalar_t> x(n);
+  std::size_t calls = 0;
+  auto solve_work = [&](double* rhs) {
+    for (std::size_t i = 0; i < n; ++i) {
+      rhs[i] *= (calls == 0) ? 1 : 2;
+    }
+    ++calls;
+  };
+  auto res = linalg::_::refine<double>(
+      span<scalar_t>{x}, matrix_view<scalar_t const>{id.data(), n, n}, span<scalar_t const>{b},
+      solve_work, 1);
+  // accurate to the working precision, but not to the target one
+  DOCTEST_CHECK(not res.success);
+  DOCTEST_CHECK(fabs(x[0] - b[0]) < 1e-16);
+  DOCTEST_CHECK(fabs(x[0] - b[0]) > 1e-70);
+}
@@ -0,0 +1,121 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/mapped_array.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{200}>;
+
+// also built with MPFR_CXX_HAS_MMAP set to 0, in parallel
+#if MPFR_CXX_HAS_MMAP
+static char const* const path = "test_mapped_array.bin";
+#else
+static char const* const path = "test_mapped_array_no_mmap.bin";
+#endif
+
+DOCTEST_TEST_CASE("mapped array") {
+  std::vector<scalar_t> xs(10000);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = sqrt(scalar_t{static_cast<long>(i)}) * ((i % 2 == 0) ? 1 : -1);
+  }
+  DOCTEST_REQUIRE(write_array_file(path, span<scalar_t const>{xs}) == std::errc{});
+
+  mapped_array<digits2{200}> arr;
+  DOCTEST_CHECK(not arr.is_open());
+  DOCTEST_CHECK(arr.view().size() == 0);
+  DOCTEST_REQUIRE(arr.open(path) == std::errc{});
+  DOCTEST_CHECK(arr.is_open());
+  DOCTEST_CHECK(arr.size() == xs.size());
+  span<scalar_t const> view = arr.view();
+  DOCTEST_CHECK(view.size() == xs.size());
+  DOCTEST_CHECK(std::memcmp(view.data(), xs.data(), xs.size() * sizeof(scalar_t)) == 0);
+  DOCTEST_CHECK(view[4] == 2);
+  DOCTEST_CHECK(view[3] - xs[3] == 0);
+  DOCTEST_CHECK(view[3] < 0);
+
+  mapped_array<digits2{200}> moved{static_cast<mapped_array<digits2{200}>&&>(arr)};
+  DOCTEST_CHECK(not arr.is_open());
+  DOCTEST_CHECK(moved.view().data() == view.data());
+  moved.close();
+  DOCTEST_CHECK(moved.size() == 0);
+
+  // a different precision is rejected
+  mapped_array<digits2{100}> other;
+  DOCTEST_CHECK(other.open(path) == std::errc::invalid_argument);
+  DOCTEST_CHECK(not other.is_open());
+
+  // empty arrays
+  DOCTEST_REQUIRE(write_array_file(path, span<scalar_t const>{}) == std::errc{});
+  DOCTEST_CHECK(moved.open(path) == std::errc{});
+  DOCTEST_CHECK(moved.size() == 0);
+  moved.close();
+
+  // truncated file
+  DOCTEST_REQUIRE(write_array_file(path, span<scalar_t const>{xs}) == std::errc{});
+  std::FILE* f = std::fopen(path, "r+b");
+  std::vector<unsigned char> bytes(64 + sizeof(scalar_t) * 2);
+  DOCTEST_REQUIRE(std::fread(bytes.data(), 1, bytes.size(), f) == bytes.size());
+  std::fclose(f);
+  f = std::fopen(path, "wb");
+  std::fwrite(bytes.data(), 1, bytes.size() - 1, f);
+  std::fclose(f);
+  DOCTEST_CHECK(moved.open(path) == std::errc::invalid_argument);
+
+  std::remove(path);
+  DOCTEST_CHECK(moved.open(path) == std::errc::no_such_file_or_directory);
+}
+
+DOCTEST_TEST_CASE("mapped array validation") {
+  std::vector<scalar_t> xs(100);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = sqrt(scalar_t{static_cast<long>(i)}) * ((i % 2 == 0) ? 1 : -1);
+  }
+  xs[1] = scalar_t{1} / 0;
+  xs[2] = -scalar_t{0};
+  xs[3] = scalar_t{0} / 0;
+  xs[4] = -mpfr::ldexp(scalar_t{3}, 100000);
+
+  mapped_array<digits2{200}> arr;
+  DOCTEST_REQUIRE(write_array_file(path, span<scalar_t const>{xs}) == std::errc{});
+  DOCTEST_CHECK(arr.open(path, true) == std::errc{});
+  DOCTEST_CHECK(arr.size() == xs.size());
+
+  // corrupted records are only rejected when validating
+  auto check_corrupted = [&](scalar_t const& bad) {
+    std::vector<scalar_t> ys = xs;
+    ys[10] = bad;
+    DOCTEST_REQUIRE(write_array_file(path, span<scalar_t const>{ys}) == std::errc{});
+    DOCTEST_CHECK(arr.open(path) == std::errc{});
+    DOCTEST_CHECK(arr.open(path, true) == std::errc::invalid_argument);
+    DOCTEST_CHECK(not arr.is_open());
+  };
+  scalar_t bad = xs[10];
+  _::impl_access::actual_prec_sign_mut(bad) = -1000;
+  check_corrupted(bad);
+
+  bad = xs[10];
+  _::impl_access::actual_prec_sign_mut(bad) = 3;
+  check_corrupted(bad);
+
+  bad = xs[10];
+  _::impl_access::mantissa_mut(bad)[3] &= ~mp_limb_t{} >> 1U;
+  check_corrupted(bad);
+
+  bad = xs[10];
+  _::impl_access::mantissa_mut(bad)[0] |= 1U;
+  check_corrupted(bad);
+
+  bad = xs[10];
+  _::impl_access::exp_mut(bad) = mpfr_get_emax_max() + 1;
+  check_corrupted(bad);
+
+  bad = scalar_t{0};
+  _::impl_access::exp_mut(bad) = 5;
+  check_corrupted(bad);
+
+  std::remove(path);
+}
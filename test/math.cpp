@@ -181,3 +181,35 @@ DOCTEST_TEST_CASE("math functions") {
   DOCTEST_CHECK(rint(x) == 1);
   DOCTEST_CHECK(rint(scalar_t{1.5}) == 2);
 }
+
+DOCTEST_TEST_CASE("integral power") {
+  scalar_t const x = scalar_t{1.312};
+  DOCTEST_CHECK(pow(x, 0) == 1);
+  DOCTEST_CHECK(pow(x, 1) == x);
+  DOCTEST_CHECK(pow(x, 5U) == pow(x, scalar_t{5}));
+  DOCTEST_CHECK(pow(x, -7) == pow(x, scalar_t{-7}));
+  DOCTEST_CHECK(pow(-x, 3L) == -pow(x, scalar_t{3}));
+  DOCTEST_CHECK(isnan(pow(std::numeric_limits<scalar_t>::quiet_NaN(), 2)));
+  DOCTEST_CHECK(isinf(pow(scalar_t{0}, -1)));
+  DOCTEST_CHECK(signbit(pow(-scalar_t{0}, 3)));
+
+  // powers of two
+  DOCTEST_CHECK(pow(scalar_t{2}, 10) == 1024);
+  DOCTEST_CHECK(pow(scalar_t{2}, -3) == 0.125);
+  DOCTEST_CHECK(pow(scalar_t{0.25}, 3) == ldexp(scalar_t{1}, -6));
+  DOCTEST_CHECK(pow(scalar_t{-2}, 3) == -8);
+  DOCTEST_CHECK(pow(scalar_t{-2}, 4) == 16);
+  DOCTEST_CHECK(pow(scalar_t{-0.5}, -3) == -8);
+  DOCTEST_CHECK(pow(scalar_t{2}, 0) == 1);
+  DOCTEST_CHECK(pow(scalar_t{1}, -1000000000L) == 1);
+  DOCTEST_CHECK(pow(scalar_t{2}, 100000) == ldexp(scalar_t{1}, 100000));
+
+  // out of range results are left to mpfr
+  mpfr_clear_flags();
+  DOCTEST_CHECK(isinf(pow(scalar_t{2}, mpfr_get_emax())));
+  DOCTEST_CHECK(mpfr_overflow_p());
+  DOCTEST_CHECK(pow(scalar_t{2}, mpfr_get_emax() - 1) == ldexp(scalar_t{1}, mpfr_get_emax() - 1));
+  DOCTEST_CHECK(pow(scalar_t{-2}, 2 * mpfr_get_emax() + 1) == -pow(scalar_t{2}, 1L << 62));
+  DOCTEST_CHECK(pow(scalar_t{0.25}, mpfr_get_emax()) == 0);
+  DOCTEST_CHECK(pow(scalar_t{4}, std::numeric_limits<long>::min()) == 0);
+}
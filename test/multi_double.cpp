@@ -0,0 +1,100 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/multi_double.hpp"
+#include "mpfr/math.hpp"
+#include <cstdint>
+
+using namespace mpfr;
+using reference_t = mp_float_t<digits2{1024}>;
+
+namespace {
+
+struct rng_t {
+  std::uint64_t state;
+  auto next() -> double {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<double>(state >> 11U) * 0x1p-53 + 0.5;
+  }
+};
+
+template <typename T> auto relative_error(T const& x, reference_t const& ref) -> double {
+  reference_t const actual = static_cast<reference_t>(x);
+  return static_cast<double>(static_cast<long double>(abs((actual - ref) / ref)));
+}
+
+constexpr double u = 0x1p-53;
+
+} // namespace
+
+DOCTEST_TEST_CASE("double-double") {
+  rng_t rng{42};
+  double max_err[5] = {};
+  for (int i = 0; i < 2000; ++i) {
+    // non trivial trailing components, and cancellations in half of the subtractions
+    dd_t const a = dd_t{rng.next()} / dd_t{rng.next() * 3};
+    dd_t const b = (i % 2 == 0) ? a * dd_t{1.0 + rng.next() * 0x1p-30} : dd_t{-rng.next()} / 7.0;
+    reference_t const ra{static_cast<reference_t>(a)};
+    reference_t const rb{static_cast<reference_t>(b)};
+
+    double const errs[] = {
+        relative_error(a + b, ra + rb),
+        relative_error(a - b, ra - rb),
+        relative_error(a * b, ra * rb),
+        relative_error(a / b, ra / rb),
+        relative_error(sqrt(a), sqrt(ra)),
+    };
+    for (std::size_t k = 0; k < 5; ++k) {
+      max_err[k] = std::max(max_err[k], errs[k]);
+    }
+  }
+  DOCTEST_CHECK(max_err[0] <= 3 * u * u);
+  DOCTEST_CHECK(max_err[1] <= 3 * u * u);
+  DOCTEST_CHECK(max_err[2] <= 5 * u * u);
+  DOCTEST_CHECK(max_err[3] <= 10 * u * u);
+  DOCTEST_CHECK(max_err[4] <= 10 * u * u);
+}
+
+DOCTEST_TEST_CASE("quad-double") {
+  rng_t rng{7};
+  double max_err[5] = {};
+  for (int i = 0; i < 2000; ++i) {
+    qd_t const a = qd_t{rng.next()} / qd_t{rng.next() * 3};
+    qd_t const b = (i % 2 == 0) ? a * qd_t{1.0 + rng.next() * 0x1p-30} : qd_t{-rng.next()} / 7.0;
+    reference_t const ra{static_cast<reference_t>(a)};
+    reference_t const rb{static_cast<reference_t>(b)};
+
+    double const errs[] = {
+        relative_error(a + b, ra + rb),
+        relative_error(a - b, ra - rb),
+        relative_error(a * b, ra * rb),
+        relative_error(a / b, ra / rb),
+        relative_error(sqrt(a), sqrt(ra)),
+    };
+    for (std::size_t k = 0; k < 5; ++k) {
+      max_err[k] = std::max(max_err[k], errs[k]);
+    }
+  }
+  for (double err : max_err) {
+    DOCTEST_CHECK(err <= 16 * u * u * u * u);
+  }
+}
+
+DOCTEST_TEST_CASE("multi-double conversions") {
+  using dd_float_t = mp_float_t<digits2{106}>;
+  using qd_float_t = mp_float_t<digits2{212}>;
+  dd_float_t const x = sqrt(dd_float_t{2});
+  qd_float_t const y = sqrt(qd_float_t{2});
+
+  dd_t const x_dd{x};
+  qd_t const y_qd{y};
+  DOCTEST_CHECK(x_dd.hi == std::sqrt(2.0));
+  DOCTEST_CHECK(static_cast<dd_float_t>(x_dd) == x);
+  DOCTEST_CHECK(static_cast<qd_float_t>(y_qd) == y);
+  DOCTEST_CHECK(relative_error(y_qd, sqrt(reference_t{2})) <= u * u * u * u);
+
+  DOCTEST_CHECK(dd_t{1.5} < dd_t{1.5, 0x1p-60});
+  DOCTEST_CHECK(qd_t{-1.0} < qd_t{x_dd});
+  DOCTEST_CHECK(static_cast<double>(qd_t{x_dd}) == std::sqrt(2.0));
+}
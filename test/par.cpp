@@ -0,0 +1,115 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/par.hpp"
+#include "mpfr/mp_float.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{128}>;
+
+static auto make_values(std::size_t n) -> std::vector<scalar_t> {
+  std::vector<scalar_t> v(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    // a permutation of [0, n), scaled
+    v[i] = scalar_t{static_cast<long>((i * 7919) % n)} / 3;
+  }
+  return v;
+}
+
+DOCTEST_TEST_CASE("par for_each and transform") {
+  std::size_t const n = 20001;
+  auto const xs = make_values(n);
+
+  for (std::size_t n_threads : {1U, 2U, 7U, 0U}) {
+    std::vector<scalar_t> out(n);
+    par::transform(
+        span<scalar_t const>{xs},
+        span<scalar_t>{out},
+        [](scalar_t const& x) { return sqrt(x); },
+        n_threads);
+    for (std::size_t i = 0; i < n; ++i) {
+      DOCTEST_REQUIRE(out[i] == sqrt(xs[i]));
+    }
+
+    par::transform(
+        span<scalar_t const>{xs},
+        span<scalar_t const>{out},
+        span<scalar_t>{out},
+        [](scalar_t const& x, scalar_t const& y) { return x - y * y; },
+        n_threads);
+    for (std::size_t i = 0; i < n; ++i) {
+      DOCTEST_REQUIRE(out[i] == xs[i] - sqrt(xs[i]) * sqrt(xs[i]));
+    }
+
+    // every element is visited once, with costs that vary by orders of magnitude
+    std::vector<std::atomic<int>> visits(n);
+    std::vector<scalar_t> ys = xs;
+    par::for_each(
+        span<scalar_t>{ys},
+        [&](scalar_t& y) {
+          std::size_t const i = static_cast<std::size_t>(&y - ys.data());
+          visits[i].fetch_add(1, std::memory_order_relaxed);
+          y = (i % 1000 == 0) ? exp(sin(y) + 1) : y + 1;
+        },
+        n_threads);
+    for (std::size_t i = 0; i < n; ++i) {
+      DOCTEST_REQUIRE(visits[i].load() == 1);
+      DOCTEST_REQUIRE(ys[i] == ((i % 1000 == 0) ? exp(sin(xs[i]) + 1) : xs[i] + 1));
+    }
+  }
+}
+
+DOCTEST_TEST_CASE("par inclusive_scan") {
+  auto op = [](scalar_t const& a, scalar_t const& b) { return a + b; };
+  for (std::size_t n : {0U, 1U, 255U, 256U, 257U, 10000U}) {
+    auto const xs = make_values(n);
+    std::vector<scalar_t> ref(n);
+    par::inclusive_scan(span<scalar_t const>{xs}, span<scalar_t>{ref}, op, 1);
+    for (std::size_t n_threads : {2U, 5U, 0U}) {
+      std::vector<scalar_t> out(n);
+      par::inclusive_scan(span<scalar_t const>{xs}, span<scalar_t>{out}, op, n_threads);
+      DOCTEST_CHECK(std::memcmp(out.data(), ref.data(), n * sizeof(scalar_t)) == 0);
+    }
+
+    scalar_t sum = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      sum += xs[i];
+      DOCTEST_REQUIRE(fabs(ref[i] - sum) <= fabs(sum) * 1e-35);
+    }
+
+    // in place
+    std::vector<scalar_t> ys = xs;
+    par::inclusive_scan(span<scalar_t const>{ys}, span<scalar_t>{ys}, op);
+    DOCTEST_CHECK(std::memcmp(ys.data(), ref.data(), n * sizeof(scalar_t)) == 0);
+  }
+}
+
+DOCTEST_TEST_CASE("par sort") {
+  for (std::size_t n : {0U, 1U, 4095U, 4097U, 3U * 4096U + 5U, 50000U}) {
+    auto xs = make_values(n);
+    auto expected = xs;
+    std::sort(expected.begin(), expected.end());
+    for (std::size_t n_threads : {1U, 3U, 0U}) {
+      auto ys = xs;
+      par::sort(span<scalar_t>{ys}, std::less<scalar_t>{}, n_threads);
+      DOCTEST_CHECK(std::memcmp(ys.data(), expected.data(), n * sizeof(scalar_t)) == 0);
+    }
+
+    // with duplicates and a custom order
+    std::vector<scalar_t> zs(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      zs[i] = xs[i] / 100 - scalar_t{static_cast<long>(i % 3)};
+      zs[i] = floor(zs[i]);
+    }
+    auto greater = [](scalar_t const& a, scalar_t const& b) { return a > b; };
+    auto expected_z = zs;
+    std::sort(expected_z.begin(), expected_z.end(), greater);
+    par::sort(span<scalar_t>{zs}, greater);
+    DOCTEST_CHECK(std::equal(zs.begin(), zs.end(), expected_z.begin()));
+  }
+}
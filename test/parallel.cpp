@@ -0,0 +1,155 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/parallel.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{256}>;
+
+static auto make_values(std::size_t n) -> std::vector<scalar_t> {
+  std::vector<scalar_t> v(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    v[i] = sqrt(scalar_t{static_cast<long>(i + 1)}) * ((i % 3 == 0) ? -1 : 1) / scalar_t{7};
+  }
+  return v;
+}
+
+DOCTEST_TEST_CASE("parallel sum is independent of the thread count") {
+  auto v = make_values(100'000);
+  span<scalar_t const> xs{v};
+
+  auto ref = parallel_sum(xs, 1);
+  for (std::size_t n_threads : {2U, 3U, 8U, 128U, 0U}) {
+    auto s = parallel_sum(xs, n_threads);
+    DOCTEST_CHECK(std::memcmp(&s, &ref, sizeof(s)) == 0);
+  }
+
+  scalar_t serial = 0;
+  for (auto const& x : v) {
+    serial += x;
+  }
+  DOCTEST_CHECK(fabs(serial - ref) < 1e-60);
+}
+
+DOCTEST_TEST_CASE("parallel dot is independent of the thread count") {
+  auto a = make_values(50'001);
+  auto b = make_values(50'001);
+  span<scalar_t const> xs{a};
+  span<scalar_t const> ys{b};
+
+  auto ref = parallel_dot(xs, ys, 1);
+  for (std::size_t n_threads : {2U, 5U, 64U, 0U}) {
+    auto d = parallel_dot(xs, ys, n_threads);
+    DOCTEST_CHECK(std::memcmp(&d, &ref, sizeof(d)) == 0);
+  }
+
+  // sum of i/49 for i in [1, 50001]
+  DOCTEST_CHECK(fabs(ref - scalar_t{50'001} * 50'002 / 2 / 49) < 1e-60);
+}
+
+DOCTEST_TEST_CASE("parallel reduce") {
+  auto v = make_values(10'000);
+  span<scalar_t const> xs{v};
+  auto max = [](scalar_t const& a, scalar_t const& b) { return fmax(a, b); };
+  auto ref = parallel_reduce(xs, scalar_t{0}, max, 1);
+  DOCTEST_CHECK(ref == parallel_reduce(xs, scalar_t{0}, max, 16));
+  DOCTEST_CHECK(ref == sqrt(scalar_t{9'999}) / 7);
+  DOCTEST_CHECK(parallel_reduce(span<scalar_t const>{}, scalar_t{3}, max) == 3);
+}
+
+DOCTEST_TEST_CASE("workers use the rounding mode and exponent range of the caller") {
+  auto v = make_values(4096);
+  span<scalar_t const> xs{v};
+
+  std::fesetround(FE_UPWARD);
+  auto up = parallel_sum(xs, 0);
+  DOCTEST_CHECK(up == parallel_sum(xs, 1));
+  std::fesetround(FE_DOWNWARD);
+  auto down = parallel_sum(xs, 0);
+  DOCTEST_CHECK(down == parallel_sum(xs, 1));
+  std::fesetround(FE_TONEAREST);
+  DOCTEST_CHECK(down < up);
+
+  mpfr_clear_flags();
+  parallel_sum(xs, 0);
+  DOCTEST_CHECK(mpfr_inexflag_p() != 0);
+
+  // the global pool may have no workers, so a local one is used for the exponent range
+  mpfr::_::thread_pool pool{3};
+  std::thread::id const caller = std::this_thread::get_id();
+  std::vector<scalar_t> out(64);
+  std::atomic<std::size_t> on_workers{0};
+  auto task = [&](std::size_t i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    if (std::this_thread::get_id() != caller) {
+      ++on_workers;
+    }
+    out[i] = scalar_t{static_cast<long>(1000 + i)} * 3;
+  };
+  mpfr_exp_t const emax = mpfr_get_emax();
+  mpfr_set_emax(10);
+  mpfr_clear_flags();
+  pool.for_each_index(out.size(), 0, task);
+  DOCTEST_CHECK(mpfr_overflow_p() != 0);
+  mpfr_set_emax(emax);
+  DOCTEST_CHECK(on_workers.load() > 0);
+  for (auto const& x : out) {
+    DOCTEST_CHECK(isinf(x));
+  }
+}
+
+DOCTEST_TEST_CASE("thread pool") {
+  mpfr::_::thread_pool pool{3};
+  std::vector<scalar_t> out(64);
+
+  auto task = [&](std::size_t i) {
+    out[i] = scalar_t{1} / static_cast<long>(i + 3);
+  };
+
+  std::fesetround(FE_UPWARD);
+  mpfr_clear_flags();
+  pool.for_each_index(out.size(), 0, task);
+  DOCTEST_CHECK(mpfr_inexflag_p() != 0);
+  std::fesetround(FE_TONEAREST);
+
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    scalar_t x = out[i];
+    DOCTEST_CHECK(x * static_cast<long>(i + 3) >= 1);
+  }
+}
+
+DOCTEST_TEST_CASE("thread pool exceptions") {
+  mpfr::_::thread_pool pool{3};
+  std::thread::id const caller = std::this_thread::get_id();
+  std::mutex mutex;
+  std::set<std::thread::id> ids;
+  auto record = [&](std::size_t) {
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    std::lock_guard<std::mutex> lock{mutex};
+    ids.insert(std::this_thread::get_id());
+  };
+
+  // thrown on the caller, then on the workers
+  for (bool on_caller : {true, false}) {
+    auto task = [&](std::size_t i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      if (i >= 4 and (std::this_thread::get_id() == caller) == on_caller) {
+        throw std::runtime_error{"task"};
+      }
+    };
+    DOCTEST_CHECK_THROWS_AS(pool.for_each_index(64, 0, task), std::runtime_error);
+
+    // the caller is still allowed to use the workers
+    ids.clear();
+    pool.for_each_index(64, 0, record);
+    DOCTEST_CHECK(ids.size() > 1);
+  }
+}
@@ -0,0 +1,67 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/poly.hpp"
+#include <vector>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{256}>;
+
+static auto make_coeffs(std::size_t n) -> std::vector<scalar_t> {
+  // truncated series of exp
+  std::vector<scalar_t> c(n);
+  scalar_t term = 1;
+  for (std::size_t i = 0; i < n; ++i) {
+    c[i] = term;
+    term /= static_cast<long>(i + 1);
+  }
+  return c;
+}
+
+DOCTEST_TEST_CASE("horner and estrin") {
+  for (std::size_t n : {0U, 1U, 2U, 3U, 4U, 7U, 60U, 61U}) {
+    auto c = make_coeffs(n);
+    span<scalar_t const> cs{c};
+    scalar_t x = scalar_t{3} / 7;
+
+    scalar_t naive = 0;
+    for (std::size_t i = n; i-- > 0;) {
+      naive = fma(naive, x, c[i]);
+    }
+    auto h = poly_eval(cs, x);
+    DOCTEST_CHECK(std::memcmp(&h, &naive, sizeof(h)) == 0);
+
+    auto e = poly_eval(cs, x, poly_scheme_e::estrin);
+    DOCTEST_CHECK(fabs(e - h) < 1e-75);
+  }
+  auto c = make_coeffs(60);
+  DOCTEST_CHECK(fabs(poly_eval(span<scalar_t const>{c}, scalar_t{1}) - exp(scalar_t{1})) < 1e-75);
+}
+
+DOCTEST_TEST_CASE("batched evaluation matches the scalar one") {
+  auto c = make_coeffs(45);
+  span<scalar_t const> cs{c};
+  std::vector<scalar_t> xs(1000);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = scalar_t{static_cast<long>(i)} / 300 - 1;
+  }
+
+  for (auto scheme : {poly_scheme_e::horner, poly_scheme_e::estrin}) {
+    std::vector<scalar_t> out(xs.size());
+    poly_eval(cs, span<scalar_t const>{xs}, span<scalar_t>{out}, scheme);
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      auto ref = poly_eval(cs, xs[i], scheme);
+      DOCTEST_CHECK(std::memcmp(&out[i], &ref, sizeof(ref)) == 0);
+    }
+
+    std::vector<scalar_t> out2(xs.size());
+    poly_eval(cs, span<scalar_t const>{xs}, span<scalar_t>{out2}, scheme, 3);
+    DOCTEST_CHECK(std::memcmp(out.data(), out2.data(), out.size() * sizeof(scalar_t)) == 0);
+
+    // in place
+    std::vector<scalar_t> ys = xs;
+    poly_eval(cs, span<scalar_t const>{ys}, span<scalar_t>{ys}, scheme);
+    DOCTEST_CHECK(std::memcmp(out.data(), ys.data(), out.size() * sizeof(scalar_t)) == 0);
+  }
+}
@@ -0,0 +1,165 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/serialize.hpp"
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace mpfr;
+
+template <precision_t P> static auto make_values() -> std::vector<mp_float_t<P>> {
+  using T = mp_float_t<P>;
+  std::vector<T> v{0, 1, 2, 0.5, 0.375, 1e300, 1e-300, 123456789, 1.0 / 3.0};
+  v.push_back(sqrt(T{2}));
+  v.push_back(T{1} / 3);
+  v.push_back(exp(T{100000}));
+  v.push_back(exp(T{-100000}));
+  v.push_back(T{std::numeric_limits<double>::infinity()});
+  std::size_t n = v.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    v.push_back(-v[i]);
+  }
+  return v;
+}
+
+template <precision_t P> static void check_round_trip() {
+  for (auto const& x : make_values<P>()) {
+    std::vector<unsigned char> buf(max_serialized_size<P>());
+    auto res = serialize(buf.data(), buf.data() + buf.size(), x);
+    DOCTEST_REQUIRE(res.ec == std::errc{});
+    DOCTEST_CHECK(static_cast<std::size_t>(res.ptr - buf.data()) == serialized_size(x));
+
+    mp_float_t<P> y;
+    auto back = deserialize(buf.data(), res.ptr, y);
+    DOCTEST_CHECK(back.ec == std::errc{});
+    DOCTEST_CHECK(back.ptr == res.ptr);
+    DOCTEST_CHECK(std::memcmp(&x, &y, sizeof(x)) == 0);
+  }
+}
+
+DOCTEST_TEST_CASE("serialize round trip") {
+  check_round_trip<digits2{53}>();
+  check_round_trip<digits2{64}>();
+  check_round_trip<digits2{128}>();
+  check_round_trip<digits2{1000}>();
+
+  // only the significant bits are written
+  using scalar_t = mp_float_t<digits2{1000}>;
+  DOCTEST_CHECK(serialized_size(scalar_t{0}) == 1);
+  DOCTEST_CHECK(serialized_size(scalar_t{1}) == 3);
+  DOCTEST_CHECK(serialized_size(scalar_t{1.0 / 3.0}) == 10);
+  DOCTEST_CHECK(serialized_size(scalar_t{1} / 3) < sizeof(scalar_t));
+
+  // the format does not depend on the machine
+  unsigned char buf[16];
+  auto res = serialize(buf, buf + sizeof(buf), scalar_t{-1.5});
+  DOCTEST_CHECK(res.ptr - buf == 3);
+  DOCTEST_CHECK(buf[0] == 0x15);
+  DOCTEST_CHECK(buf[1] == 0x02);
+  DOCTEST_CHECK(buf[2] == 0xc0);
+  res = serialize(buf, buf + sizeof(buf), scalar_t{-1} / 0);
+  DOCTEST_CHECK(res.ptr - buf == 1);
+  DOCTEST_CHECK(buf[0] == 0x06);
+
+  scalar_t nan = -(scalar_t{0} / 0);
+  res = serialize(buf, buf + sizeof(buf), nan);
+  scalar_t y;
+  DOCTEST_CHECK(deserialize(buf, res.ptr, y).ec == std::errc{});
+  DOCTEST_CHECK(isnan(y));
+  DOCTEST_CHECK(signbit(y));
+  res = serialize(buf, buf + sizeof(buf), scalar_t{-0.0});
+  y = 2;
+  DOCTEST_CHECK(deserialize(buf, res.ptr, y).ec == std::errc{});
+  DOCTEST_CHECK(y == 0);
+  DOCTEST_CHECK(signbit(y));
+}
+
+DOCTEST_TEST_CASE("serialize across precisions") {
+  using hi_t = mp_float_t<digits2{256}>;
+  using lo_t = mp_float_t<digits2{53}>;
+  using wide_t = mp_float_t<digits2{1024}>;
+
+  for (auto const& x : make_values<digits2{256}>()) {
+    std::vector<unsigned char> buf(max_serialized_size<digits2{256}>());
+    auto res = serialize(buf.data(), buf.data() + buf.size(), x);
+
+    lo_t lo;
+    DOCTEST_CHECK(deserialize(buf.data(), res.ptr, lo).ec == std::errc{});
+    lo_t const expected = x;
+    DOCTEST_CHECK(std::memcmp(&lo, &expected, sizeof(lo)) == 0);
+
+    wide_t wide;
+    DOCTEST_CHECK(deserialize(buf.data(), res.ptr, wide).ec == std::errc{});
+    wide_t const exact = x;
+    DOCTEST_CHECK(std::memcmp(&wide, &exact, sizeof(wide)) == 0);
+    DOCTEST_CHECK(hi_t{wide} == x);
+  }
+}
+
+DOCTEST_TEST_CASE("serialize errors") {
+  using scalar_t = mp_float_t<digits2{128}>;
+  scalar_t const x = scalar_t{1} / 3;
+  unsigned char buf[64];
+  DOCTEST_CHECK(serialize(buf, buf + 4, x).ec == std::errc::value_too_large);
+  auto res = serialize(buf, buf + sizeof(buf), x);
+
+  scalar_t y = 5;
+  // truncated
+  for (unsigned char* end = buf; end != res.ptr; ++end) {
+    auto back = deserialize(buf, end, y);
+    DOCTEST_CHECK(back.ec == std::errc::invalid_argument);
+    DOCTEST_CHECK(back.ptr == buf);
+  }
+  DOCTEST_CHECK(y == 5);
+
+  // not normalized
+  unsigned char bad[] = {0x15, 0x02, 0x40};
+  DOCTEST_CHECK(deserialize(bad, bad + 3, y).ec == std::errc::invalid_argument);
+  // bits past the precision
+  unsigned char bad2[] = {0x15, 0x02, 0xe0};
+  DOCTEST_CHECK(deserialize(bad2, bad2 + 3, y).ec == std::errc::invalid_argument);
+  // special value with a precision
+  unsigned char bad3[] = {0x12};
+  DOCTEST_CHECK(deserialize(bad3, bad3 + 1, y).ec == std::errc::invalid_argument);
+  DOCTEST_CHECK(y == 5);
+
+  // outside the current exponent range
+  res = serialize(buf, buf + sizeof(buf), scalar_t{1e300});
+  mpfr_exp_t const emax = mpfr_get_emax();
+  mpfr_set_emax(100);
+  auto back = deserialize(buf, res.ptr, y);
+  mpfr_set_emax(emax);
+  DOCTEST_CHECK(back.ec == std::errc::result_out_of_range);
+  DOCTEST_CHECK(back.ptr == res.ptr);
+  DOCTEST_CHECK(y == 5);
+}
+
+DOCTEST_TEST_CASE("serialize spans") {
+  using scalar_t = mp_float_t<digits2{200}>;
+  std::vector<scalar_t> xs(1000);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = (i % 3 == 0) ? scalar_t{static_cast<long>(i)} : sqrt(scalar_t{static_cast<long>(i)});
+  }
+
+  std::vector<unsigned char> buf{0xff};
+  serialize(span<scalar_t const>{xs}, buf);
+  std::size_t total = 1;
+  for (auto const& x : xs) {
+    total += serialized_size(x);
+  }
+  DOCTEST_CHECK(buf.size() == total);
+
+  std::vector<scalar_t> ys(xs.size());
+  auto res = deserialize(buf.data() + 1, buf.data() + buf.size(), span<scalar_t>{ys});
+  DOCTEST_CHECK(res.ec == std::errc{});
+  DOCTEST_CHECK(res.ptr == buf.data() + buf.size());
+  DOCTEST_CHECK(std::memcmp(xs.data(), ys.data(), xs.size() * sizeof(scalar_t)) == 0);
+
+  // one value too many
+  ys.push_back(scalar_t{});
+  res = deserialize(buf.data() + 1, buf.data() + buf.size(), span<scalar_t>{ys});
+  DOCTEST_CHECK(res.ec == std::errc::invalid_argument);
+  DOCTEST_CHECK(res.ptr == buf.data() + buf.size());
+}
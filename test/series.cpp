@@ -0,0 +1,119 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/series.hpp"
+#include <cstring>
+
+using namespace mpfr;
+
+// Chudnovsky: 1/pi = 12/640320^(3/2) sum_k (-1)^k (6k)! (13591409 + 545140134k) / ((3k)! k!^3
+// 640320^3k), where the ratio of consecutive terms is
+// -(6k-5)(2k-1)(6k-1) / (k^3 640320^3 / 24)
+static void chudnovsky_p(mpz_ptr out, std::size_t k) {
+  if (k == 0) {
+    mpz_set_ui(out, 1);
+    return;
+  }
+  mpz_set_ui(out, 6 * k - 5);
+  mpz_mul_ui(out, out, 2 * k - 1);
+  mpz_mul_ui(out, out, 6 * k - 1);
+  mpz_neg(out, out);
+}
+static void chudnovsky_q(mpz_ptr out, std::size_t k) {
+  if (k == 0) {
+    mpz_set_ui(out, 1);
+    return;
+  }
+  mpz_set_ui(out, k);
+  mpz_pow_ui(out, out, 3);
+  mpz_mul_ui(out, out, 10939058860032000UL); // 640320^3 / 24
+}
+static void chudnovsky_a(mpz_ptr out, std::size_t k) {
+  mpz_set_ui(out, 545140134);
+  mpz_mul_ui(out, out, k);
+  mpz_add_ui(out, out, 13591409);
+}
+
+// pi = 426880 sqrt(10005) Q / T, and each term adds about 14.18 digits
+static void chudnovsky_pi(mpfr_ptr out, std::size_t n_threads) {
+  auto const prec = static_cast<std::size_t>(mpfr_get_prec(out));
+  std::size_t const n_terms = prec / 47 + 2;
+  series::split_result_t split = series::binary_split(
+      chudnovsky_p, chudnovsky_q, chudnovsky_a, n_terms, false, n_threads);
+  mpfr_t s;
+  mpfr_init2(s, mpfr_get_prec(out) + 64);
+  series::sum(split, s);
+  mpfr_sqrt_ui(out, 10005, MPFR_RNDN);
+  mpfr_mul_ui(out, out, 426880, MPFR_RNDN);
+  mpfr_div(out, out, s, MPFR_RNDN);
+  mpfr_clear(s);
+}
+
+DOCTEST_TEST_CASE("binary splitting pi") {
+  for (mpfr_prec_t prec : {mpfr_prec_t{64}, mpfr_prec_t{3000}, mpfr_prec_t{100000}}) {
+    mpfr_t pi;
+    mpfr_t ref;
+    mpfr_init2(pi, prec);
+    mpfr_init2(ref, prec);
+    mpfr_const_pi(ref, MPFR_RNDN);
+    for (std::size_t n_threads : {1U, 0U}) {
+      chudnovsky_pi(pi, n_threads);
+      // within an ulp, after the final operations
+      mpfr_sub(pi, pi, ref, MPFR_RNDN);
+      DOCTEST_CHECK((mpfr_zero_p(pi) or mpfr_get_exp(pi) <= mpfr_get_exp(ref) - prec + 2));
+    }
+    mpfr_clear(pi);
+    mpfr_clear(ref);
+  }
+}
+
+DOCTEST_TEST_CASE("binary splitting e") {
+  // e = sum 1/k!, with p(k) = 1, q(0) = 1, q(k) = k, a(k) = 1
+  auto one = [](mpz_ptr out, std::size_t /*k*/) { mpz_set_ui(out, 1); };
+  auto q = [](mpz_ptr out, std::size_t k) { mpz_set_ui(out, k == 0 ? 1 : k); };
+
+  using scalar_t = mp_float_t<digits2{2000}>;
+  series::split_result_t split = series::binary_split(one, q, one, 500, true);
+  DOCTEST_CHECK(mpz_cmp_ui(split.p, 1) == 0);
+  // Q = 499!
+  mpz_t fact;
+  mpz_init(fact);
+  mpz_fac_ui(fact, 499);
+  DOCTEST_CHECK(mpz_cmp(split.q, fact) == 0);
+  mpz_clear(fact);
+
+  scalar_t const e = series::sum<digits2{2000}>(split);
+  DOCTEST_CHECK(e == exp(scalar_t{1}));
+
+  // T and Q are far outside of an IEEE-like exponent range, while their quotient is not
+  mpfr_exp_t const emin = mpfr_get_emin();
+  mpfr_exp_t const emax = mpfr_get_emax();
+  mpfr_set_emin(-1073);
+  mpfr_set_emax(1024);
+  DOCTEST_CHECK(series::sum<digits2{2000}>(split) == e);
+  DOCTEST_CHECK(mpfr_get_emin() == -1073);
+  DOCTEST_CHECK(mpfr_get_emax() == 1024);
+  // while a quotient outside of the range still overflows
+  series::split_result_t big;
+  mpz_set(big.t, split.t);
+  mpz_set_ui(big.q, 1);
+  mpfr_clear_flags();
+  DOCTEST_CHECK(isinf(series::sum<digits2{2000}>(big)));
+  DOCTEST_CHECK(mpfr_overflow_p());
+  mpfr_set_emin(emin);
+  mpfr_set_emax(emax);
+
+  // the integers do not depend on the number of threads or on the shape of the leaves
+  for (std::size_t n : {1U, 63U, 64U, 65U, 129U, 1000U}) {
+    series::split_result_t a = series::binary_split(one, q, one, n, true, 1);
+    series::split_result_t b = series::binary_split(one, q, one, n, true, 0);
+    DOCTEST_CHECK(mpz_cmp(a.q, b.q) == 0);
+    DOCTEST_CHECK(mpz_cmp(a.t, b.t) == 0);
+    mpz_t expected;
+    mpz_init(expected);
+    mpz_fac_ui(expected, n - 1);
+    DOCTEST_CHECK(mpz_cmp(a.q, expected) == 0);
+    mpz_clear(expected);
+  }
+}
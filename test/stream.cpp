@@ -0,0 +1,156 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/stream.hpp"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{256}>;
+
+static auto make_values(std::size_t n) -> std::vector<scalar_t> {
+  std::vector<scalar_t> xs(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    auto k = static_cast<long>(i);
+    xs[i] = (i % 5 == 0) ? scalar_t{k} : sqrt(scalar_t{k}) * ((i % 2 == 0) ? 1e-30 : -1e30);
+  }
+  xs[1] = scalar_t{1} / 0;
+  xs[2] = -scalar_t{0};
+  return xs;
+}
+
+static void write_file(char const* path, std::string const& contents) {
+  std::FILE* f = std::fopen(path, "wb");
+  std::fwrite(contents.data(), 1, contents.size(), f);
+  std::fclose(f);
+}
+
+DOCTEST_TEST_CASE("stream round trip") {
+  char const* path = "test_stream.bin";
+  auto const xs = make_values(5000);
+
+  for (auto mode : {stream_mode_e::binary, stream_mode_e::text}) {
+    // small chunks, so that many numbers are split between two of them
+    for (std::size_t chunk_size : {std::size_t{7}, std::size_t{100}, std::size_t{1} << 20U}) {
+      {
+        stream_writer<digits2{256}> w;
+        DOCTEST_REQUIRE(w.open(path, mode, chunk_size) == std::errc{});
+        w.write(xs[0]);
+        w.write(span<scalar_t const>{xs.data() + 1, xs.size() - 1});
+        DOCTEST_CHECK(w.close() == std::errc{});
+      }
+
+      stream_reader<digits2{256}> r;
+      DOCTEST_REQUIRE(r.open(path, mode, chunk_size < 100 ? 100 : chunk_size) == std::errc{});
+      std::vector<scalar_t> ys(xs.size() + 1);
+      DOCTEST_CHECK(r.read(span<scalar_t>{ys}) == xs.size());
+      DOCTEST_CHECK(r.error() == std::errc{});
+      DOCTEST_CHECK(std::memcmp(xs.data(), ys.data(), xs.size() * sizeof(scalar_t)) == 0);
+      DOCTEST_CHECK(not r.read(ys[0]));
+    }
+  }
+  std::remove(path);
+}
+
+DOCTEST_TEST_CASE("stream across precisions") {
+  char const* path = "test_stream.bin";
+  auto const xs = make_values(1000);
+  stream_writer<digits2{256}> w;
+  DOCTEST_REQUIRE(w.open(path) == std::errc{});
+  w.write(span<scalar_t const>{xs});
+  DOCTEST_CHECK(w.close() == std::errc{});
+
+  using lo_t = mp_float_t<digits2{53}>;
+  stream_reader<digits2{53}> r;
+  DOCTEST_REQUIRE(r.open(path) == std::errc{});
+  lo_t y;
+  std::size_t n = 0;
+  while (r.read(y)) {
+    lo_t const expected = xs[n];
+    DOCTEST_CHECK(std::memcmp(&y, &expected, sizeof(y)) == 0);
+    ++n;
+  }
+  DOCTEST_CHECK(n == xs.size());
+  DOCTEST_CHECK(r.error() == std::errc{});
+  std::remove(path);
+}
+
+DOCTEST_TEST_CASE("stream of long numbers") {
+  // numbers written at a higher precision are longer than the prefix of the chunks
+  char const* path = "test_stream.bin";
+  using hi_t = mp_float_t<digits2{20000}>;
+  using lo_t = mp_float_t<digits2{53}>;
+  std::size_t const chunk_size = 8192;
+  std::vector<lo_t> expected;
+  for (auto mode : {stream_mode_e::binary, stream_mode_e::text}) {
+    {
+      stream_writer<digits2{20000}> w;
+      DOCTEST_REQUIRE(w.open(path, mode) == std::errc{});
+      for (long k = 1; k <= 300; ++k) {
+        hi_t const x = sqrt(hi_t{k});
+        w.write(x);
+        expected.push_back(lo_t{x});
+      }
+      DOCTEST_CHECK(w.close() == std::errc{});
+    }
+
+    stream_reader<digits2{53}> r;
+    DOCTEST_REQUIRE(r.open(path, mode, chunk_size) == std::errc{});
+    lo_t y;
+    std::size_t n = 0;
+    while (r.read(y)) {
+      DOCTEST_CHECK(y == expected[n]);
+      ++n;
+    }
+    DOCTEST_CHECK(n == 300);
+    DOCTEST_CHECK(r.error() == std::errc{});
+    DOCTEST_CHECK(r.buffer_capacity() <= 4 * (chunk_size + 256));
+    expected.clear();
+  }
+  std::remove(path);
+}
+
+DOCTEST_TEST_CASE("stream errors") {
+  char const* path = "test_stream.txt";
+  stream_reader<digits2{256}> r;
+  DOCTEST_CHECK(r.open("no_such_directory/file") == std::errc::no_such_file_or_directory);
+
+  write_file(path, "  1.5\n\n-2e3 \t inf\n0x1p3 4");
+  DOCTEST_REQUIRE(r.open(path, stream_mode_e::text, 3) == std::errc{});
+  scalar_t y;
+  DOCTEST_CHECK(r.read(y));
+  DOCTEST_CHECK(y == 1.5);
+  DOCTEST_CHECK(r.read(y));
+  DOCTEST_CHECK(y == -2000);
+  DOCTEST_CHECK(r.read(y));
+  DOCTEST_CHECK(isinf(y));
+  DOCTEST_CHECK(not r.read(y));
+  DOCTEST_CHECK(r.error() == std::errc::invalid_argument);
+  DOCTEST_CHECK(isinf(y));
+  DOCTEST_CHECK(not r.read(y));
+
+  // truncated binary stream
+  std::string bytes;
+  {
+    stream_writer<digits2{256}> w;
+    DOCTEST_REQUIRE(w.open(path) == std::errc{});
+    w.write(scalar_t{1} / 3);
+    w.write(scalar_t{2});
+    DOCTEST_CHECK(w.close() == std::errc{});
+    std::FILE* f = std::fopen(path, "rb");
+    char buf[256];
+    bytes.assign(buf, std::fread(buf, 1, sizeof(buf), f));
+    std::fclose(f);
+  }
+  write_file(path, bytes.substr(0, bytes.size() - 1));
+  DOCTEST_REQUIRE(r.open(path) == std::errc{});
+  DOCTEST_CHECK(r.read(y));
+  DOCTEST_CHECK(y == scalar_t{1} / 3);
+  DOCTEST_CHECK(not r.read(y));
+  DOCTEST_CHECK(r.error() == std::errc::invalid_argument);
+  r.close();
+  std::remove(path);
+}
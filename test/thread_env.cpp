@@ -0,0 +1,77 @@
+#define MPFR_CXX_DEBUG 1
+
+#include "doctest.h"
+#include <iostream>
+#include "mpfr/thread_env.hpp"
+#include "mpfr/mp_float.hpp"
+#include <thread>
+
+using namespace mpfr;
+using scalar_t = mp_float_t<digits2{128}>;
+
+DOCTEST_TEST_CASE("thread env settings") {
+  mpfr_exp_t const emax = mpfr_get_emax();
+  scalar_t const big = scalar_t{1} / 3 * scalar_t{1L << 30} * scalar_t{1L << 30};
+  scalar_t const pow2 = scalar_t{1L << 20};
+
+  thread_env_settings_t settings = thread_env_settings_t::current();
+  settings.emax = 70;
+  settings.fe_round = FE_UPWARD;
+  settings.flags = 0;
+  {
+    thread_env env{settings};
+    DOCTEST_CHECK(mpfr_get_emax() == 70);
+    DOCTEST_CHECK(std::fegetround() == FE_UPWARD);
+    DOCTEST_CHECK(scalar_t{1} / 3 * 3 > 1);
+
+    // the power of two fast path sees the exponent range of the environment
+    DOCTEST_CHECK(isinf(big * pow2));
+    DOCTEST_CHECK(mpfr_overflow_p());
+    DOCTEST_CHECK(thread_env::set_exp_range(mpfr_get_emin(), 100));
+    DOCTEST_CHECK(big * pow2 == big * scalar_t{1L << 10} * scalar_t{1L << 10});
+    DOCTEST_CHECK(not thread_env::set_exp_range(mpfr_get_emin(), mpfr_get_emax_max() + 1));
+
+    {
+      thread_env nested;
+      DOCTEST_CHECK(thread_env::set_exp_range(mpfr_get_emin(), 60));
+      DOCTEST_CHECK(isinf(big * pow2));
+    }
+    DOCTEST_CHECK(mpfr_get_emax() == 100);
+    DOCTEST_CHECK(not isinf(big * pow2));
+  }
+  DOCTEST_CHECK(mpfr_get_emax() == emax);
+  DOCTEST_CHECK(std::fegetround() == FE_TONEAREST);
+  // flags raised inside the environment stay raised
+  DOCTEST_CHECK(mpfr_overflow_p());
+  mpfr_clear_flags();
+
+  // without an environment, changes made directly with MPFR are seen
+  mpfr_set_emax(70);
+  DOCTEST_CHECK(isinf(big * pow2));
+  mpfr_set_emax(emax);
+  DOCTEST_CHECK(not isinf(big * pow2));
+  mpfr_clear_flags();
+}
+
+DOCTEST_TEST_CASE("thread env on other threads") {
+  thread_env_settings_t settings = thread_env_settings_t::current();
+  settings.emax = 70;
+  scalar_t const big = scalar_t{1} / 3 * scalar_t{1L << 30} * scalar_t{1L << 30};
+  scalar_t result;
+  mpfr_flags_t flags = 0;
+  std::thread t{[&] {
+    thread_env env{settings};
+    // uses the thread local caches of MPFR, which are freed when the thread exits
+    scalar_t pi;
+    {
+      _::mpfr_raii_setter_t&& g = _::impl_access::mpfr_setter(pi);
+      mpfr_const_pi(&g.m, MPFR_RNDN);
+    }
+    result = big * scalar_t{1L << 20} + pi;
+    flags = mpfr_flags_save();
+  }};
+  t.join();
+  DOCTEST_CHECK(isinf(result));
+  DOCTEST_CHECK((flags & MPFR_FLAGS_OVERFLOW) != 0);
+  DOCTEST_CHECK(not mpfr_overflow_p());
+}